@@ -150,6 +150,38 @@ test_x_order_intersection_rb(const std::string& test_name,
   //save_intersection_points(ipts, 0, srid, output_shape_file);
 }
 
+void
+test_trapezoid_sweep_intersection_rb(const std::string& test_name,
+                                     const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                     const std::string& output_shape_file,
+                                     int srid)
+{
+  benchmark_t b;
+  
+  b.test_name = test_name;
+  
+  std::cout << "trapezoid_sweep_intersection_rb: " << test_name << std::endl;
+  
+  b.start = std::chrono::system_clock::now();
+  
+  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::trapezoid_sweep_intersection_rb(red_segments, blue_segments);
+  
+  b.end = std::chrono::system_clock::now();
+  
+  b.elapsed_time = b.end - b.start;
+  
+  b.algorithm_name = "trapezoid_sweep_intersection_rb";
+  b.num_intersections = ipts.size();
+  b.red_segments = red_segments.size();
+  b.blue_segments = blue_segments.size();
+  b.repetitions = 1;
+  
+  print(b);
+
+  //save_intersection_points(ipts, 0, srid, output_shape_file);
+}
+
 void
 test_x_order_intersection_rb_thread(const std::string& test_name,
                                     const std::vector<gde::geom::core::line_segment>& red_segments,
@@ -165,33 +197,23 @@ test_x_order_intersection_rb_thread(const std::string& test_name,
   
   b.num_threads = std::thread::hardware_concurrency();
   
-  std::vector<std::vector<gde::geom::core::point> > intersection_pts;
-  
   b.start = std::chrono::system_clock::now();
   
-  gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, b.num_threads, intersection_pts);
+// only the number of points is reported: count them without writing the points
+  gde::geom::algorithm::intersection_count count = gde::geom::algorithm::x_order_intersection_rb_count_thread(red_segments, blue_segments, b.num_threads);
   
   b.end = std::chrono::system_clock::now();
   
   b.elapsed_time = b.end - b.start;
   
-  b.algorithm_name = "x_order_intersection_rb_thread";
+  b.algorithm_name = "x_order_intersection_rb_count_thread";
   b.red_segments = red_segments.size();
   b.blue_segments = blue_segments.size();
   b.repetitions = 1;
   
-  std::vector<gde::geom::core::point> ipts;
-  
-  for(const auto& vecipts : intersection_pts)
-  {
-    std::copy(vecipts.begin(), vecipts.end(), std::back_inserter(ipts));
-  }
-  
-  b.num_intersections = ipts.size();
+  b.num_intersections = count.total();
   
   print(b);
-
-  //save_intersection_points(ipts, 0, srid, output_shape_file);
 }
 
 void
@@ -209,11 +231,15 @@ test_fixed_grid_intersection_rb(const std::string& test_name,
   
   b.start = std::chrono::system_clock::now();
   
-  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
-  
-  std::pair<double, double> res_x_y = gde::geom::algorithm::compute_average_length(blue_segments.begin(), blue_segments.end());
+  gde::geom::core::rectangle rec_red = gde::geom::algorithm::compute_rectangle(red_segments.begin(), red_segments.end());
+  gde::geom::core::rectangle rec_blue = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r(std::min(rec_red.ll.x, rec_blue.ll.x),
+                               std::min(rec_red.ll.y, rec_blue.ll.y),
+                               std::max(rec_red.ur.x, rec_blue.ur.x),
+                               std::max(rec_red.ur.y, rec_blue.ur.y));
   
-  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::fixed_grid_intersection_rb(red_segments, blue_segments, res_x_y.first * 4.0, res_x_y.second * 4.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::fixed_grid_intersection_rb(red_segments, blue_segments, gde::geom::algorithm::auto_resolution, gde::geom::algorithm::auto_resolution, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
   
   b.end = std::chrono::system_clock::now();
   
@@ -240,30 +266,27 @@ test_fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_s
 
   std::cout << "test_fixed_grid_intersection_rb_thread..." << std::endl;
 
-  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
+  gde::geom::core::rectangle rec_red = gde::geom::algorithm::compute_rectangle(red_segments.begin(), red_segments.end());
+  gde::geom::core::rectangle rec_blue = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
 
-  std::pair<double, double> res_x_y = gde::geom::algorithm::compute_average_length(blue_segments.begin(), blue_segments.end());
+  gde::geom::core::rectangle r(std::min(rec_red.ll.x, rec_blue.ll.x),
+                               std::min(rec_red.ll.y, rec_blue.ll.y),
+                               std::max(rec_red.ur.x, rec_blue.ur.x),
+                               std::max(rec_red.ur.y, rec_blue.ur.y));
 
-  std::vector<std::vector<gde::geom::core::point> > ipts;
+  std::vector<gde::geom::core::point> ipts;
 
   b.start = std::chrono::system_clock::now();
 
-  gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, num_threads, res_x_y.first * 4.0, res_x_y.second * 4.0,
+  gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, num_threads, gde::geom::algorithm::auto_resolution, gde::geom::algorithm::auto_resolution,
                                                           r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
 
   b.end = std::chrono::system_clock::now();
 
   b.elapsed_time = b.end - b.start;
 
-  std::vector<gde::geom::core::point> ipt;
-
-  for(const auto& vecipts : ipts)
-  {
-    std::copy(vecipts.begin(), vecipts.end(), std::back_inserter(ipt));
-  }
-
   b.algorithm_name = "fixed_grid_intersection_rb";
-  b.num_intersections = ipt.size();
+  b.num_intersections = ipts.size();
   b.red_segments = red_segments.size();
   b.blue_segments = blue_segments.size();
   b.repetitions = 1;
@@ -297,14 +320,7 @@ test_tiling_intersection_rb(const std::string& test_name,
                                std::max(rec_red.ur.x, rec_blue.ur.x),
                                std::max(rec_red.ur.y, rec_blue.ur.y));
   
-  std::pair<double, double> res_x_y_red = gde::geom::algorithm::compute_average_length(red_segments.begin(), red_segments.end());
-  std::pair<double, double> res_x_y_blue = gde::geom::algorithm::compute_average_length(blue_segments.begin(), blue_segments.end());
-
-  double res_y = (res_x_y_red.second * static_cast<double>(red_segments.size()) + res_x_y_blue.second * static_cast<double>(blue_segments.size())) / static_cast<double>(red_segments.size() + blue_segments.size());
-  
-  
-  
-  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments, res_y * 4.0, r.ll.y, r.ur.y);
+  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments, gde::geom::algorithm::auto_resolution, r.ll.y, r.ur.y);
   
   b.end = std::chrono::system_clock::now();
   
@@ -342,16 +358,11 @@ test_tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segme
                                std::max(rec_red.ur.x, rec_blue.ur.x),
                                std::max(rec_red.ur.y, rec_blue.ur.y));
 
-  std::pair<double, double> res_x_y_red = gde::geom::algorithm::compute_average_length(red_segments.begin(), red_segments.end());
-  std::pair<double, double> res_x_y_blue = gde::geom::algorithm::compute_average_length(blue_segments.begin(), blue_segments.end());
-
-  double res_y = (res_x_y_red.second * static_cast<double>(red_segments.size()) + res_x_y_blue.second * static_cast<double>(blue_segments.size())) / static_cast<double>(red_segments.size() + blue_segments.size());
-
   std::vector<std::vector<gde::geom::core::point> > ipts;
 
   b.start = std::chrono::system_clock::now();
 
-  gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments,num_threads, res_y * 4.0, r.ll.y, r.ur.y,ipts);
+  gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments,num_threads, gde::geom::algorithm::auto_resolution, r.ll.y, r.ur.y,ipts);
 
   b.end = std::chrono::system_clock::now();
 
@@ -375,6 +386,134 @@ test_tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segme
   //save_intersection_points(ipts, 0, 4674, "/home/joao/Desktop/RTP/intersection_rb");
 }
 
+void
+test_rtree_intersection_rb(const std::string& test_name,
+                           const std::vector<gde::geom::core::line_segment>& red_segments,
+                           const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  benchmark_t b;
+
+  b.test_name = test_name;
+
+  std::cout << "rtree_intersection_rb: " << test_name << std::endl;
+
+  b.start = std::chrono::system_clock::now();
+
+  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::rtree_intersection_rb(red_segments, blue_segments);
+
+  b.end = std::chrono::system_clock::now();
+
+  b.elapsed_time = b.end - b.start;
+
+  b.algorithm_name = "rtree_intersection_rb";
+  b.num_intersections = ipts.size();
+  b.red_segments = red_segments.size();
+  b.blue_segments = blue_segments.size();
+  b.repetitions = 1;
+
+  print(b);
+}
+
+void
+test_quadtree_intersection_rb(const std::string& test_name,
+                              const std::vector<gde::geom::core::line_segment>& red_segments,
+                              const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  benchmark_t b;
+
+  b.test_name = test_name;
+
+  std::cout << "quadtree_intersection_rb: " << test_name << std::endl;
+
+  b.start = std::chrono::system_clock::now();
+
+  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::quadtree_intersection_rb(red_segments, blue_segments);
+
+  b.end = std::chrono::system_clock::now();
+
+  b.elapsed_time = b.end - b.start;
+
+  b.algorithm_name = "quadtree_intersection_rb";
+  b.num_intersections = ipts.size();
+  b.red_segments = red_segments.size();
+  b.blue_segments = blue_segments.size();
+  b.repetitions = 1;
+
+  print(b);
+}
+
+void
+test_multilevel_grid_intersection_rb(const std::string& test_name,
+                                     const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  benchmark_t b;
+
+  b.test_name = test_name;
+
+  std::cout << "multilevel_grid_intersection_rb: " << test_name << std::endl;
+
+  b.start = std::chrono::system_clock::now();
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(red_segments.begin(), red_segments.end());
+  gde::geom::core::rectangle rb = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
+
+  std::vector<gde::geom::core::point> ipts =
+    gde::geom::algorithm::multilevel_grid_intersection_rb(red_segments, blue_segments,
+                                                          gde::geom::algorithm::auto_resolution, gde::geom::algorithm::auto_resolution,
+                                                          std::min(r.ll.x, rb.ll.x), std::max(r.ur.x, rb.ur.x),
+                                                          std::min(r.ll.y, rb.ll.y), std::max(r.ur.y, rb.ur.y));
+
+  b.end = std::chrono::system_clock::now();
+
+  b.elapsed_time = b.end - b.start;
+
+  b.algorithm_name = "multilevel_grid_intersection_rb";
+  b.num_intersections = ipts.size();
+  b.red_segments = red_segments.size();
+  b.blue_segments = blue_segments.size();
+  b.repetitions = 1;
+
+  print(b);
+}
+
+void
+test_intersection_rb(const std::string& test_name,
+                     const std::vector<gde::geom::core::line_segment>& red_segments,
+                     const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  const char* algorithm_names[] = { "none", "lazy", "x_order", "fixed_grid", "tiling" };
+
+  benchmark_t b;
+
+  b.test_name = test_name;
+
+  std::cout << "intersection_rb: " << test_name << std::endl;
+
+  gde::geom::algorithm::intersection_options options;
+
+  options.nthreads = std::thread::hardware_concurrency();
+
+  gde::geom::algorithm::intersection_selection selection;
+
+  b.start = std::chrono::system_clock::now();
+
+  std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::intersection_rb(red_segments, blue_segments, options, selection);
+
+  b.end = std::chrono::system_clock::now();
+
+  b.elapsed_time = b.end - b.start;
+
+  b.algorithm_name = std::string("intersection_rb(") + algorithm_names[selection.algorithm] + ")";
+  b.num_intersections = ipts.size();
+  b.red_segments = red_segments.size();
+  b.blue_segments = blue_segments.size();
+  b.repetitions = 1;
+  b.num_threads = selection.nthreads;
+
+  print(b);
+}
+
 int main(int argc, char* argv[])
 {
   StartTerraLib();
@@ -395,6 +534,8 @@ int main(int argc, char* argv[])
     
   //  test_x_order_intersection_rb_thread("x_order_intersection_rb_thread - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario, "/Users/gribeiro/Desktop/Curso-TerraView/result_x_order_intersection_rb_thread.shp", 4674);
 
+  //  test_trapezoid_sweep_intersection_rb("trapezoid_sweep_intersection_rb - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario, "/Users/gribeiro/Desktop/Curso-TerraView/result_trapezoid_sweep_intersection_rb.shp", 4674);
+
     //test_fixed_grid_intersection_rb("fixed_grid_intersection_rb - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario, "/Users/gribeiro/Desktop/Curso-TerraView/result_fixed_grid_intersection_rb.shp", 4674);
     
     //test_fixed_grid_intersection_rb_thread(trechos_drenagem, trechos_rodoviario);
@@ -402,6 +543,14 @@ int main(int argc, char* argv[])
     test_tiling_intersection_rb("tiling_intersection_rb - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario, "/Users/gribeiro/Desktop/Curso-TerraView/result_tiling_intersection_rb.shp", 4674);
 
     test_tiling_intersection_rb_thread(trechos_drenagem, trechos_rodoviario);
+
+    test_rtree_intersection_rb("rtree_intersection_rb - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario);
+
+    test_quadtree_intersection_rb("quadtree_intersection_rb - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario);
+
+    test_multilevel_grid_intersection_rb("multilevel_grid_intersection_rb - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario);
+
+    test_intersection_rb("intersection_rb - drenagem x trechos rodoviarios", trechos_drenagem, trechos_rodoviario);
   }
   
   if(false)
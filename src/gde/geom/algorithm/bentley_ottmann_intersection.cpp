@@ -0,0 +1,551 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/bentley_ottmann_intersection.cpp
+
+  \brief Bentley-Ottmann plane-sweep intersection algorithm.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "line_segment_intersection.hpp"
+#include "utils.hpp"
+
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+/*!
+  \struct bentley_ottmann_event
+
+  \brief The segments attached to an event point of the sweep.
+ */
+struct bentley_ottmann_event
+{
+  std::vector<std::size_t> left;      //!< Segments whose left end-point is the event point.
+  std::vector<std::size_t> right;     //!< Segments whose right end-point is the event point.
+  std::vector<std::size_t> crossing;  //!< Segments that were found to cross at the event point.
+};
+
+/*!
+  \struct bentley_ottmann_pair
+
+  \brief Cached result of the intersection test between two segments.
+ */
+struct bentley_ottmann_pair
+{
+  gde::geom::algorithm::segment_relation_type relation;
+  gde::geom::core::point ip;
+};
+
+struct bentley_ottmann_sweep;
+
+/*!
+  \struct bentley_ottmann_node
+
+  \brief A node of the sweep-line status.
+
+  The segment id is mutable so that segments that cross at an event point
+  can swap their positions in the status without new comparisons.
+ */
+struct bentley_ottmann_node
+{
+  mutable std::size_t id;
+};
+
+/*!
+  \struct bentley_ottmann_status_cmp
+
+  \brief Orders the segments in the sweep-line status from bottom to top.
+
+  Segments passing through the current event point are ordered by their
+  direction, i.e. by the order they will have just after the event point.
+ */
+struct bentley_ottmann_status_cmp
+{
+  const bentley_ottmann_sweep* sweep;
+
+  bool operator()(const bentley_ottmann_node& a, const bentley_ottmann_node& b) const;
+};
+
+/*!
+  \struct bentley_ottmann_sweep
+
+  \brief The state of the sweep: event queue, status structure and tested pairs.
+
+  The status is a balanced tree (std::set) whose order is kept valid for the
+  current sweep position. Each pair of segments is tested at most once and
+  its intersection point(s) are reported the first time it is tested.
+ */
+struct bentley_ottmann_sweep
+{
+  typedef std::set<bentley_ottmann_node, bentley_ottmann_status_cmp> status_type;
+
+  std::vector<gde::geom::core::line_segment> segments;
+  std::size_t probe;
+  gde::geom::core::point sweep_pt;
+  std::vector<char> marked;
+  std::vector<char> active;
+  std::map<gde::geom::core::point, bentley_ottmann_event, gde::geom::algorithm::point_xy_cmp> events;
+  status_type status;
+  std::vector<status_type::iterator> handles;
+  std::unordered_map<std::uint64_t, bentley_ottmann_pair> tested;
+  std::vector<gde::geom::core::point>* ipts;        // null if only the points are counted
+  gde::geom::algorithm::intersection_count count;
+
+  bentley_ottmann_sweep(const std::vector<gde::geom::core::line_segment>& input,
+                        std::vector<gde::geom::core::point>* output)
+    : segments(input.size() + 1),
+      probe(input.size()),
+      marked(input.size() + 1, 0),
+      active(input.size(), 0),
+      status(bentley_ottmann_status_cmp{this}),
+      handles(input.size()),
+      ipts(output),
+      count()
+  {
+// copy the input segments and order each one of them from left to right
+    std::transform(input.begin(), input.end(), segments.begin(), gde::geom::algorithm::sort_segment_xy());
+
+    for(std::size_t i = 0; i != probe; ++i)
+    {
+      events[segments[i].p1].left.push_back(i);
+      events[segments[i].p2].right.push_back(i);
+    }
+  }
+
+// does segment s pass through the current event point?
+  bool through(std::size_t s) const
+  {
+    if((s == probe) || marked[s])
+      return true;
+
+    return gde::geom::algorithm::orientation(segments[s].p1, segments[s].p2, sweep_pt) == 0.0;
+  }
+
+  void run()
+  {
+    while(!events.empty())
+    {
+      auto it = events.begin();
+
+      sweep_pt = it->first;
+
+      bentley_ottmann_event ev;
+      ev.left.swap(it->second.left);
+      ev.right.swap(it->second.right);
+      ev.crossing.swap(it->second.crossing);
+
+      events.erase(it);
+
+      handle_event(ev);
+    }
+  }
+
+  void handle_event(const bentley_ottmann_event& ev)
+  {
+// segments known to pass through the event point
+    for(std::size_t s : ev.right)
+      marked[s] = 1;
+
+    for(std::size_t s : ev.crossing)
+      marked[s] = 1;
+
+// find all segments in the status that contain the event point:
+// they form a contiguous block in the status
+    segments[probe] = gde::geom::core::line_segment(sweep_pt, sweep_pt);
+
+    std::vector<std::size_t> block;
+
+    collect_block(status.lower_bound(bentley_ottmann_node{probe}), block);
+
+// due to round-off, a crossing point may not lie exactly on its segments
+    for(std::size_t s : ev.crossing)
+    {
+      if(active[s] && (std::find(block.begin(), block.end(), s) == block.end()))
+        collect_block(handles[s], block);
+    }
+
+    for(std::size_t s : block)
+      marked[s] = 1;
+
+    merge_block(block);
+
+// all segments through the event point intersect at it
+    std::vector<std::size_t> run(block);
+
+    run.insert(run.end(), ev.left.begin(), ev.left.end());
+
+    for(std::size_t i = 0; i < run.size(); ++i)
+      for(std::size_t j = i + 1; j < run.size(); ++j)
+        test_pair(run[i], run[j]);
+
+    std::vector<std::size_t> inserted;
+
+    while(true)
+    {
+// the segments that cross at the event point swap their positions
+      reorder_block(block);
+
+// remove the segments ending at the event point
+      for(std::size_t s : ev.right)
+      {
+        if(active[s])
+        {
+          status.erase(handles[s]);
+          active[s] = 0;
+        }
+      }
+
+// and insert the ones starting there
+      for(std::size_t s : ev.left)
+      {
+        marked[s] = 1;
+
+        if(active[s] || (segments[s].p2 == sweep_pt))
+          continue;
+
+        handles[s] = status.insert(bentley_ottmann_node{s}).first;
+        active[s] = 1;
+        inserted.push_back(s);
+      }
+
+// check the new neighbours: a neighbour that should already have crossed
+// the event point is a round-off artifact and it is merged into the block
+      std::vector<std::size_t> grow;
+
+      auto first = status.end();
+
+      for(std::size_t s : block)
+        if(active[s])
+          first = handles[s];
+
+      if((first == status.end()) && !inserted.empty())
+        first = handles[inserted.front()];
+
+      if(first == status.end())
+      {
+        auto it = status.lower_bound(bentley_ottmann_node{probe});
+
+        if((it != status.begin()) && (it != status.end()) && check_neighbours(std::prev(it)->id, it->id))
+        {
+          grow.push_back(std::prev(it)->id);
+          grow.push_back(it->id);
+        }
+      }
+      else
+      {
+        auto lowest = first;
+
+        while((lowest != status.begin()) && marked[std::prev(lowest)->id])
+          --lowest;
+
+        auto highest = first;
+
+        while((std::next(highest) != status.end()) && marked[std::next(highest)->id])
+          ++highest;
+
+        if((lowest != status.begin()) && check_neighbours(std::prev(lowest)->id, lowest->id))
+          grow.push_back(std::prev(lowest)->id);
+
+        if((std::next(highest) != status.end()) && check_neighbours(highest->id, std::next(highest)->id))
+          grow.push_back(std::next(highest)->id);
+      }
+
+      if(grow.empty())
+        break;
+
+      for(std::size_t g : grow)
+      {
+        for(std::size_t s : run)
+          test_pair(g, s);
+
+        marked[g] = 1;
+        run.push_back(g);
+        block.push_back(g);
+      }
+
+// the new segments are part of the block now
+      block.insert(block.end(), inserted.begin(), inserted.end());
+      inserted.clear();
+    }
+
+    for(std::size_t s : run)
+      marked[s] = 0;
+
+    for(std::size_t s : ev.right)
+      marked[s] = 0;
+
+    for(std::size_t s : ev.crossing)
+      marked[s] = 0;
+  }
+
+// walk down and up from a status position collecting the segments through the event point
+  void collect_block(status_type::iterator it, std::vector<std::size_t>& block)
+  {
+    status_type::iterator down = it;
+
+    while(down != status.begin())
+    {
+      --down;
+
+      if(!through(down->id))
+        break;
+
+      if(std::find(block.begin(), block.end(), down->id) == block.end())
+        block.push_back(down->id);
+    }
+
+    for(status_type::iterator up = it; (up != status.end()) && through(up->id); ++up)
+    {
+      if(std::find(block.begin(), block.end(), up->id) == block.end())
+        block.push_back(up->id);
+    }
+  }
+
+// if round-off splits the block, merge the segments in between into the block
+  void merge_block(std::vector<std::size_t>& block)
+  {
+    while(true)
+    {
+      std::vector<std::size_t> ends;
+
+      for(std::size_t s : block)
+      {
+        status_type::iterator next = std::next(handles[s]);
+
+        if((next != status.end()) && !marked[next->id])
+          ends.push_back(s);
+      }
+
+      if(ends.size() <= 1)
+        return;
+
+// only the top of the highest part of the block doesn't reach another part
+      bool merged = false;
+
+      for(std::size_t s : ends)
+      {
+        std::vector<std::size_t> gap;
+
+        status_type::iterator it = std::next(handles[s]);
+
+        while((it != status.end()) && !marked[it->id])
+        {
+          gap.push_back(it->id);
+          ++it;
+        }
+
+        if(it == status.end())
+          continue;
+
+        for(std::size_t g : gap)
+        {
+          marked[g] = 1;
+          block.push_back(g);
+        }
+
+        merged = true;
+      }
+
+      if(!merged)
+        return;
+    }
+  }
+
+// sort the block in the status by the order just after the event point
+  void reorder_block(const std::vector<std::size_t>& block)
+  {
+    std::vector<status_type::iterator> nodes;
+
+    for(std::size_t s : block)
+      if(active[s])
+        nodes.push_back(handles[s]);
+
+    if(nodes.size() <= 1)
+      return;
+
+    std::vector<std::size_t> ids;
+
+    for(const auto& node : nodes)
+      ids.push_back(node->id);
+
+// the nodes are contiguous: the lowest one has no marked predecessor
+    status_type::iterator it = nodes.front();
+
+    while((it != status.begin()) && marked[std::prev(it)->id])
+      --it;
+
+    std::sort(ids.begin(), ids.end(), [this](std::size_t a, std::size_t b) { return gde::geom::algorithm::below_after_sweep_pt(segments, a, b); });
+
+    for(std::size_t s : ids)
+    {
+      it->id = s;
+      handles[s] = it;
+      ++it;
+    }
+  }
+
+// test a pair of segments once and report its intersection point(s)
+  const bentley_ottmann_pair& test_pair(std::size_t a, std::size_t b)
+  {
+// keep the same argument order as the x-order algorithm
+    if(gde::geom::algorithm::line_segment_xy_cmp()(segments[b], segments[a]) ||
+       (!gde::geom::algorithm::line_segment_xy_cmp()(segments[a], segments[b]) && (b < a)))
+      std::swap(a, b);
+
+    std::uint64_t key = static_cast<std::uint64_t>(a) * static_cast<std::uint64_t>(probe) + b;
+
+    auto it = tested.find(key);
+
+    if(it != tested.end())
+      return it->second;
+
+    bentley_ottmann_pair& result = tested[key];
+
+    gde::geom::core::point ip2;
+
+    result.relation = gde::geom::algorithm::DISJOINT;
+
+    if(gde::geom::algorithm::do_bounding_box_intersects_v2(segments[a], segments[b]))
+      result.relation = gde::geom::algorithm::compute_intesection(segments[a], segments[b], result.ip, ip2);
+
+    if(result.relation == gde::geom::algorithm::DISJOINT)
+      return result;
+
+    ++count.relations[result.relation];
+
+    if(result.relation == gde::geom::algorithm::OVERLAP)
+      ++count.relations[result.relation];
+
+    if(ipts == nullptr)
+      return result;
+
+    ipts->push_back(result.ip);
+
+    if(result.relation == gde::geom::algorithm::OVERLAP)
+      ipts->push_back(ip2);
+
+    return result;
+  }
+
+// lo is immediately below hi: if they will cross, schedule their crossing
+// and tell if the crossing is behind the sweep line
+  bool check_neighbours(std::size_t lo, std::size_t hi)
+  {
+    const bentley_ottmann_pair& result = test_pair(lo, hi);
+
+    if((result.relation == gde::geom::algorithm::DISJOINT) || (result.relation == gde::geom::algorithm::OVERLAP))
+      return false;
+
+    if(!gde::geom::algorithm::below_after_sweep_pt(segments, hi, lo))
+      return false;
+
+    if(!gde::geom::algorithm::point_xy_cmp()(sweep_pt, result.ip))
+      return true;
+
+    bentley_ottmann_event& ev = events[result.ip];
+
+    ev.crossing.push_back(lo);
+    ev.crossing.push_back(hi);
+
+    return false;
+  }
+};
+
+bool
+bentley_ottmann_status_cmp::operator()(const bentley_ottmann_node& lhs, const bentley_ottmann_node& rhs) const
+{
+  const std::size_t a = lhs.id;
+  const std::size_t b = rhs.id;
+
+  if(a == b)
+    return false;
+
+  const bool ta = sweep->through(a);
+  const bool tb = sweep->through(b);
+
+// the probe stays above all segments through the event point
+  if(ta && tb && ((a == sweep->probe) || (b == sweep->probe)))
+    return b == sweep->probe;
+
+  const gde::geom::core::line_segment& sa = sweep->segments[a];
+  const gde::geom::core::line_segment& sb = sweep->segments[b];
+
+  if(ta || tb)
+    return gde::geom::algorithm::sweep_status_less(sweep->segments,
+                                                   a, ta ? gde::geom::algorithm::SWEEP_AT : gde::geom::algorithm::sweep_side(sa, sweep->sweep_pt),
+                                                   b, tb ? gde::geom::algorithm::SWEEP_AT : gde::geom::algorithm::sweep_side(sb, sweep->sweep_pt));
+
+// none of them are at the event point: compare at the left end-point of the one that starts later
+  if(!gde::geom::algorithm::point_xy_cmp()(sa.p1, sb.p1))
+  {
+    double o = gde::geom::algorithm::orientation(sb.p1, sb.p2, sa.p1);
+
+    if(o == 0.0)
+      o = gde::geom::algorithm::orientation(sb.p1, sb.p2, sa.p2);
+
+    return (o != 0.0) ? (o < 0.0) : (a < b);
+  }
+
+  double o = gde::geom::algorithm::orientation(sa.p1, sa.p2, sb.p1);
+
+  if(o == 0.0)
+    o = gde::geom::algorithm::orientation(sa.p1, sa.p2, sb.p2);
+
+  return (o != 0.0) ? (o > 0.0) : (a < b);
+}
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::bentley_ottmann_intersection(const std::vector<gde::geom::core::line_segment>& segments)
+{
+// output list of intersection points
+  std::vector<gde::geom::core::point> ipts;
+
+// check if we have at least two segments to sweep!
+  if(segments.size() <= 1)
+    return ipts;
+
+  bentley_ottmann_sweep sweep(segments, &ipts);
+
+  sweep.run();
+
+  return ipts;
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::bentley_ottmann_intersection_count(const std::vector<gde::geom::core::line_segment>& segments)
+{
+  if(segments.size() <= 1)
+    return intersection_count();
+
+  bentley_ottmann_sweep sweep(segments, nullptr);
+
+  sweep.run();
+
+  return sweep.count;
+}
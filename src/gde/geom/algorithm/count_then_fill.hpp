@@ -0,0 +1,240 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/count_then_fill.hpp
+
+  \brief Parallel drivers of the intersection scans: per-thread output, counting,
+         and two-pass output of the points into one contiguous array.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_COUNT_THEN_FILL_HPP__
+#define __GDE_GEOM_ALGORITHM_COUNT_THEN_FILL_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "intersection_core.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing_scheduler.hpp"
+
+// STL
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*! \brief The default number of items (bands or red segments) in each work unit of count_then_fill. */
+      const std::size_t count_then_fill_unit_size = 256;
+
+      /*!
+        \struct point_array_sink
+
+        \brief Output sink that writes the intersection points one after the other in the range [out, end) of an array.
+
+        \exception std::logic_error If a point is written past end.
+       */
+      struct point_array_sink
+      {
+        gde::geom::core::point* out;
+        gde::geom::core::point* end;
+
+        void operator()(segment_relation_type, const gde::geom::core::point& p, std::size_t, std::size_t)
+        {
+          if(out == end)
+            throw std::logic_error("count_then_fill: a scan wrote more points than it counted.");
+
+          *out++ = p;
+        }
+      };
+
+// the per-thread output of scan_per_thread: each worker appends to its own vector
+      template<class Scan>
+      struct scan_per_thread_writer
+      {
+        const Scan* scan;
+        std::vector<std::vector<gde::geom::core::point> >* ipts;
+
+        void operator()(std::size_t thread_pos, std::size_t first, std::size_t last)
+        {
+          point_vector_sink sink = { &(*ipts)[thread_pos] };
+
+          (*scan)(first, last, sink);
+        }
+      };
+
+// the per-thread counters of count_per_thread
+      template<class Scan>
+      struct scan_per_thread_counter
+      {
+        const Scan* scan;
+        std::vector<intersection_count>* counts;
+
+        void operator()(std::size_t thread_pos, std::size_t first, std::size_t last)
+        {
+          intersection_count_sink sink = {};
+
+          (*scan)(first, last, sink);
+
+          (*counts)[thread_pos].add(sink.count);
+        }
+      };
+
+      /*!
+        \brief Run a scan over the items [0, nitems) on the threads of a pool, each worker
+               appending the points of its ranges to its own vector.
+
+        The scan is called as scan(first, last, sink) for a range of items.
+
+        \param ipts  One vector for each worker of the pool: it is resized to pool.size() and the points are appended.
+        \param grain The number of items of each range (see parallel_for).
+       */
+      template<class Scan>
+      void
+      scan_per_thread(thread_pool& pool, std::size_t nitems, const Scan& scan,
+                      std::vector<std::vector<gde::geom::core::point> >& ipts,
+                      std::size_t grain = 0)
+      {
+        ipts.resize(pool.size());
+
+        scan_per_thread_writer<Scan> writer = { &scan, &ipts };
+
+        parallel_for(pool, 0, nitems, writer, grain);
+      }
+
+      /*!
+        \brief Run a scan over the items [0, nitems) on the threads of a pool and count
+               the relations it finds, with one counter for each worker.
+
+        \param grain The number of items of each range (see parallel_for).
+       */
+      template<class Scan>
+      intersection_count
+      count_per_thread(thread_pool& pool, std::size_t nitems, const Scan& scan,
+                       std::size_t grain = 0)
+      {
+        std::vector<intersection_count> counts(pool.size(), intersection_count());
+
+        scan_per_thread_counter<Scan> counter = { &scan, &counts };
+
+        parallel_for(pool, 0, nitems, counter, grain);
+
+        return sum_intersection_counts(counts);
+      }
+
+// first pass of count_then_fill: the number of points of each unit, stored after the unit
+      template<class Scan>
+      struct count_then_fill_counter
+      {
+        const Scan* scan;
+        std::vector<std::size_t>* offsets;
+        std::size_t nitems;
+        std::size_t unit_size;
+
+        void operator()(std::size_t, std::size_t first_unit, std::size_t last_unit)
+        {
+          for(std::size_t u = first_unit; u != last_unit; ++u)
+          {
+            point_count_sink sink = { 0 };
+
+            (*scan)(u * unit_size, std::min((u + 1) * unit_size, nitems), sink);
+
+            (*offsets)[u + 1] = sink.count;
+          }
+        }
+      };
+
+// second pass of count_then_fill: each unit writes its points from its offset
+      template<class Scan>
+      struct count_then_fill_writer
+      {
+        const Scan* scan;
+        const std::vector<std::size_t>* offsets;
+        gde::geom::core::point* ipts;
+        std::size_t nitems;
+        std::size_t unit_size;
+
+        void operator()(std::size_t, std::size_t first_unit, std::size_t last_unit)
+        {
+          for(std::size_t u = first_unit; u != last_unit; ++u)
+          {
+            point_array_sink sink = { ipts + (*offsets)[u], ipts + (*offsets)[u + 1] };
+
+            (*scan)(u * unit_size, std::min((u + 1) * unit_size, nitems), sink);
+
+// a unit that wrote less would leave a gap in the output
+            if(sink.out != sink.end)
+              throw std::logic_error("count_then_fill: a scan wrote fewer points than it counted.");
+          }
+        }
+      };
+
+      /*!
+        \brief Run a scan over the items [0, nitems) in two passes and write all of its points to one array.
+
+        The items are split into units of a fixed size. The first pass counts the points
+        of each unit, a prefix sum of the counts gives the position of each unit in the output,
+        and the second pass writes the points of each unit right there. The output is resized once
+        and the points come in the order of a serial scan, whatever the number of threads.
+
+        The scan is called as scan(first, last, sink) for a range of items and must send
+        the same points to any sink: it runs twice on each unit.
+
+        \exception std::logic_error If a unit doesn't write as many points as it counted.
+
+        \param unit_size The number of items of each unit: it doesn't depend on the pool, so neither does the order.
+       */
+      template<class Scan>
+      void
+      count_then_fill(thread_pool& pool, std::size_t nitems, const Scan& scan,
+                      std::vector<gde::geom::core::point>& ipts,
+                      std::size_t unit_size = count_then_fill_unit_size)
+      {
+        const std::size_t nunits = (nitems + unit_size - 1) / unit_size;
+
+        std::vector<std::size_t> offsets(nunits + 1, 0);
+
+        count_then_fill_counter<Scan> counter = { &scan, &offsets, nitems, unit_size };
+
+        parallel_for(pool, 0, nunits, counter);
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        ipts.resize(offsets[nunits]);
+
+        count_then_fill_writer<Scan> writer = { &scan, &offsets, ipts.data(), nitems, unit_size };
+
+        parallel_for(pool, 0, nunits, writer);
+      }
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_COUNT_THEN_FILL_HPP__
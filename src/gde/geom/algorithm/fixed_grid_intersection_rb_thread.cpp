@@ -29,87 +29,28 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
-#include "line_segment_intersection.hpp"
+#include "count_then_fill.hpp"
+#include "intersection_core.hpp"
+#include "grid_index.hpp"
+#include "resolution_planner.hpp"
 #include "utils.hpp"
+#include "work_stealing_scheduler.hpp"
 
 // STL
 #include <algorithm>
-#include <cmath>
-#include <map>
-#include <thread>
 
 
-struct intersection_computer6
+struct grid_scan
 {
-  std::size_t thread_pos;
-  std::size_t num_threads;
-  double dx;
-  double dy;
-  double xmin;
-  double ymin;
-  std::size_t nrows;
-  std::vector<gde::geom::core::point>* ipts;
-  std::multimap<std::size_t, std::size_t>* blue_grid;
+  const gde::geom::algorithm::grid_index* blue_grid;
   const std::vector<gde::geom::core::line_segment>* red_segments;
   const std::vector<gde::geom::core::line_segment>* blue_segments;
 
-  void operator()()
+  template<class Sink>
+  void operator()(std::size_t red_first, std::size_t red_last, Sink& sink) const
   {
-      gde::geom::core::point ip1;
-      gde::geom::core::point ip2;
-
-      std::size_t nred_segments = red_segments->size();
-
-      for(std::size_t i = thread_pos; i < nred_segments; i += num_threads)
-      {
-        const auto& red = (*red_segments)[i];
-
-        std::size_t first_col = (red.p1.x - xmin) / dx;
-        std::size_t first_row = (red.p1.y - ymin) / dy;
-
-        std::size_t second_col = (red.p2.x - xmin) / dx;
-        std::size_t second_row = (red.p2.y - ymin) / dy;
-
-        std::pair<std::size_t, std::size_t> min_max_col = std::minmax(first_col, second_col);
-        std::pair<std::size_t, std::size_t> min_max_row = std::minmax(first_row, second_row);
-
-        for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
-        {
-          std::size_t offset = col * nrows;
-
-          for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
-          {
-            std::size_t k = row + offset;
-
-            auto range = blue_grid->equal_range(k);
-
-            while(range.first != range.second)
-            {
-              std::size_t blue_idx = range.first->second;
-
-              const auto& blue = (*blue_segments)[blue_idx];
-
-              if(gde::geom::algorithm::do_bounding_box_intersects(red, blue))
-              {
-                gde::geom::algorithm::segment_relation_type spatial_relation = gde::geom::algorithm::compute_intesection_v3(red, blue, ip1, ip2);
-
-                if(spatial_relation != gde::geom::algorithm::DISJOINT)
-                {
-                  if(gde::geom::algorithm::is_in_cell(xmin, ymin, dx, dy, col, row, ip1.x, ip1.y))
-                    ipts->push_back(ip1);
-
-                  if(spatial_relation == gde::geom::algorithm::OVERLAP)
-                  {
-                    if(gde::geom::algorithm::is_in_cell(xmin, ymin, dx, dy, col, row, ip2.x, ip2.y))
-                      ipts->push_back(ip2);
-                  }
-                }
-              }
-              ++(range.first);
-            }
-          }
-        }
-      }
+    gde::geom::algorithm::grid_intersection_core<gde::geom::algorithm::default_kernel,
+                                                 gde::geom::algorithm::bbox_test>(*red_segments, red_first, red_last, *blue_segments, *blue_grid, sink);
   }
 };
 
@@ -120,52 +61,86 @@ gde::geom::algorithm::fixed_grid_intersection_rb_thread(const std::vector<gde::g
                                   double xmax,double ymin, double ymax,
                                   std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
 {
-  std::vector<gde::geom::core::point> ipts;
+  thread_pool pool(nthreads);
 
-  intersetion_pts.resize(nthreads);
+  fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, intersetion_pts);
+}
 
-  std::size_t nrows = std::ceil(((ymax - ymin) / dy));
+void
+gde::geom::algorithm::fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                  thread_pool& pool, double dx, double dy, double xmin,
+                                  double xmax,double ymin, double ymax,
+                                  std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
 
-  const std::size_t nblue_segments = blue_segments.size();
+  intersetion_pts.resize(pool.size());
 
 // index blue segments in a grid
-  std::multimap<std::size_t, std::size_t> blue_grid;
+  grid_index blue_grid;
 
-  for(std::size_t i = 0; i != nblue_segments; ++i)
-  {
-    const gde::geom::core::line_segment& blue = blue_segments[i];
+  build_grid_index_thread(blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
 
-    std::size_t first_col = (blue.p1.x - xmin) / dx;
-    std::size_t first_row = (blue.p1.y - ymin) / dy;
+  grid_scan scan = { &blue_grid, &red_segments, &blue_segments };
 
-    std::size_t second_col = (blue.p2.x - xmin) / dx;
-    std::size_t second_row = (blue.p2.y - ymin) / dy;
+  scan_per_thread(pool, red_segments.size(), scan, intersetion_pts);
+}
 
-    std::pair<std::size_t, std::size_t> min_max_col = std::minmax(first_col, second_col);
-    std::pair<std::size_t, std::size_t> min_max_row = std::minmax(first_row, second_row);
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::fixed_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                              const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                              std::size_t nthreads, double dx, double dy, double xmin,
+                                                              double xmax, double ymin, double ymax)
+{
+  thread_pool pool(nthreads);
 
-    for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
-    {
-      std::size_t offset = col * nrows;
+  return fixed_grid_intersection_rb_count_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax);
+}
 
-      for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
-      {
-        std::size_t k = row + offset;
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::fixed_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                              const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                              thread_pool& pool, double dx, double dy, double xmin,
+                                                              double xmax, double ymin, double ymax)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
 
-        blue_grid.insert(std::make_pair(k, i));
-      }
-    }
-  }
+  grid_index blue_grid;
 
-  std::vector<std::thread> threads;
+  build_grid_index_thread(blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
 
-  for(std::size_t i = 0; i != nthreads; ++i)
-  {
-    intersection_computer6 ic = {i, nthreads,dx ,dy ,xmin ,ymin , nrows,&(intersetion_pts[i]) ,&blue_grid ,&red_segments ,&blue_segments};
-    threads.push_back(std::thread(ic));
-  }
+  grid_scan scan = { &blue_grid, &red_segments, &blue_segments };
+
+  return count_per_thread(pool, red_segments.size(), scan);
+}
+
+void
+gde::geom::algorithm::fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                        std::size_t nthreads, double dx, double dy, double xmin,
+                                                        double xmax, double ymin, double ymax,
+                                                        std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, intersection_pts);
+}
+
+void
+gde::geom::algorithm::fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                        thread_pool& pool, double dx, double dy, double xmin,
+                                                        double xmax, double ymin, double ymax,
+                                                        std::vector<gde::geom::core::point>& intersection_pts)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  grid_index blue_grid;
+
+  build_grid_index_thread(blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
 
-  for(std::size_t i = 0; i != nthreads; ++i)
-    threads[i].join();
+  grid_scan scan = { &blue_grid, &red_segments, &blue_segments };
 
+  count_then_fill(pool, red_segments.size(), scan, intersection_pts);
 }
@@ -0,0 +1,619 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/grid_index.cpp
+
+  \brief A uniform grid of line segments stored in compressed sparse row (CSR) layout.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "grid_index.hpp"
+#include "utils.hpp"
+
+// STL
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+void
+set_grid_extent(double dx, double dy, double xmin, double xmax,
+                double ymin, double ymax,
+                gde::geom::algorithm::grid_index& grid)
+{
+  grid.xmin = xmin;
+  grid.ymin = ymin;
+  grid.dx = dx;
+  grid.dy = dy;
+
+// coordinates equal to xmax or ymax fall in the last column or row
+  grid.ncols = static_cast<std::size_t>((xmax - xmin) / dx) + 1;
+  grid.nrows = static_cast<std::size_t>((ymax - ymin) / dy) + 1;
+}
+
+void
+set_tile_extent(double dy, double ymin, double ymax,
+                gde::geom::algorithm::grid_index& grid)
+{
+// a single column as wide as the whole plane
+  grid.xmin = 0.0;
+  grid.ymin = ymin;
+  grid.dx = std::numeric_limits<double>::infinity();
+  grid.dy = dy;
+
+  grid.ncols = 1;
+  grid.nrows = static_cast<std::size_t>((ymax - ymin) / dy) + 1;
+}
+
+// segments are visited in the given order, or in the input order if there is none:
+// the order may also hold only some of the segments, which are the only ones indexed
+void
+fill_grid_index(const std::vector<gde::geom::core::line_segment>& segments,
+                const std::vector<std::uint32_t>* order,
+                gde::geom::algorithm::grid_index& grid)
+{
+  gde::geom::algorithm::check_indexed_segments(segments.size(), "grid_index");
+
+  const std::size_t ncells = grid.ncols * grid.nrows;
+
+  const std::size_t nsegments = order ? order->size() : segments.size();
+
+// a permutation of all the segments gives the same counts as the input order
+  const bool subset = order && (nsegments != segments.size());
+
+// first pass: count the segments in each cell
+  grid.offsets.assign(ncells + 1, 0);
+
+  for(std::size_t k = 0; k != nsegments; ++k)
+  {
+    const std::uint32_t i = subset ? (*order)[k] : static_cast<std::uint32_t>(k);
+
+    std::pair<std::size_t, std::size_t> min_max_col = grid.col_range(segments[i]);
+    std::pair<std::size_t, std::size_t> min_max_row = grid.row_range(segments[i]);
+
+    for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+      for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+        ++grid.offsets[grid.cell(col, row) + 1];
+  }
+
+// turn the counts into the start of each cell
+  for(std::size_t c = 0; c != ncells; ++c)
+    grid.offsets[c + 1] += grid.offsets[c];
+
+// second pass: scatter the segments in their cells
+  grid.ids.resize(grid.offsets[ncells]);
+
+  std::vector<std::size_t> pos(grid.offsets.begin(), grid.offsets.end() - 1);
+
+  for(std::size_t k = 0; k != nsegments; ++k)
+  {
+    const std::uint32_t i = order ? (*order)[k] : static_cast<std::uint32_t>(k);
+
+    std::pair<std::size_t, std::size_t> min_max_col = grid.col_range(segments[i]);
+    std::pair<std::size_t, std::size_t> min_max_row = grid.row_range(segments[i]);
+
+    for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+      for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+        grid.ids[pos[grid.cell(col, row)]++] = i;
+  }
+}
+
+/*!
+  \struct grid_build_computer
+
+  \brief Runs one phase of the parallel grid build over a share of the segments or of the cells.
+ */
+struct grid_build_computer
+{
+  enum phase_type
+  {
+    COUNT,    //!< Count the segments in each cell.
+    PREFIX,   //!< Prefix sum of the counters in a block of cells.
+    SHIFT,    //!< Add the start of the block to its cells.
+    SCATTER,  //!< Put each segment index in its cells.
+    SORT      //!< Sort the indexes in each cell.
+  };
+
+  phase_type phase;
+  std::size_t thread_pos;
+  std::size_t num_threads;
+  const std::vector<gde::geom::core::line_segment>* segments;
+  gde::geom::algorithm::grid_index* grid;
+  std::vector<std::atomic<std::size_t> >* counters;
+  std::vector<std::size_t>* block_sums;
+
+  void operator()()
+  {
+    const std::size_t ncells = grid->ncols * grid->nrows;
+
+// this thread share of cells
+    const std::size_t first_cell = (ncells * thread_pos) / num_threads;
+    const std::size_t last_cell = (ncells * (thread_pos + 1)) / num_threads;
+
+// this thread share of segments
+    const std::size_t first_segment = (segments->size() * thread_pos) / num_threads;
+    const std::size_t last_segment = (segments->size() * (thread_pos + 1)) / num_threads;
+
+    switch(phase)
+    {
+      case COUNT:
+        for(std::size_t i = first_segment; i != last_segment; ++i)
+        {
+          std::pair<std::size_t, std::size_t> min_max_col = grid->col_range((*segments)[i]);
+          std::pair<std::size_t, std::size_t> min_max_row = grid->row_range((*segments)[i]);
+
+          for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+            for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+              (*counters)[grid->cell(col, row)].fetch_add(1, std::memory_order_relaxed);
+        }
+      break;
+
+      case PREFIX:
+      {
+        std::size_t sum = 0;
+
+        for(std::size_t c = first_cell; c != last_cell; ++c)
+        {
+          grid->offsets[c] = sum;
+          sum += (*counters)[c].load(std::memory_order_relaxed);
+        }
+
+        (*block_sums)[thread_pos] = sum;
+      }
+      break;
+
+      case SHIFT:
+      {
+        const std::size_t base = (*block_sums)[thread_pos];
+
+        for(std::size_t c = first_cell; c != last_cell; ++c)
+        {
+          grid->offsets[c] += base;
+          (*counters)[c].store(grid->offsets[c], std::memory_order_relaxed);
+        }
+      }
+      break;
+
+      case SCATTER:
+        for(std::size_t i = first_segment; i != last_segment; ++i)
+        {
+          std::pair<std::size_t, std::size_t> min_max_col = grid->col_range((*segments)[i]);
+          std::pair<std::size_t, std::size_t> min_max_row = grid->row_range((*segments)[i]);
+
+          for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+            for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+              grid->ids[(*counters)[grid->cell(col, row)].fetch_add(1, std::memory_order_relaxed)] = static_cast<std::uint32_t>(i);
+        }
+      break;
+
+      case SORT:
+        for(std::size_t c = first_cell; c != last_cell; ++c)
+          std::sort(grid->ids.begin() + grid->offsets[c], grid->ids.begin() + grid->offsets[c + 1]);
+      break;
+    }
+  }
+};
+
+void
+run_grid_build_phase(gde::geom::algorithm::thread_pool& pool, const grid_build_computer& gc)
+{
+  pool.run([&gc](std::size_t thread_pos)
+           {
+             grid_build_computer c = gc;
+             c.thread_pos = thread_pos;
+             c();
+           });
+}
+
+void
+fill_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                       gde::geom::algorithm::thread_pool& pool,
+                       gde::geom::algorithm::grid_index& grid)
+{
+  gde::geom::algorithm::check_indexed_segments(segments.size(), "grid_index");
+
+  const std::size_t nthreads = pool.size();
+
+  if(nthreads <= 1)
+  {
+    fill_grid_index(segments, 0, grid);
+    return;
+  }
+
+  const std::size_t ncells = grid.ncols * grid.nrows;
+
+  grid.offsets.resize(ncells + 1);
+
+// one shared counter per cell, starting at zero: threads count and then scatter through them
+  std::vector<std::atomic<std::size_t> > counters(ncells);
+
+  std::vector<std::size_t> block_sums(nthreads);
+
+// first pass: count the segments in each cell
+  grid_build_computer gc = {grid_build_computer::COUNT, 0, nthreads, &segments, &grid, &counters, &block_sums};
+
+  run_grid_build_phase(pool, gc);
+
+// turn the counts into the start of each cell: first inside each block of cells...
+  gc.phase = grid_build_computer::PREFIX;
+  run_grid_build_phase(pool, gc);
+
+// ... then add the start of each block
+  std::size_t total = 0;
+
+  for(std::size_t i = 0; i != nthreads; ++i)
+  {
+    std::size_t sum = block_sums[i];
+    block_sums[i] = total;
+    total += sum;
+  }
+
+  grid.offsets[ncells] = total;
+
+  gc.phase = grid_build_computer::SHIFT;
+  run_grid_build_phase(pool, gc);
+
+// second pass: scatter the segments in their cells
+  grid.ids.resize(total);
+
+  gc.phase = grid_build_computer::SCATTER;
+  run_grid_build_phase(pool, gc);
+
+// threads fill a cell in any order: make it the same as the serial build
+  gc.phase = grid_build_computer::SORT;
+  run_grid_build_phase(pool, gc);
+}
+
+/*!
+  \struct grid_ordered_build_computer
+
+  \brief Runs one phase of the parallel grid build that keeps the given order of the segments in each cell.
+
+  Each thread takes a contiguous share of the ordered segments and has its own
+  counter for each cell, so it knows where its entries go in each cell.
+ */
+struct grid_ordered_build_computer
+{
+  enum phase_type
+  {
+    COUNT,    //!< Count the segments of this thread share in each cell.
+    PREFIX,   //!< Start of each thread inside the cells of a block, and the block size.
+    SHIFT,    //!< Add the start of the block to its cells.
+    SCATTER   //!< Put each segment index in its cells.
+  };
+
+  phase_type phase;
+  std::size_t thread_pos;
+  std::size_t num_threads;
+  const std::vector<gde::geom::core::line_segment>* segments;
+  const std::vector<std::uint32_t>* order;
+  gde::geom::algorithm::grid_index* grid;
+  std::vector<std::size_t>* counters;  // num_threads counters for each cell
+  std::vector<std::size_t>* block_sums;
+
+  void operator()()
+  {
+    const std::size_t ncells = grid->ncols * grid->nrows;
+
+// this thread share of cells
+    const std::size_t first_cell = (ncells * thread_pos) / num_threads;
+    const std::size_t last_cell = (ncells * (thread_pos + 1)) / num_threads;
+
+// this thread share of segments
+    const std::size_t first_segment = (order->size() * thread_pos) / num_threads;
+    const std::size_t last_segment = (order->size() * (thread_pos + 1)) / num_threads;
+
+    std::size_t* my_counters = counters->data() + thread_pos * ncells;
+
+    switch(phase)
+    {
+      case COUNT:
+        for(std::size_t k = first_segment; k != last_segment; ++k)
+        {
+          const gde::geom::core::line_segment& s = (*segments)[(*order)[k]];
+
+          std::pair<std::size_t, std::size_t> min_max_col = grid->col_range(s);
+          std::pair<std::size_t, std::size_t> min_max_row = grid->row_range(s);
+
+          for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+            for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+              ++my_counters[grid->cell(col, row)];
+        }
+      break;
+
+      case PREFIX:
+      {
+        std::size_t sum = 0;
+
+        for(std::size_t c = first_cell; c != last_cell; ++c)
+        {
+          grid->offsets[c] = sum;
+
+          for(std::size_t t = 0; t != num_threads; ++t)
+          {
+            std::size_t& counter = (*counters)[t * ncells + c];
+            std::size_t count = counter;
+            counter = sum;
+            sum += count;
+          }
+        }
+
+        (*block_sums)[thread_pos] = sum;
+      }
+      break;
+
+      case SHIFT:
+      {
+        const std::size_t base = (*block_sums)[thread_pos];
+
+        for(std::size_t c = first_cell; c != last_cell; ++c)
+        {
+          grid->offsets[c] += base;
+
+          for(std::size_t t = 0; t != num_threads; ++t)
+            (*counters)[t * ncells + c] += base;
+        }
+      }
+      break;
+
+      case SCATTER:
+        for(std::size_t k = first_segment; k != last_segment; ++k)
+        {
+          const std::uint32_t i = (*order)[k];
+
+          std::pair<std::size_t, std::size_t> min_max_col = grid->col_range((*segments)[i]);
+          std::pair<std::size_t, std::size_t> min_max_row = grid->row_range((*segments)[i]);
+
+          for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+            for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+              grid->ids[my_counters[grid->cell(col, row)]++] = i;
+        }
+      break;
+    }
+  }
+};
+
+void
+run_grid_ordered_build_phase(gde::geom::algorithm::thread_pool& pool, const grid_ordered_build_computer& gc)
+{
+  pool.run([&gc](std::size_t thread_pos)
+           {
+             grid_ordered_build_computer c = gc;
+             c.thread_pos = thread_pos;
+             c();
+           });
+}
+
+void
+fill_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                       const std::vector<std::uint32_t>& order,
+                       gde::geom::algorithm::thread_pool& pool,
+                       gde::geom::algorithm::grid_index& grid)
+{
+  gde::geom::algorithm::check_indexed_segments(segments.size(), "grid_index");
+
+  const std::size_t nthreads = pool.size();
+
+  if(nthreads <= 1)
+  {
+    fill_grid_index(segments, &order, grid);
+    return;
+  }
+
+  const std::size_t ncells = grid.ncols * grid.nrows;
+
+  grid.offsets.resize(ncells + 1);
+
+  std::vector<std::size_t> counters(nthreads * ncells, 0);
+
+  std::vector<std::size_t> block_sums(nthreads);
+
+// first pass: count the segments in each cell
+  grid_ordered_build_computer gc = {grid_ordered_build_computer::COUNT, 0, nthreads, &segments, &order, &grid, &counters, &block_sums};
+
+  run_grid_ordered_build_phase(pool, gc);
+
+// turn the counts into the start of each thread in each cell: first inside each block of cells...
+  gc.phase = grid_ordered_build_computer::PREFIX;
+  run_grid_ordered_build_phase(pool, gc);
+
+// ... then add the start of each block
+  std::size_t total = 0;
+
+  for(std::size_t i = 0; i != nthreads; ++i)
+  {
+    std::size_t sum = block_sums[i];
+    block_sums[i] = total;
+    total += sum;
+  }
+
+  grid.offsets[ncells] = total;
+
+  gc.phase = grid_ordered_build_computer::SHIFT;
+  run_grid_ordered_build_phase(pool, gc);
+
+// second pass: scatter the segments in their cells
+  grid.ids.resize(total);
+
+  gc.phase = grid_ordered_build_computer::SCATTER;
+  run_grid_ordered_build_phase(pool, gc);
+}
+
+void
+gde::geom::algorithm::build_grid_index(const std::vector<gde::geom::core::line_segment>& segments,
+                                       double dx, double dy, double xmin, double xmax,
+                                       double ymin, double ymax,
+                                       grid_index& grid)
+{
+  set_grid_extent(dx, dy, xmin, xmax, ymin, ymax, grid);
+
+  fill_grid_index(segments, 0, grid);
+}
+
+void
+gde::geom::algorithm::build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                              std::size_t nthreads,
+                                              double dx, double dy, double xmin, double xmax,
+                                              double ymin, double ymax,
+                                              grid_index& grid)
+{
+  thread_pool pool(nthreads);
+
+  build_grid_index_thread(segments, pool, dx, dy, xmin, xmax, ymin, ymax, grid);
+}
+
+void
+gde::geom::algorithm::build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                              thread_pool& pool,
+                                              double dx, double dy, double xmin, double xmax,
+                                              double ymin, double ymax,
+                                              grid_index& grid)
+{
+  set_grid_extent(dx, dy, xmin, xmax, ymin, ymax, grid);
+
+  fill_grid_index_thread(segments, pool, grid);
+}
+
+void
+gde::geom::algorithm::build_grid_index(const std::vector<gde::geom::core::line_segment>& segments,
+                                       const std::vector<std::uint32_t>& order,
+                                       double dx, double dy, double xmin, double xmax,
+                                       double ymin, double ymax,
+                                       grid_index& grid)
+{
+  set_grid_extent(dx, dy, xmin, xmax, ymin, ymax, grid);
+
+  fill_grid_index(segments, &order, grid);
+}
+
+void
+gde::geom::algorithm::build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                              const std::vector<std::uint32_t>& order,
+                                              std::size_t nthreads,
+                                              double dx, double dy, double xmin, double xmax,
+                                              double ymin, double ymax,
+                                              grid_index& grid)
+{
+  thread_pool pool(nthreads);
+
+  build_grid_index_thread(segments, order, pool, dx, dy, xmin, xmax, ymin, ymax, grid);
+}
+
+void
+gde::geom::algorithm::build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                              const std::vector<std::uint32_t>& order,
+                                              thread_pool& pool,
+                                              double dx, double dy, double xmin, double xmax,
+                                              double ymin, double ymax,
+                                              grid_index& grid)
+{
+  set_grid_extent(dx, dy, xmin, xmax, ymin, ymax, grid);
+
+  fill_grid_index_thread(segments, order, pool, grid);
+}
+
+void
+gde::geom::algorithm::build_tile_index(const std::vector<gde::geom::core::line_segment>& segments,
+                                       const std::vector<std::uint32_t>& order,
+                                       double dy, double ymin, double ymax,
+                                       grid_index& grid)
+{
+  set_tile_extent(dy, ymin, ymax, grid);
+
+  fill_grid_index(segments, &order, grid);
+}
+
+void
+gde::geom::algorithm::build_tile_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                              const std::vector<std::uint32_t>& order,
+                                              std::size_t nthreads,
+                                              double dy, double ymin, double ymax,
+                                              grid_index& grid)
+{
+  thread_pool pool(nthreads);
+
+  build_tile_index_thread(segments, order, pool, dy, ymin, ymax, grid);
+}
+
+void
+gde::geom::algorithm::build_tile_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                              const std::vector<std::uint32_t>& order,
+                                              thread_pool& pool,
+                                              double dy, double ymin, double ymax,
+                                              grid_index& grid)
+{
+  set_tile_extent(dy, ymin, ymax, grid);
+
+  fill_grid_index_thread(segments, order, pool, grid);
+}
+
+void
+gde::geom::algorithm::build_multilevel_grid_index(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  double dx, double dy, double xmin, double xmax,
+                                                  double ymin, double ymax,
+                                                  multilevel_grid_index& grid)
+{
+  check_indexed_segments(segments.size(), "multilevel_grid_index");
+
+// double the cells until a single one covers the extent
+  grid.levels.clear();
+
+  do
+  {
+    grid_index level;
+
+    set_grid_extent(dx, dy, xmin, xmax, ymin, ymax, level);
+
+    grid.levels.push_back(level);
+
+    dx *= 2.0;
+    dy *= 2.0;
+
+  } while((grid.levels.back().ncols > 1) || (grid.levels.back().nrows > 1));
+
+// each segment goes to the finest level whose cells are as large as its bounding box
+  const std::size_t nlevels = grid.levels.size();
+
+  std::vector<std::vector<std::uint32_t> > level_ids(nlevels);
+
+  grid.segment_levels.resize(segments.size());
+
+  for(std::size_t i = 0; i != segments.size(); ++i)
+  {
+    const double w = std::abs(segments[i].p2.x - segments[i].p1.x);
+    const double h = std::abs(segments[i].p2.y - segments[i].p1.y);
+
+    std::size_t l = 0;
+
+    while((l + 1 != nlevels) && ((w > grid.levels[l].dx) || (h > grid.levels[l].dy)))
+      ++l;
+
+    grid.segment_levels[i] = static_cast<std::uint8_t>(l);
+
+    level_ids[l].push_back(static_cast<std::uint32_t>(i));
+  }
+
+  for(std::size_t l = 0; l != nlevels; ++l)
+    fill_grid_index(segments, &level_ids[l], grid.levels[l]);
+}
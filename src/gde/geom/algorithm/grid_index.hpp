@@ -0,0 +1,268 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/grid_index.hpp
+
+  \brief A uniform grid of line segments stored in compressed sparse row (CSR) layout.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_GRID_INDEX_HPP__
+#define __GDE_GEOM_ALGORITHM_GRID_INDEX_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "thread_pool.hpp"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \struct grid_index
+
+        \brief A uniform grid whose cells hold the indexes of the segments that cross their bounding box.
+
+        Cells are numbered column by column: cell = row + col * nrows.
+        The segments of a cell are ids[offsets[cell]] to ids[offsets[cell + 1] - 1].
+
+        A tile index is a grid with a single column: its cells are horizontal strips.
+
+        \note Segment indexes are 32-bit: an index can hold up to 2^32 - 1 segments (see max_indexed_segments),
+              the build functions throw std::length_error for larger sets.
+       */
+      struct grid_index
+      {
+        double xmin;
+        double ymin;
+        double dx;
+        double dy;
+        std::size_t ncols;
+        std::size_t nrows;
+        std::vector<std::size_t> offsets;  //!< Start of each cell in ids, plus the total number of entries at the end.
+        std::vector<std::uint32_t> ids;    //!< Segment indexes grouped by cell.
+
+        /*! \brief The number of the cell in a given column and row. */
+        std::size_t cell(std::size_t col, std::size_t row) const
+        {
+          return row + col * nrows;
+        }
+
+        /*! \brief The range of columns crossed by the bounding box of segment s, clamped to the grid. */
+        std::pair<std::size_t, std::size_t> col_range(const gde::geom::core::line_segment& s) const
+        {
+          return cell_range(s.p1.x, s.p2.x, xmin, dx, ncols);
+        }
+
+        /*! \brief The range of rows crossed by the bounding box of segment s, clamped to the grid. */
+        std::pair<std::size_t, std::size_t> row_range(const gde::geom::core::line_segment& s) const
+        {
+          return cell_range(s.p1.y, s.p2.y, ymin, dy, nrows);
+        }
+
+        /*!
+          \brief The range of the n cells of size d starting at origin crossed by the interval between a and b.
+
+          The cell numbers are computed and clamped in double precision:
+          coordinates before the origin fall in the first cell and the ones past the end in the last one.
+         */
+        static std::pair<std::size_t, std::size_t> cell_range(double a, double b, double origin, double d, std::size_t n)
+        {
+          const double last_cell = static_cast<double>(n - 1);
+
+          double first = std::floor((std::min(a, b) - origin) / d);
+          double second = std::floor((std::max(a, b) - origin) / d);
+
+          first = std::min(std::max(first, 0.0), last_cell);
+          second = std::min(std::max(second, 0.0), last_cell);
+
+          return std::make_pair(static_cast<std::size_t>(first), static_cast<std::size_t>(second));
+        }
+      };
+
+      /*!
+        \brief Index a set of segments in a uniform grid with cells of size dx by dy covering the given extent.
+
+        The grid is built in two passes: the first one counts the segments of each cell
+        and the second one scatters the segment indexes in their cells.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      build_grid_index(const std::vector<gde::geom::core::line_segment>& segments,
+                       double dx, double dy, double xmin, double xmax,
+                       double ymin, double ymax,
+                       grid_index& grid);
+
+      /*!
+        \brief Index a set of segments in a uniform grid using a given number of threads.
+
+        Each phase of the two pass build runs in parallel: threads count the segments
+        of their share of the input, compute the start of their share of the cells and
+        scatter the segment indexes. The result is the same as build_grid_index.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                              std::size_t nthreads,
+                              double dx, double dy, double xmin, double xmax,
+                              double ymin, double ymax,
+                              grid_index& grid);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                              thread_pool& pool,
+                              double dx, double dy, double xmin, double xmax,
+                              double ymin, double ymax,
+                              grid_index& grid);
+
+      /*!
+        \brief Index a set of segments in a uniform grid, distributing them in the given order.
+
+        The order is kept inside each cell: if it is sorted from left to right, so are the cells.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      build_grid_index(const std::vector<gde::geom::core::line_segment>& segments,
+                       const std::vector<std::uint32_t>& order,
+                       double dx, double dy, double xmin, double xmax,
+                       double ymin, double ymax,
+                       grid_index& grid);
+
+      /*!
+        \brief Index a set of segments in a uniform grid using a given number of threads,
+               distributing them in the given order.
+
+        Each thread has its own counter for each cell: use it for grids with a moderate number of cells.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                              const std::vector<std::uint32_t>& order,
+                              std::size_t nthreads,
+                              double dx, double dy, double xmin, double xmax,
+                              double ymin, double ymax,
+                              grid_index& grid);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      build_grid_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                              const std::vector<std::uint32_t>& order,
+                              thread_pool& pool,
+                              double dx, double dy, double xmin, double xmax,
+                              double ymin, double ymax,
+                              grid_index& grid);
+
+      /*!
+        \brief Index a set of segments in horizontal tiles of height dy covering the range [ymin, ymax].
+
+        Segments are distributed in the given order, which is kept inside each tile:
+        if the order is sorted from left to right, so are the tiles.
+
+        \pre All segments must be inside the range.
+       */
+      void
+      build_tile_index(const std::vector<gde::geom::core::line_segment>& segments,
+                       const std::vector<std::uint32_t>& order,
+                       double dy, double ymin, double ymax,
+                       grid_index& grid);
+
+      /*!
+        \brief Index a set of segments in horizontal tiles using a given number of threads.
+
+        Each thread distributes a contiguous share of the given order and has its own
+        counter for each tile, so the order is also kept inside each tile.
+
+        \pre All segments must be inside the range.
+       */
+      void
+      build_tile_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                              const std::vector<std::uint32_t>& order,
+                              std::size_t nthreads,
+                              double dy, double ymin, double ymax,
+                              grid_index& grid);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      build_tile_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                              const std::vector<std::uint32_t>& order,
+                              thread_pool& pool,
+                              double dy, double ymin, double ymax,
+                              grid_index& grid);
+
+      /*!
+        \struct multilevel_grid_index
+
+        \brief A hierarchy of uniform grids: the cells of each level are twice as large as the ones of the level below.
+
+        Each segment is kept only in the finest level whose cells are at least as large as its bounding box,
+        so it crosses at most 2 by 2 cells of its level: long segments are not copied to the many small cells they cross.
+        The last level has a single cell over the whole extent.
+       */
+      struct multilevel_grid_index
+      {
+        std::vector<grid_index> levels;            //!< Level l has cells of size dx * 2^l by dy * 2^l and the segments that match this size.
+        std::vector<std::uint8_t> segment_levels;  //!< The level of each segment.
+
+        /*! \brief The number of entries of all levels: at most 4 times the number of segments. */
+        std::size_t size() const
+        {
+          std::size_t n = 0;
+
+          for(std::size_t l = 0; l != levels.size(); ++l)
+            n += levels[l].ids.size();
+
+          return n;
+        }
+      };
+
+      /*!
+        \brief Index a set of segments in a multi-level grid whose finest cells are of size dx by dy and cover the given extent.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      build_multilevel_grid_index(const std::vector<gde::geom::core::line_segment>& segments,
+                                  double dx, double dy, double xmin, double xmax,
+                                  double ymin, double ymax,
+                                  multilevel_grid_index& grid);
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_GRID_INDEX_HPP__
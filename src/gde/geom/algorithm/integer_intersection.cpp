@@ -0,0 +1,146 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/integer_intersection.cpp
+
+  \brief Exact intersection of segments with integer coordinates.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "integer_intersection.hpp"
+
+// STL
+#include <algorithm>
+
+#ifdef GDE_GEOM_ALGORITHM_INTEGER_ENGINE
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      bool int_point_cmp(const gde::geom::core::int_point* p1, const gde::geom::core::int_point* p2)
+      {
+        if(p1->x != p2->x)
+          return p1->x < p2->x;
+
+        return p1->y < p2->y;
+      }
+
+// order segments from left to right and sort them by their left end-point
+      void
+      prepare_int_segments(const std::vector<gde::geom::core::int_line_segment>& segments,
+                           std::vector<gde::geom::core::int_line_segment>& ordered_segments)
+      {
+        ordered_segments.resize(segments.size());
+
+        std::transform(segments.begin(), segments.end(), ordered_segments.begin(), sort_int_segment_xy());
+
+        std::sort(ordered_segments.begin(), ordered_segments.end(), int_line_segment_xy_cmp());
+      }
+    }
+  }
+}
+
+gde::geom::algorithm::segment_relation_type
+gde::geom::algorithm::compute_collinear_intesection(const gde::geom::core::int_line_segment& s1,
+                                                    const gde::geom::core::int_line_segment& s2,
+                                                    rational_point& first,
+                                                    rational_point& second)
+{
+// let's order the segments and find out intersection(s)
+  const gde::geom::core::int_point* pts[4];
+  pts[0] = &s1.p1;
+  pts[1] = &s1.p2;
+  pts[2] = &s2.p1;
+  pts[3] = &s2.p2;
+
+  std::sort(pts, pts + 4, int_point_cmp);
+
+// at least they will share one point
+  first = make_rational_point(*pts[1]);
+
+// and if segments touch in a single point they are equal
+  if(*pts[1] == *pts[2])
+    return TOUCH;
+
+// otherwise, the middle points are the intesections
+  second = make_rational_point(*pts[2]);
+
+  return OVERLAP;
+}
+
+std::vector<gde::geom::algorithm::rational_point>
+gde::geom::algorithm::lazy_intersection(const std::vector<gde::geom::core::int_line_segment>& segments)
+{
+  std::vector<rational_point> result;
+
+  rational_point_sink sink = { &result };
+
+  lazy_intersection_core<kernel_exact, int_bbox_test>(segments, 0, segments.size(), sink);
+
+  return result;
+}
+
+std::vector<gde::geom::algorithm::rational_point>
+gde::geom::algorithm::x_order_intersection(const std::vector<gde::geom::core::int_line_segment>& segments)
+{
+  std::vector<rational_point> ipts;
+
+  if(segments.size() <= 1)
+    return ipts;
+
+  std::vector<gde::geom::core::int_line_segment> ordered_segments;
+
+  prepare_int_segments(segments, ordered_segments);
+
+  rational_point_sink sink = { &ipts };
+
+  x_order_intersection_core<kernel_exact, int_y_interval_test>(ordered_segments, 0, ordered_segments.size() - 1, sink);
+
+  return ipts;
+}
+
+std::vector<gde::geom::core::int_point>
+gde::geom::algorithm::x_order_intersection_snapped(const std::vector<gde::geom::core::int_line_segment>& segments)
+{
+  std::vector<gde::geom::core::int_point> ipts;
+
+  if(segments.size() <= 1)
+    return ipts;
+
+  std::vector<gde::geom::core::int_line_segment> ordered_segments;
+
+  prepare_int_segments(segments, ordered_segments);
+
+  snapped_point_sink sink = { &ipts };
+
+  x_order_intersection_core<kernel_exact, int_y_interval_test>(ordered_segments, 0, ordered_segments.size() - 1, sink);
+
+  return ipts;
+}
+
+#endif // GDE_GEOM_ALGORITHM_INTEGER_ENGINE
@@ -0,0 +1,421 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/integer_intersection.hpp
+
+  \brief Exact intersection of segments with integer coordinates.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+#ifndef __GDE_GEOM_ALGORITHM_INTEGER_INTERSECTION_HPP__
+#define __GDE_GEOM_ALGORITHM_INTEGER_INTERSECTION_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "intersection_core.hpp"
+#include "line_segment_intersection.hpp"
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// the integer engine needs 128-bit integers for exact products of coordinate differences
+#if defined(__SIZEOF_INT128__)
+#define GDE_GEOM_ALGORITHM_INTEGER_ENGINE
+#endif
+
+#ifdef GDE_GEOM_ALGORITHM_INTEGER_ENGINE
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*! \brief A signed 128-bit integer. */
+      __extension__ typedef __int128 int128;
+
+      /*!
+        \struct rational_point
+
+        \brief An exact intersection point between segments with integer coordinates: (x / den, y / den).
+
+        \note den is always positive. The fraction is not reduced.
+       */
+      struct rational_point
+      {
+        int128 x;
+        int128 y;
+        int128 den;
+      };
+
+      /*! \brief The rational point with the same coordinates as an integer point. */
+      inline rational_point
+      make_rational_point(const gde::geom::core::int_point& p)
+      {
+        rational_point r = { p.x, p.y, 1 };
+
+        return r;
+      }
+
+      /*! \brief The largest integer not greater than n / d, for d > 0. */
+      inline int128
+      floor_div(int128 n, int128 d)
+      {
+        int128 q = n / d;
+
+        if(((n % d) != 0) && (n < 0))
+          --q;
+
+        return q;
+      }
+
+      /*! \brief Convert a rational point to the closest point with double coordinates. */
+      inline gde::geom::core::point
+      to_point(const rational_point& p)
+      {
+        const double den = static_cast<double>(p.den);
+
+// take the integer part out first, so the fraction doesn't lose precision
+        int128 qx = floor_div(p.x, p.den);
+        int128 qy = floor_div(p.y, p.den);
+
+        gde::geom::core::point result = { static_cast<double>(qx) + static_cast<double>(p.x - qx * p.den) / den,
+                                          static_cast<double>(qy) + static_cast<double>(p.y - qy * p.den) / den };
+
+        return result;
+      }
+
+      /*! \brief Snap a rational point to the nearest integer point, rounding halves up. */
+      inline gde::geom::core::int_point
+      snap(const rational_point& p)
+      {
+        gde::geom::core::int_point result = { static_cast<std::int32_t>(floor_div(2 * p.x + p.den, 2 * p.den)),
+                                              static_cast<std::int32_t>(floor_div(2 * p.y + p.den, 2 * p.den)) };
+
+        return result;
+      }
+
+      /*!
+        \brief Exact orientation test: twice the signed area of the triangle (a, b, c).
+
+        \return A positive value if c is to the left of the directed line ab,
+                a negative value if it is to the right and zero if the three points are collinear.
+       */
+      inline int128
+      orientation(const gde::geom::core::int_point& a,
+                  const gde::geom::core::int_point& b,
+                  const gde::geom::core::int_point& c)
+      {
+        const std::int64_t abx = static_cast<std::int64_t>(b.x) - a.x;
+        const std::int64_t aby = static_cast<std::int64_t>(b.y) - a.y;
+        const std::int64_t acx = static_cast<std::int64_t>(c.x) - a.x;
+        const std::int64_t acy = static_cast<std::int64_t>(c.y) - a.y;
+
+        return static_cast<int128>(abx) * acy - static_cast<int128>(aby) * acx;
+      }
+
+      /*! \brief Test if the point p collinear to the end-points of segment s is inside it or not. */
+      inline bool
+      is_collinear_point_on_segment(const gde::geom::core::int_point& p, const gde::geom::core::int_line_segment& s)
+      {
+        if((p.x < s.p1.x) && (p.x < s.p2.x))
+          return false;
+
+        if((p.x > s.p1.x) && (p.x > s.p2.x))
+          return false;
+
+        if((p.y < s.p1.y) && (p.y < s.p2.y))
+          return false;
+
+        if((p.y > s.p1.y) && (p.y > s.p2.y))
+          return false;
+
+        return true;
+      }
+
+      /*! \brief Test if two collinear segments with integer coordinates intersects. */
+      inline bool
+      do_collinear_segments_intersects(const gde::geom::core::int_line_segment& s1,
+                                       const gde::geom::core::int_line_segment& s2)
+      {
+        return is_collinear_point_on_segment(s1.p1, s2) || is_collinear_point_on_segment(s1.p2, s2) ||
+               is_collinear_point_on_segment(s2.p1, s1) || is_collinear_point_on_segment(s2.p2, s1);
+      }
+
+      /*!
+        \brief Compute the intersection of two collinear segments with integer coordinates that are known to intersect.
+
+        \return TOUCH if they share a single end-point and OVERLAP otherwise.
+       */
+      segment_relation_type
+      compute_collinear_intesection(const gde::geom::core::int_line_segment& s1,
+                                    const gde::geom::core::int_line_segment& s2,
+                                    rational_point& first,
+                                    rational_point& second);
+
+      /*! \brief Test if both segments with integer coordinates intersects: the result is exact. */
+      inline bool
+      do_intersects_exact(const gde::geom::core::int_line_segment& s1,
+                          const gde::geom::core::int_line_segment& s2)
+      {
+        int128 o1 = orientation(s1.p1, s1.p2, s2.p1);
+        int128 o2 = orientation(s1.p1, s1.p2, s2.p2);
+
+        if(((o1 > 0) && (o2 > 0)) || ((o1 < 0) && (o2 < 0)))
+          return false;
+
+        int128 o3 = orientation(s2.p1, s2.p2, s1.p1);
+        int128 o4 = orientation(s2.p1, s2.p2, s1.p2);
+
+        if(((o3 > 0) && (o4 > 0)) || ((o3 < 0) && (o4 < 0)))
+          return false;
+
+        if((o1 == 0) && (o2 == 0))
+          return do_collinear_segments_intersects(s1, s2);
+
+        return true;
+      }
+
+      /*!
+        \brief Compute the exact intersection point between two line segments with integer coordinates, if one exists.
+
+        The relations are the same as in compute_intesection_robust: when an end-point lies on the
+        other segment the relation is TOUCH and this end-point is the intersection point.
+
+        \return The type of intersection between line segments.
+
+        \warning Doesn't perform bounding box intersect test between segments.
+       */
+      inline segment_relation_type
+      compute_intesection_exact(const gde::geom::core::int_line_segment& s1,
+                                const gde::geom::core::int_line_segment& s2,
+                                rational_point& first,
+                                rational_point& second)
+      {
+        int128 o1 = orientation(s1.p1, s1.p2, s2.p1);
+        int128 o2 = orientation(s1.p1, s1.p2, s2.p2);
+
+// are both end-points of s2 on the same side of s1?
+        if(((o1 > 0) && (o2 > 0)) || ((o1 < 0) && (o2 < 0)))
+          return DISJOINT;
+
+// are they collinear?
+        if((o1 == 0) && (o2 == 0))
+        {
+          if(do_collinear_segments_intersects(s1, s2) == false)
+            return DISJOINT;
+
+          return compute_collinear_intesection(s1, s2, first, second);
+        }
+
+        int128 o3 = orientation(s2.p1, s2.p2, s1.p1);
+        int128 o4 = orientation(s2.p1, s2.p2, s1.p2);
+
+// are both end-points of s1 on the same side of s2?
+        if(((o3 > 0) && (o4 > 0)) || ((o3 < 0) && (o4 < 0)))
+          return DISJOINT;
+
+// does an end-point touch the other segment?
+        if(o1 == 0)
+        {
+          first = make_rational_point(s2.p1);
+          return TOUCH;
+        }
+
+        if(o2 == 0)
+        {
+          first = make_rational_point(s2.p2);
+          return TOUCH;
+        }
+
+        if(o3 == 0)
+        {
+          first = make_rational_point(s1.p1);
+          return TOUCH;
+        }
+
+        if(o4 == 0)
+        {
+          first = make_rational_point(s1.p2);
+          return TOUCH;
+        }
+
+// the crossing is at alpha = o3 / (o3 - o4) along s1: both terms fit in 100 bits
+        int128 den = o3 - o4;
+        int128 num = o3;
+
+        if(den < 0)
+        {
+          den = -den;
+          num = -num;
+        }
+
+        first.x = static_cast<int128>(s1.p1.x) * den + num * (static_cast<std::int64_t>(s1.p2.x) - s1.p1.x);
+        first.y = static_cast<int128>(s1.p1.y) * den + num * (static_cast<std::int64_t>(s1.p2.y) - s1.p1.y);
+        first.den = den;
+
+        return CROSS;
+      }
+
+      /*!
+        \struct sort_int_segment_xy
+
+        Given a line segment with integer coordinates it will build a new one ordered from left to right.
+       */
+      struct sort_int_segment_xy
+      {
+        gde::geom::core::int_line_segment operator()(const gde::geom::core::int_line_segment& s) const
+        {
+          if((s.p1.x > s.p2.x) || ((s.p1.x == s.p2.x) && (s.p1.y > s.p2.y)))
+            return gde::geom::core::int_line_segment(s.p2, s.p1);
+
+          return s;
+        }
+      };
+
+      /*!
+        \struct int_line_segment_xy_cmp
+
+        A functor to compare two segments with integer coordinates from left to right.
+
+        \pre Both segments must be left-right ordered.
+       */
+      struct int_line_segment_xy_cmp
+      {
+        bool operator()(const gde::geom::core::int_line_segment& lhs,
+                        const gde::geom::core::int_line_segment& rhs) const
+        {
+          if(lhs.p1.x != rhs.p1.x)
+            return lhs.p1.x < rhs.p1.x;
+
+          return lhs.p1.y < rhs.p1.y;
+        }
+      };
+
+      /*! \brief Kernel policy: compute_intesection_exact, for segments with integer coordinates. */
+      struct kernel_exact
+      {
+        typedef rational_point point_type;
+
+        static segment_relation_type compute(const gde::geom::core::int_line_segment& s1,
+                                             const gde::geom::core::int_line_segment& s2,
+                                             rational_point& first,
+                                             rational_point& second)
+        {
+          return compute_intesection_exact(s1, s2, first, second);
+        }
+      };
+
+      /*! \brief Bounding box policy for segments with integer coordinates: the same test as bbox_test. */
+      struct int_bbox_test
+      {
+        std::int32_t xmin;
+        std::int32_t xmax;
+        std::int32_t ymin;
+        std::int32_t ymax;
+
+        explicit int_bbox_test(const gde::geom::core::int_line_segment& s)
+          : xmin(std::min(s.p1.x, s.p2.x)), xmax(std::max(s.p1.x, s.p2.x)),
+            ymin(std::min(s.p1.y, s.p2.y)), ymax(std::max(s.p1.y, s.p2.y))
+        {
+        }
+
+        bool operator()(const gde::geom::core::int_line_segment& s) const
+        {
+          if(((s.p1.x < xmin) && (s.p2.x < xmin)) || ((s.p1.x > xmax) && (s.p2.x > xmax)))
+            return false;
+
+          return !(((s.p1.y < ymin) && (s.p2.y < ymin)) || ((s.p1.y > ymax) && (s.p2.y > ymax)));
+        }
+      };
+
+      /*! \brief Bounding box policy for segments with integer coordinates: the same test as y_interval_test. */
+      struct int_y_interval_test
+      {
+        std::int32_t ymin;
+        std::int32_t ymax;
+
+        explicit int_y_interval_test(const gde::geom::core::int_line_segment& s)
+          : ymin(std::min(s.p1.y, s.p2.y)), ymax(std::max(s.p1.y, s.p2.y))
+        {
+        }
+
+        bool operator()(const gde::geom::core::int_line_segment& s) const
+        {
+          return !(((s.p1.y < ymin) && (s.p2.y < ymin)) || ((s.p1.y > ymax) && (s.p2.y > ymax)));
+        }
+      };
+
+      /*! \brief Output sink that appends the exact intersection points to a vector. */
+      struct rational_point_sink
+      {
+        std::vector<rational_point>* ipts;
+
+        void operator()(segment_relation_type, const rational_point& p, std::size_t, std::size_t)
+        {
+          ipts->push_back(p);
+        }
+      };
+
+      /*! \brief Output sink that appends the intersection points snapped to the integer grid to a vector. */
+      struct snapped_point_sink
+      {
+        std::vector<gde::geom::core::int_point>* ipts;
+
+        void operator()(segment_relation_type, const rational_point& p, std::size_t, std::size_t)
+        {
+          ipts->push_back(snap(p));
+        }
+      };
+
+      /*!
+        \brief Find the exact intersection points among a set of segments with integer coordinates,
+               comparing all of them.
+
+        \note This is an O(n^2) algorithm.
+       */
+      std::vector<rational_point>
+      lazy_intersection(const std::vector<gde::geom::core::int_line_segment>& segments);
+
+      /*!
+        \brief Find the exact intersection points among a set of segments with integer coordinates,
+               with the x-order algorithm.
+       */
+      std::vector<rational_point>
+      x_order_intersection(const std::vector<gde::geom::core::int_line_segment>& segments);
+
+      /*!
+        \brief The same as above but with the intersection points snapped to the nearest integer point.
+       */
+      std::vector<gde::geom::core::int_point>
+      x_order_intersection_snapped(const std::vector<gde::geom::core::int_line_segment>& segments);
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // GDE_GEOM_ALGORITHM_INTEGER_ENGINE
+
+#endif // __GDE_GEOM_ALGORITHM_INTEGER_INTERSECTION_HPP__
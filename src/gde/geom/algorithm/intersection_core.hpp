@@ -0,0 +1,1174 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/intersection_core.hpp
+
+  \brief Templated core of the intersection algorithms, parameterized on the kernel, the bounding box test and the output sink.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+#ifndef __GDE_GEOM_ALGORITHM_INTERSECTION_CORE_HPP__
+#define __GDE_GEOM_ALGORITHM_INTERSECTION_CORE_HPP__
+
+// GDE
+#include "grid_index.hpp"
+#include "line_segment_batch.hpp"
+#include "line_segment_intersection.hpp"
+#include "packed_rtree.hpp"
+#include "parallel_sort.hpp"
+#include "quadtree_index.hpp"
+#include "thread_pool.hpp"
+#include "utils.hpp"
+#include "x_order_window.hpp"
+
+// STL
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \brief Kernel policy: compute_intesection_v1.
+
+        A kernel policy tells the type of the intersection points and computes the
+        relation between two segments with a static function.
+       */
+      struct kernel_v1
+      {
+        typedef gde::geom::core::point point_type;
+
+        static segment_relation_type compute(const gde::geom::core::line_segment& s1,
+                                             const gde::geom::core::line_segment& s2,
+                                             gde::geom::core::point& first,
+                                             gde::geom::core::point& second)
+        {
+          return compute_intesection_v1(s1, s2, first, second);
+        }
+      };
+
+      /*! \brief Kernel policy: compute_intesection_v2. */
+      struct kernel_v2
+      {
+        typedef gde::geom::core::point point_type;
+
+        static segment_relation_type compute(const gde::geom::core::line_segment& s1,
+                                             const gde::geom::core::line_segment& s2,
+                                             gde::geom::core::point& first,
+                                             gde::geom::core::point& second)
+        {
+          return compute_intesection_v2(s1, s2, first, second);
+        }
+      };
+
+      /*! \brief Kernel policy: compute_intesection_v3. */
+      struct kernel_v3
+      {
+        typedef gde::geom::core::point point_type;
+
+        static segment_relation_type compute(const gde::geom::core::line_segment& s1,
+                                             const gde::geom::core::line_segment& s2,
+                                             gde::geom::core::point& first,
+                                             gde::geom::core::point& second)
+        {
+          return compute_intesection_v3(s1, s2, first, second);
+        }
+      };
+
+      /*! \brief Kernel policy: compute_intesection_branchless. */
+      struct kernel_branchless
+      {
+        typedef gde::geom::core::point point_type;
+
+        static segment_relation_type compute(const gde::geom::core::line_segment& s1,
+                                             const gde::geom::core::line_segment& s2,
+                                             gde::geom::core::point& first,
+                                             gde::geom::core::point& second)
+        {
+          return compute_intesection_branchless(s1, s2, first, second);
+        }
+      };
+
+      /*! \brief Kernel policy: compute_intesection_robust. */
+      struct kernel_robust
+      {
+        typedef gde::geom::core::point point_type;
+
+        static segment_relation_type compute(const gde::geom::core::line_segment& s1,
+                                             const gde::geom::core::line_segment& s2,
+                                             gde::geom::core::point& first,
+                                             gde::geom::core::point& second)
+        {
+          return compute_intesection_robust(s1, s2, first, second);
+        }
+      };
+
+      /*! \brief The kernel policy of compute_intesection: it depends on GDE_GEOM_ALGORITHM_ROBUST_KERNEL and GDE_GEOM_ALGORITHM_BRANCHLESS_KERNEL. */
+#if defined(GDE_GEOM_ALGORITHM_ROBUST_KERNEL)
+      typedef kernel_robust default_kernel;
+#elif defined(GDE_GEOM_ALGORITHM_BRANCHLESS_KERNEL)
+      typedef kernel_branchless default_kernel;
+#else
+      typedef kernel_v3 default_kernel;
+#endif
+
+      /*!
+        \struct bbox_test
+
+        \brief Bounding box policy: the same test as do_bounding_box_intersects.
+
+        A bounding box policy is built once for the segment that is tested against many others,
+        so the extent of this segment is computed outside the inner loop of the algorithms.
+       */
+      struct bbox_test
+      {
+        double xmin;
+        double xmax;
+        double ymin;
+        double ymax;
+
+        explicit bbox_test(const gde::geom::core::line_segment& s)
+          : xmin(std::min(s.p1.x, s.p2.x)), xmax(std::max(s.p1.x, s.p2.x)),
+            ymin(std::min(s.p1.y, s.p2.y)), ymax(std::max(s.p1.y, s.p2.y))
+        {
+        }
+
+        bool operator()(const gde::geom::core::line_segment& s) const
+        {
+          if(((s.p1.x < xmin) && (s.p2.x < xmin)) || ((s.p1.x > xmax) && (s.p2.x > xmax)))
+            return false;
+
+          return !(((s.p1.y < ymin) && (s.p2.y < ymin)) || ((s.p1.y > ymax) && (s.p2.y > ymax)));
+        }
+      };
+
+      /*!
+        \struct y_interval_test
+
+        \brief Bounding box policy for segments whose x-intervals are already known to intersect:
+               the same test as do_y_interval_intersects.
+       */
+      struct y_interval_test
+      {
+        double ymin;
+        double ymax;
+
+        explicit y_interval_test(const gde::geom::core::line_segment& s)
+          : ymin(std::min(s.p1.y, s.p2.y)), ymax(std::max(s.p1.y, s.p2.y))
+        {
+        }
+
+        bool operator()(const gde::geom::core::line_segment& s) const
+        {
+          return !(((s.p1.y < ymin) && (s.p2.y < ymin)) || ((s.p1.y > ymax) && (s.p2.y > ymax)));
+        }
+      };
+
+      /*! \brief Bounding box policy that lets every pair reach the kernel: it accepts any type of segment. */
+      struct no_bbox_test
+      {
+        template<class Segment>
+        explicit no_bbox_test(const Segment&)
+        {
+        }
+
+        template<class Segment>
+        bool operator()(const Segment&) const
+        {
+          return true;
+        }
+      };
+
+      /*!
+        \struct point_vector_sink
+
+        \brief Output sink that appends the intersection points to a vector.
+
+        A sink is called once for each intersection point, with the relation
+        of the pair of segments that produced it: two times for an overlap.
+        It also receives the indexes of the two segments in the vectors scanned
+        by the algorithm, so a sink may report the pair instead of the point.
+       */
+      struct point_vector_sink
+      {
+        std::vector<gde::geom::core::point>* ipts;
+
+        void operator()(segment_relation_type, const gde::geom::core::point& p, std::size_t, std::size_t)
+        {
+          ipts->push_back(p);
+        }
+      };
+
+      /*!
+        \struct point_count_sink
+
+        \brief Output sink that only counts the intersection points.
+       */
+      struct point_count_sink
+      {
+        std::size_t count;
+
+        template<class Point>
+        void operator()(segment_relation_type, const Point&, std::size_t, std::size_t)
+        {
+          ++count;
+        }
+      };
+
+      /*!
+        \struct intersection_count_sink
+
+        \brief Output sink that counts the intersection points of each type of relation.
+
+        The threaded algorithms keep one of them for each range of work they run,
+        so the counters are never shared between threads until the final sum.
+       */
+      struct intersection_count_sink
+      {
+        intersection_count count;
+
+        template<class Point>
+        void operator()(segment_relation_type relation, const Point&, std::size_t, std::size_t)
+        {
+          ++count.relations[relation];
+        }
+      };
+
+      /*! \brief Sum the counters kept by each thread. */
+      inline intersection_count
+      sum_intersection_counts(const std::vector<intersection_count>& counts)
+      {
+        intersection_count total = intersection_count();
+
+        for(std::size_t i = 0; i != counts.size(); ++i)
+          total.add(counts[i]);
+
+        return total;
+      }
+
+      /*!
+        \struct cell_filter_sink
+
+        \brief Output sink that forwards to another one only the points inside a cell of a grid.
+
+        The tiling algorithms use it so a point of segments sharing many tiles is reported once.
+       */
+      template<class Sink>
+      struct cell_filter_sink
+      {
+        const grid_index* grid;
+        std::size_t col;
+        std::size_t row;
+        Sink* out;
+
+        void operator()(segment_relation_type relation, const gde::geom::core::point& p,
+                        std::size_t i, std::size_t j)
+        {
+          if(is_in_cell(grid->xmin, grid->ymin, grid->dx, grid->dy, col, row, p.x, p.y))
+            (*out)(relation, p, i, j);
+        }
+      };
+
+      /*!
+        \struct quadtree_filter_sink
+
+        \brief Output sink that forwards to another one only the points inside a leaf of a quadtree.
+       */
+      template<class Sink>
+      struct quadtree_filter_sink
+      {
+        const quadtree_index* tree;
+        std::size_t leaf;
+        Sink* out;
+
+        void operator()(segment_relation_type relation, const gde::geom::core::point& p,
+                        std::size_t i, std::size_t j)
+        {
+          if(tree->is_in_leaf(leaf, p.x, p.y))
+            (*out)(relation, p, i, j);
+        }
+      };
+
+      /*!
+        \struct intersection_pair_sink
+
+        \brief Output sink that appends the pairs of segments and the parameters of their intersection points to a vector.
+
+        The indexes received are the ones of the red and blue segments, in this order.
+        For a single set both vectors of segments are the same.
+       */
+      struct intersection_pair_sink
+      {
+        std::vector<intersection_pair>* pairs;
+        const std::vector<gde::geom::core::line_segment>* red_segments;
+        const std::vector<gde::geom::core::line_segment>* blue_segments;
+
+        void operator()(segment_relation_type relation, const gde::geom::core::point& p,
+                        std::size_t red_index, std::size_t blue_index)
+        {
+          intersection_pair ipair = { static_cast<std::uint32_t>(red_index),
+                                      static_cast<std::uint32_t>(blue_index),
+                                      relation,
+                                      segment_parameter((*red_segments)[red_index], p),
+                                      segment_parameter((*blue_segments)[blue_index], p) };
+
+          pairs->push_back(ipair);
+        }
+      };
+
+      /*!
+        \struct ordered_pair_sink
+
+        \brief Output sink for the x-order scan of a single set: it turns the positions
+               of the ordered segments back into the indexes of the input segments
+               before forwarding the point to another sink.
+
+        The pair is reported with the lowest index first.
+       */
+      template<class Sink>
+      struct ordered_pair_sink
+      {
+        Sink* out;
+        const std::uint32_t* ids;
+
+        void operator()(segment_relation_type relation, const gde::geom::core::point& p,
+                        std::size_t i, std::size_t j)
+        {
+          const std::uint32_t first = ids[i];
+          const std::uint32_t second = ids[j];
+
+          if(first < second)
+            (*out)(relation, p, first, second);
+          else
+            (*out)(relation, p, second, first);
+        }
+      };
+
+      /*!
+        \brief Copy the red segments followed by the blue ones, each one ordered from left to right,
+               and sort their indexes from left to right.
+
+        The algorithms on a single set pass it as the red set and an empty blue set.
+
+        \param segments The red segments followed by the blue ones: indexes below red_segments.size() refer to red segments.
+        \param order    The indexes of segments sorted by line_segment_id_xy_cmp.
+
+        \exception std::length_error If there are more than max_indexed_segments segments.
+       */
+      inline void
+      prepare_ordered_segments(const std::vector<gde::geom::core::line_segment>& red_segments,
+                               const std::vector<gde::geom::core::line_segment>& blue_segments,
+                               std::vector<gde::geom::core::line_segment>& segments,
+                               std::vector<std::uint32_t>& order)
+      {
+        check_indexed_segments(red_segments.size() + blue_segments.size(), "prepare_ordered_segments");
+
+        segments.resize(red_segments.size() + blue_segments.size());
+
+        auto it = std::transform(red_segments.begin(), red_segments.end(), segments.begin(), sort_segment_xy());
+        std::transform(blue_segments.begin(), blue_segments.end(), it, sort_segment_xy());
+
+        order.resize(segments.size());
+
+        for(std::size_t i = 0; i != order.size(); ++i)
+          order[i] = static_cast<std::uint32_t>(i);
+
+        std::sort(order.begin(), order.end(), line_segment_id_xy_cmp{&segments});
+      }
+
+      /*! \brief The same as above using the threads of a pool. */
+      inline void
+      prepare_ordered_segments(const std::vector<gde::geom::core::line_segment>& red_segments,
+                               const std::vector<gde::geom::core::line_segment>& blue_segments,
+                               thread_pool& pool,
+                               std::vector<gde::geom::core::line_segment>& segments,
+                               std::vector<std::uint32_t>& order)
+      {
+        check_indexed_segments(red_segments.size() + blue_segments.size(), "prepare_ordered_segments");
+
+        segments.resize(red_segments.size() + blue_segments.size());
+
+        parallel_transform(pool, red_segments.begin(), red_segments.end(), segments.begin(), sort_segment_xy());
+        parallel_transform(pool, blue_segments.begin(), blue_segments.end(), segments.begin() + red_segments.size(), sort_segment_xy());
+
+        order.resize(segments.size());
+
+        for(std::size_t i = 0; i != order.size(); ++i)
+          order[i] = static_cast<std::uint32_t>(i);
+
+        parallel_sort(pool, order.begin(), order.end(), line_segment_id_xy_cmp{&segments});
+      }
+
+      /*!
+        \struct gather_ordered_segment
+
+        \brief A functor that gives the segment of an index: it copies the segments
+               of prepare_ordered_segments in their left to right order.
+       */
+      struct gather_ordered_segment
+      {
+        const std::vector<gde::geom::core::line_segment>* segments;
+
+        gde::geom::core::line_segment operator()(std::uint32_t id) const
+        {
+          return (*segments)[id];
+        }
+      };
+
+      /*!
+        \struct gather_red_blue_segment
+
+        \brief A functor that gives the segment of an index and its color, for the algorithms
+               that keep the color next to each ordered segment.
+       */
+      struct gather_red_blue_segment
+      {
+        const std::vector<gde::geom::core::line_segment>* segments;
+        std::size_t nred;
+
+        std::pair<gde::geom::core::line_segment,
+                  gde::geom::core::color_type> operator()(std::uint32_t id) const
+        {
+          return std::make_pair((*segments)[id], (id < nred) ? gde::geom::core::RED : gde::geom::core::BLUE);
+        }
+      };
+
+      /*!
+        \brief Order the red and blue segments from left to right, each one with its color,
+               and build the keys of the x-order scan over them.
+
+        \exception std::length_error If there are more than max_indexed_segments segments.
+       */
+      inline void
+      prepare_x_order_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                         const std::vector<gde::geom::core::line_segment>& blue_segments,
+                         std::vector<std::pair<gde::geom::core::line_segment,
+                                               gde::geom::core::color_type> >& ordered_segments,
+                         x_order_window& window)
+      {
+        std::vector<gde::geom::core::line_segment> segments;
+        std::vector<std::uint32_t> order;
+
+        prepare_ordered_segments(red_segments, blue_segments, segments, order);
+
+        ordered_segments.resize(segments.size());
+
+        std::transform(order.begin(), order.end(), ordered_segments.begin(), gather_red_blue_segment{&segments, red_segments.size()});
+
+        build_x_order_window(ordered_segments, window);
+      }
+
+      /*! \brief The same as above using the threads of a pool. */
+      inline void
+      prepare_x_order_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                         const std::vector<gde::geom::core::line_segment>& blue_segments,
+                         thread_pool& pool,
+                         std::vector<std::pair<gde::geom::core::line_segment,
+                                               gde::geom::core::color_type> >& ordered_segments,
+                         x_order_window& window)
+      {
+        std::vector<gde::geom::core::line_segment> segments;
+        std::vector<std::uint32_t> order;
+
+        prepare_ordered_segments(red_segments, blue_segments, pool, segments, order);
+
+        ordered_segments.resize(segments.size());
+
+        parallel_transform(pool, order.begin(), order.end(), ordered_segments.begin(), gather_red_blue_segment{&segments, red_segments.size()});
+
+        build_x_order_window(ordered_segments, pool, window);
+      }
+
+      /*!
+        \brief Compute the intersection of a pair of segments and send their intersection points to the sink.
+
+        \return The relation between the segments.
+       */
+      template<class Kernel, class Segment, class Sink>
+      inline segment_relation_type
+      intersect_pair(const Segment& s1, const Segment& s2,
+                     std::size_t i1, std::size_t i2,
+                     Sink& sink)
+      {
+        typename Kernel::point_type ip1;
+        typename Kernel::point_type ip2;
+
+        segment_relation_type relation = Kernel::compute(s1, s2, ip1, ip2);
+
+        if(relation == DISJOINT)
+          return DISJOINT;
+
+        sink(relation, ip1, i1, i2);
+
+        if(relation == OVERLAP)
+          sink(relation, ip2, i1, i2);
+
+        return relation;
+      }
+
+      /*!
+        \struct pair_batch
+
+        \brief Pairs of segments waiting to be tested by a kernel policy.
+
+        Only compute_intesection_v3 has a 4-wide version (compute_intersection_pairs_x4):
+        with any other kernel policy each pair is tested as soon as it is added,
+        so the kernel selected at compile time governs every algorithm.
+        Call flush once the last pair has been added.
+       */
+      template<class Kernel, class Sink>
+      struct pair_batch
+      {
+        Sink* sink;
+
+        void push_back(const gde::geom::core::line_segment& s1, const gde::geom::core::line_segment& s2,
+                       std::size_t i1, std::size_t i2)
+        {
+          intersect_pair<Kernel>(s1, s2, i1, i2, *sink);
+        }
+
+        void flush()
+        {
+        }
+      };
+
+      /*!
+        \brief Pairs of segments tested 4 at a time with the arithmetic of compute_intesection_v3.
+
+        The points are sent to the sink in the order the pairs were added. Parallel pairs,
+        and the pairs of a partial batch, are tested one at a time with compute_intesection_v3.
+       */
+      template<class Sink>
+      struct pair_batch<kernel_v3, Sink>
+      {
+        Sink* sink;
+        line_segment_batch batch;
+        std::size_t first_ids[4];
+        std::size_t second_ids[4];
+
+        void push_back(const gde::geom::core::line_segment& s1, const gde::geom::core::line_segment& s2,
+                       std::size_t i1, std::size_t i2)
+        {
+          first_ids[batch.size] = i1;
+          second_ids[batch.size] = i2;
+
+          batch.push_back(s1, s2);
+
+          if(batch.full())
+            flush();
+        }
+
+        void flush()
+        {
+          gde::geom::core::point ips[4];
+
+          unsigned int hits = 0;
+
+// a partial batch is not worth a vector pass: test it pair by pair
+          unsigned int parallel = 0xF;
+
+          if(batch.full())
+            hits = compute_intersection_pairs_x4(batch.sx1, batch.sy1, batch.sx2, batch.sy2,
+                                                 batch.x1, batch.y1, batch.x2, batch.y2,
+                                                 ips, parallel);
+
+// a pair that is not parallel is reported as a crossing, as in compute_intesection_v3
+          for(std::size_t k = 0; k != batch.size; ++k)
+          {
+            if(hits & (1u << k))
+              (*sink)(CROSS, ips[k], first_ids[k], second_ids[k]);
+            else if(parallel & (1u << k))
+              intersect_pair<kernel_v3>(*batch.first[k], *batch.second[k], first_ids[k], second_ids[k], *sink);
+          }
+
+          batch.size = 0;
+        }
+      };
+
+      /*!
+        \brief Test segments [first, last) against all the segments that come after them, as in lazy_intersection.
+       */
+      template<class Kernel, class BBoxTest, class Segment, class Sink>
+      void
+      lazy_intersection_core(const std::vector<Segment>& segments,
+                             std::size_t first, std::size_t last,
+                             Sink& sink)
+      {
+        const std::size_t nsegments = segments.size();
+
+        for(std::size_t i = first; i != last; ++i)
+        {
+          const Segment& red = segments[i];
+
+          const BBoxTest red_box(red);
+
+          for(std::size_t j = i + 1; j < nsegments; ++j)
+          {
+            const Segment& blue = segments[j];
+
+            if(red_box(blue))
+              intersect_pair<Kernel>(red, blue, i, j, sink);
+          }
+        }
+      }
+
+      /*!
+        \brief Test the red segments [first, last) against all the blue segments, as in lazy_intersection_rb.
+
+        The pairs whose boxes intersect are tested through a pair_batch.
+       */
+      template<class Kernel, class BBoxTest, class Sink>
+      void
+      lazy_rb_intersection_core(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                std::size_t first, std::size_t last,
+                                const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                Sink& sink)
+      {
+        const std::size_t nblue_segments = blue_segments.size();
+
+        pair_batch<Kernel, Sink> batch = { &sink };
+
+        for(std::size_t i = first; i != last; ++i)
+        {
+          const gde::geom::core::line_segment& red = red_segments[i];
+
+          const BBoxTest red_box(red);
+
+          for(std::size_t j = 0; j != nblue_segments; ++j)
+          {
+            const gde::geom::core::line_segment& blue = blue_segments[j];
+
+            if(red_box(blue))
+              batch.push_back(red, blue, i, j);
+          }
+        }
+
+        batch.flush();
+      }
+
+      /*!
+        \brief Scan the bands [first, last) of a set of segments ordered from left to right, as in x_order_intersection.
+
+        \pre Each segment must be ordered from left to right, and the set by the left end-point of the segments.
+       */
+      template<class Kernel, class BBoxTest, class Segment, class Sink>
+      void
+      x_order_intersection_core(const std::vector<Segment>& ordered_segments,
+                                std::size_t first, std::size_t last,
+                                Sink& sink)
+      {
+        const std::size_t nsegments = ordered_segments.size();
+
+        for(std::size_t i = first; i != last; ++i)
+        {
+          const Segment& current_seg = ordered_segments[i];
+
+          const BBoxTest current_box(current_seg);
+
+// scan segments from i + 1
+          for(std::size_t j = i + 1; j < nsegments; ++j)
+          {
+            const Segment& next_seg = ordered_segments[j];
+
+// if beginning x-coordinate of the next-segment is greater than
+// the end x-coordinate of the current-segment, they can not intersect
+// and all following sgments will be out-of current segment
+// interval => stop: no more segments can intersects.
+            if(current_seg.p2.x < next_seg.p1.x)
+              break;
+
+// if segments y-interval don't intersect they will not have intersection,
+// let's test the next segment!
+            if(current_box(next_seg))
+              intersect_pair<Kernel>(current_seg, next_seg, i, j, sink);
+          }
+        }
+      }
+
+      /*!
+        \brief Scan the bands [first, last) of a set of red and blue segments ordered from left to right,
+               only testing segments of different colors.
+
+        \param ordered_segments The red and blue segments, each one ordered from left to right, and the set by their left end-point.
+        \param ordered_ids      The index of each ordered segment in the red set followed by the blue set.
+        \param nred             The number of red segments: ids below nred refer to red segments.
+
+        The sink receives the index of the red segment in the red set and the one of the blue segment in the blue set.
+        The candidate pairs are tested through a pair_batch.
+       */
+      template<class Kernel, class BBoxTest, class Sink>
+      void
+      x_order_rb_intersection_core(const std::vector<gde::geom::core::line_segment>& ordered_segments,
+                                   const std::vector<std::uint32_t>& ordered_ids,
+                                   std::size_t nred,
+                                   std::size_t first, std::size_t last,
+                                   Sink& sink)
+      {
+        const std::size_t nsegments = ordered_segments.size();
+
+        pair_batch<Kernel, Sink> batch = { &sink };
+
+        for(std::size_t i = first; i != last; ++i)
+        {
+          const gde::geom::core::line_segment& current_seg = ordered_segments[i];
+
+          const std::size_t current_id = ordered_ids[i];
+
+          const bool current_red = (current_id < nred);
+
+          const BBoxTest current_box(current_seg);
+
+          for(std::size_t j = i + 1; j < nsegments; ++j)
+          {
+            const gde::geom::core::line_segment& next_seg = ordered_segments[j];
+
+// no more segments can intersect the current one
+            if(current_seg.p2.x < next_seg.p1.x)
+              break;
+
+            const std::size_t next_id = ordered_ids[j];
+
+// if segments have the same color, we don't compare!
+            if(current_red == (next_id < nred))
+              continue;
+
+            if(!current_box(next_seg))
+              continue;
+
+            if(current_red)
+              batch.push_back(current_seg, next_seg, current_id, next_id - nred);
+            else
+              batch.push_back(current_seg, next_seg, next_id, current_id - nred);
+          }
+        }
+
+        batch.flush();
+      }
+
+      /*!
+        \brief The x-order scan of red and blue segments over a subset of segments given by their indexes,
+               as in the tiling algorithms.
+
+        \param segments The red segments followed by the blue ones, all of them left-right ordered.
+        \param nred     The number of red segments: indexes below nred refer to red segments.
+
+        The sink receives the index of the red segment in the red set and the one of the blue segment in the blue set.
+        The candidate pairs are tested through a pair_batch.
+
+        \pre The indexes must be sorted from left to right by their segments (see line_segment_id_xy_cmp).
+       */
+      template<class Kernel, class BBoxTest, class Sink>
+      void
+      x_order_rb_subset_intersection_core(const std::vector<gde::geom::core::line_segment>& segments,
+                                          std::size_t nred,
+                                          const std::uint32_t* first, const std::uint32_t* last,
+                                          Sink& sink)
+      {
+        pair_batch<Kernel, Sink> batch = { &sink };
+
+        for(const std::uint32_t* i = first; i != last; ++i)
+        {
+          const gde::geom::core::line_segment& current_seg = segments[*i];
+
+          const bool current_red = (*i < nred);
+
+          const BBoxTest current_box(current_seg);
+
+          for(const std::uint32_t* j = i + 1; j != last; ++j)
+          {
+            const gde::geom::core::line_segment& next_seg = segments[*j];
+
+// no more segments can intersect the current one
+            if(current_seg.p2.x < next_seg.p1.x)
+              break;
+
+// if segments have the same color, we don't compare!
+            if(current_red == (*j < nred))
+              continue;
+
+            if(!current_box(next_seg))
+              continue;
+
+            if(current_red)
+              batch.push_back(current_seg, next_seg, *i, *j - nred);
+            else
+              batch.push_back(current_seg, next_seg, *j, *i - nred);
+          }
+        }
+
+        batch.flush();
+      }
+
+      /*!
+        \brief Scan the bands [first, last) of a set of red and blue segments ordered from left to right,
+               finding the candidates of each band with x_order_candidates, as in x_order_intersection_rb.
+
+        \param ordered_segments The red and blue segments with their colors, each one ordered from left to right, and the set by their left end-point.
+        \param window           The keys of ordered_segments built by build_x_order_window.
+
+        The sink receives the positions of the two segments in ordered_segments, the one of the band first.
+        The candidate pairs are tested through a pair_batch.
+       */
+      template<class Kernel, class Sink>
+      void
+      x_order_window_intersection_core(const std::vector<std::pair<gde::geom::core::line_segment,
+                                                                   gde::geom::core::color_type> >& ordered_segments,
+                                       const x_order_window& window,
+                                       std::size_t first, std::size_t last,
+                                       Sink& sink)
+      {
+        std::vector<std::uint32_t> next_segments;
+
+        pair_batch<Kernel, Sink> batch = { &sink };
+
+        for(std::size_t i = first; i != last; ++i)
+        {
+          const gde::geom::core::line_segment& current_seg = ordered_segments[i].first;
+
+// segments after i, up to the first one to the right of i, with the other color
+// and an y-interval that intersects the one of i
+          x_order_candidates(window, i, next_segments);
+
+          for(std::size_t k = 0; k != next_segments.size(); ++k)
+            batch.push_back(current_seg, ordered_segments[next_segments[k]].first, i, next_segments[k]);
+        }
+
+        batch.flush();
+      }
+
+      /*!
+        \brief Test the red segments [first, last) against the blue segments indexed in a grid, as in fixed_grid_intersection_rb.
+
+        An intersection point is sent to the sink only by the cell that contains it,
+        so a pair of segments sharing many cells reports its points once.
+        The sink receives the index of the red segment and the one of the blue segment.
+       */
+      template<class Kernel, class BBoxTest, class Sink>
+      void
+      grid_intersection_core(const std::vector<gde::geom::core::line_segment>& red_segments,
+                             std::size_t first, std::size_t last,
+                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                             const grid_index& blue_grid,
+                             Sink& sink)
+      {
+        const double xmin = blue_grid.xmin;
+        const double ymin = blue_grid.ymin;
+        const double dx = blue_grid.dx;
+        const double dy = blue_grid.dy;
+
+        gde::geom::core::point ip1;
+        gde::geom::core::point ip2;
+
+        for(std::size_t i = first; i != last; ++i)
+        {
+          const gde::geom::core::line_segment& red = red_segments[i];
+
+          const BBoxTest red_box(red);
+
+          std::pair<std::size_t, std::size_t> min_max_col = blue_grid.col_range(red);
+          std::pair<std::size_t, std::size_t> min_max_row = blue_grid.row_range(red);
+
+          for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+          {
+            for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+            {
+              std::size_t k = blue_grid.cell(col, row);
+
+              const std::size_t cell_last = blue_grid.offsets[k + 1];
+
+              for(std::size_t j = blue_grid.offsets[k]; j != cell_last; ++j)
+              {
+                const std::size_t blue_id = blue_grid.ids[j];
+
+                const gde::geom::core::line_segment& blue = blue_segments[blue_id];
+
+                if(!red_box(blue))
+                  continue;
+
+                segment_relation_type relation = Kernel::compute(red, blue, ip1, ip2);
+
+                if(relation == DISJOINT)
+                  continue;
+
+                if(is_in_cell(xmin, ymin, dx, dy, col, row, ip1.x, ip1.y))
+                  sink(relation, ip1, i, blue_id);
+
+                if((relation == OVERLAP) && is_in_cell(xmin, ymin, dx, dy, col, row, ip2.x, ip2.y))
+                  sink(relation, ip2, i, blue_id);
+              }
+            }
+          }
+        }
+      }
+
+      /*!
+        \brief Test a segment of one set against the segments of the other one indexed in a level of a multi-level grid.
+
+        The indexes sent to the sink are the ones of the red segment and of the blue segment,
+        whichever set the query segment belongs to.
+       */
+      template<class Kernel, class BBoxTest, bool QueryRed, class Sink>
+      void
+      multilevel_grid_visit_level(const gde::geom::core::line_segment& query, std::size_t query_id,
+                                  const std::vector<gde::geom::core::line_segment>& segments,
+                                  const grid_index& level,
+                                  Sink& sink)
+      {
+        const double xmin = level.xmin;
+        const double ymin = level.ymin;
+        const double dx = level.dx;
+        const double dy = level.dy;
+
+        const BBoxTest query_box(query);
+
+        gde::geom::core::point ip1;
+        gde::geom::core::point ip2;
+
+        std::pair<std::size_t, std::size_t> min_max_col = level.col_range(query);
+        std::pair<std::size_t, std::size_t> min_max_row = level.row_range(query);
+
+        for(std::size_t col = min_max_col.first; col <= min_max_col.second; ++col)
+        {
+          for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
+          {
+            std::size_t k = level.cell(col, row);
+
+            const std::size_t cell_last = level.offsets[k + 1];
+
+            for(std::size_t j = level.offsets[k]; j != cell_last; ++j)
+            {
+              const std::size_t id = level.ids[j];
+
+              const gde::geom::core::line_segment& s = segments[id];
+
+              if(!query_box(s))
+                continue;
+
+// the kernel always receives the red segment first
+              const std::size_t red_id = QueryRed ? query_id : id;
+              const std::size_t blue_id = QueryRed ? id : query_id;
+
+              segment_relation_type relation = QueryRed ? Kernel::compute(query, s, ip1, ip2)
+                                                        : Kernel::compute(s, query, ip1, ip2);
+
+              if(relation == DISJOINT)
+                continue;
+
+              if(is_in_cell(xmin, ymin, dx, dy, col, row, ip1.x, ip1.y))
+                sink(relation, ip1, red_id, blue_id);
+
+              if((relation == OVERLAP) && is_in_cell(xmin, ymin, dx, dy, col, row, ip2.x, ip2.y))
+                sink(relation, ip2, red_id, blue_id);
+            }
+          }
+        }
+      }
+
+      /*!
+        \brief Run the queries [first, last) of multilevel_grid_intersection_rb: query i < nred is the red segment i
+                and the other ones are the blue segments i - nred.
+
+        A red segment visits the cells it crosses in the levels of the blue grid not finer than its own,
+        and a blue segment the ones in the levels of the red grid coarser than its own: each pair of
+        segments is tested from the one of the finest level, which crosses at most 2 by 2 cells of
+        each level it visits. As in grid_intersection_core an intersection point is sent to the sink
+        only by the cell of that level that contains it.
+       */
+      template<class Kernel, class BBoxTest, class Sink>
+      void
+      multilevel_grid_intersection_core(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const multilevel_grid_index& red_grid,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        const multilevel_grid_index& blue_grid,
+                                        std::size_t first, std::size_t last,
+                                        Sink& sink)
+      {
+        const std::size_t nred = red_segments.size();
+
+        const std::size_t nlevels = blue_grid.levels.size();
+
+        for(std::size_t i = first; i != last; ++i)
+        {
+          if(i < nred)
+          {
+            for(std::size_t l = red_grid.segment_levels[i]; l != nlevels; ++l)
+              if(!blue_grid.levels[l].ids.empty())
+                multilevel_grid_visit_level<Kernel, BBoxTest, true>(red_segments[i], i, blue_segments, blue_grid.levels[l], sink);
+          }
+          else
+          {
+            for(std::size_t l = blue_grid.segment_levels[i - nred] + 1; l < nlevels; ++l)
+              if(!red_grid.levels[l].ids.empty())
+                multilevel_grid_visit_level<Kernel, BBoxTest, false>(blue_segments[i - nred], i - nred, red_segments, red_grid.levels[l], sink);
+          }
+        }
+      }
+
+      /*!
+        \struct rtree_visit
+
+        \brief A node of a packed R-tree still to be visited by rtree_intersection_core, the range
+               of the red segments that intersect its parent and their box.
+       */
+      struct rtree_visit
+      {
+        std::size_t level;
+        std::size_t k;
+        std::size_t first;
+        std::size_t last;
+        gde::geom::core::rectangle box;
+      };
+
+      /*!
+        \brief Test the red segments of the leaf nodes [first, last) of a packed R-tree against the blue segments
+               of another one, as in rtree_intersection_rb.
+
+        The leaf nodes are the nodes of level 1: each one bounds up to node_capacity red segments
+        that are close along the Hilbert curve. A red leaf node walks the blue tree once for all of
+        its segments. At each blue node only the red segments of the batch that intersect it go down,
+        so a batch of long segments doesn't visit the nodes that none of them reach.
+
+        A segment has a single entry in a tree, so each pair is tested once and its points need no filter.
+        The sink receives the index of the red segment and the one of the blue segment.
+
+        \pre Both trees must have at least the levels 0 and 1.
+       */
+      template<class Kernel, class Sink>
+      void
+      rtree_intersection_core(const std::vector<gde::geom::core::line_segment>& red_segments,
+                              const packed_rtree& red_tree,
+                              std::size_t first, std::size_t last,
+                              const std::vector<gde::geom::core::line_segment>& blue_segments,
+                              const packed_rtree& blue_tree,
+                              Sink& sink)
+      {
+        const std::size_t root_level = blue_tree.nlevels() - 1;
+
+        std::vector<rtree_visit> stack;
+
+// the positions of the red segments that go down each visited node, one range after the other
+        std::vector<std::size_t> reds;
+
+        for(std::size_t n = first; n != last; ++n)
+        {
+          const std::pair<std::size_t, std::size_t> batch = red_tree.children(1, red_tree.levels[1] + n);
+
+          reds.clear();
+
+          for(std::size_t r = batch.first; r != batch.second; ++r)
+            reds.push_back(r);
+
+          rtree_visit root = { root_level, blue_tree.levels[root_level], 0, reds.size(), red_tree.boxes[red_tree.levels[1] + n] };
+
+          stack.push_back(root);
+
+          while(!stack.empty())
+          {
+            const rtree_visit visit = stack.back();
+
+            stack.pop_back();
+
+            const gde::geom::core::rectangle& blue_node_box = blue_tree.boxes[visit.k];
+
+// most nodes are apart from all the red segments of the parent
+            if(!boxes_intersect(visit.box, blue_node_box))
+              continue;
+
+// the red segments of the parent that reach this node
+            const std::size_t active_first = reds.size();
+
+            gde::geom::core::rectangle active_box;
+
+            for(std::size_t r = visit.first; r != visit.last; ++r)
+            {
+              const gde::geom::core::rectangle& red_box = red_tree.boxes[reds[r]];
+
+              if(!boxes_intersect(red_box, blue_node_box))
+                continue;
+
+              reds.push_back(reds[r]);
+
+              active_box.ll.x = std::min(active_box.ll.x, red_box.ll.x);
+              active_box.ll.y = std::min(active_box.ll.y, red_box.ll.y);
+              active_box.ur.x = std::max(active_box.ur.x, red_box.ur.x);
+              active_box.ur.y = std::max(active_box.ur.y, red_box.ur.y);
+            }
+
+            const std::size_t active_last = reds.size();
+
+            if(active_first == active_last)
+              continue;
+
+            const std::pair<std::size_t, std::size_t> children = blue_tree.children(visit.level, visit.k);
+
+// an inner node: its children are visited from left to right along the curve
+            if(visit.level > 1)
+            {
+              for(std::size_t c = children.second; c != children.first; --c)
+              {
+                rtree_visit child = { visit.level - 1, c - 1, active_first, active_last, active_box };
+
+                stack.push_back(child);
+              }
+
+              continue;
+            }
+
+// a blue leaf node: each of its segments is tested against the red segments that reach it
+            for(std::size_t b = children.first; b != children.second; ++b)
+            {
+              const gde::geom::core::rectangle& blue_box = blue_tree.boxes[b];
+
+              if(!boxes_intersect(active_box, blue_box))
+                continue;
+
+              const std::size_t blue_id = blue_tree.ids[b];
+
+              const gde::geom::core::line_segment& blue = blue_segments[blue_id];
+
+              for(std::size_t r = active_first; r != active_last; ++r)
+              {
+                if(!boxes_intersect(red_tree.boxes[reds[r]], blue_box))
+                  continue;
+
+                const std::size_t red_id = red_tree.ids[reds[r]];
+
+                intersect_pair<Kernel>(red_segments[red_id], blue, red_id, blue_id, sink);
+              }
+            }
+          }
+        }
+      }
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_INTERSECTION_CORE_HPP__
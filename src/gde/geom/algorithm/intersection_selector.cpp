@@ -0,0 +1,409 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/intersection_selector.cpp
+
+  \brief A red-blue intersection entry point that chooses the algorithm from statistics of its input.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "intersection_selector.hpp"
+#include "line_segments_intersection.hpp"
+#include "utils.hpp"
+
+// STL
+#include <algorithm>
+#include <cmath>
+
+// relative costs of the steps of the lazy and x-order algorithms, in the units of the resolution planners
+const double cost_lazy_pair = 0.45;     // a bounding box test in the nested loops of the lazy algorithm
+const double cost_sort = 1.1;           // a comparison while sorting the segments from left to right
+const double cost_scan = 0.17;          // a step of the x-order scan
+const double cost_full_test = 3.0;      // the orientation tests of a pair whose bounding boxes intersect
+
+// the number of segments of each set sampled to count the pairs whose bounding boxes intersect
+const std::size_t overlap_sample_size = 4096;
+
+// the cost of starting a thread and sharing the work with it
+const double cost_thread = 5000.0;
+
+// the x-interval of a sampled segment and the number of segments it stands for
+struct sampled_x_interval
+{
+  double xmin;
+  double xmax;
+  double weight;
+};
+
+void
+sample_x_intervals(const std::vector<gde::geom::core::line_segment>& segments,
+                   std::size_t sample_size,
+                   std::vector<sampled_x_interval>& intervals)
+{
+  const std::size_t n = std::min(std::max(sample_size, std::size_t(1)), segments.size());
+
+  if(n == 0)
+    return;
+
+  const double stride = static_cast<double>(segments.size()) / static_cast<double>(n);
+
+  for(std::size_t k = 0; k != n; ++k)
+  {
+    const gde::geom::core::line_segment& s = segments[static_cast<std::size_t>(static_cast<double>(k) * stride)];
+
+    sampled_x_interval interval = { std::min(s.p1.x, s.p2.x), std::max(s.p1.x, s.p2.x), stride };
+
+    intervals.push_back(interval);
+  }
+}
+
+struct sampled_x_interval_cmp
+{
+  bool operator()(const sampled_x_interval& lhs, const sampled_x_interval& rhs) const
+  {
+    return lhs.xmin < rhs.xmin;
+  }
+};
+
+// the x-order scan of a segment walks over the segments that start inside its x-interval:
+// the number of steps is estimated from the occupancy of the x-intervals of a sample of both sets
+double
+x_order_scan_length(const std::vector<gde::geom::core::line_segment>& red_segments,
+                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                    std::size_t sample_size)
+{
+  std::vector<sampled_x_interval> intervals;
+
+  sample_x_intervals(red_segments, sample_size, intervals);
+  sample_x_intervals(blue_segments, sample_size, intervals);
+
+  std::sort(intervals.begin(), intervals.end(), sampled_x_interval_cmp());
+
+// the left ends in order and the number of segments that start before each one
+  std::vector<double> starts(intervals.size());
+  std::vector<double> weights(intervals.size() + 1, 0.0);
+
+  for(std::size_t k = 0; k != intervals.size(); ++k)
+  {
+    starts[k] = intervals[k].xmin;
+    weights[k + 1] = weights[k] + intervals[k].weight;
+  }
+
+  double length = 0.0;
+
+  for(const sampled_x_interval& interval : intervals)
+  {
+    std::size_t first = std::lower_bound(starts.begin(), starts.end(), interval.xmin) - starts.begin();
+    std::size_t last = std::upper_bound(starts.begin(), starts.end(), interval.xmax) - starts.begin();
+
+// the segments starting inside the interval, but the segment itself
+    length += interval.weight * std::max(weights[last] - weights[first] - 1.0, 0.0);
+  }
+
+// each pair is walked once, from its leftmost segment
+  return 0.5 * length;
+}
+
+// the extent of the intersection of the bounding boxes of the sampled pairs whose boxes intersect
+struct box_overlap
+{
+  double dx;
+  double dy;
+};
+
+struct rectangle_xmin_cmp
+{
+  bool operator()(const gde::geom::core::rectangle& lhs, const gde::geom::core::rectangle& rhs) const
+  {
+    return lhs.ll.x < rhs.ll.x;
+  }
+};
+
+// the bounding boxes of a sample of a set of segments, in order from left to right
+void
+sample_boxes(const std::vector<gde::geom::core::line_segment>& segments,
+             std::size_t sample_size,
+             std::vector<gde::geom::core::rectangle>& boxes)
+{
+  const double stride = static_cast<double>(segments.size()) / static_cast<double>(sample_size);
+
+  boxes.resize(sample_size);
+
+  for(std::size_t k = 0; k != sample_size; ++k)
+  {
+    const gde::geom::core::line_segment& s = segments[static_cast<std::size_t>(static_cast<double>(k) * stride)];
+
+    boxes[k] = gde::geom::algorithm::compute_rectangle(&s, &s + 1);
+  }
+
+  std::sort(boxes.begin(), boxes.end(), rectangle_xmin_cmp());
+}
+
+// the boxes of the other sample starting inside the x-interval of a box
+void
+scan_box_overlaps(const gde::geom::core::rectangle& box,
+                  std::vector<gde::geom::core::rectangle>::const_iterator first,
+                  std::vector<gde::geom::core::rectangle>::const_iterator last,
+                  std::vector<box_overlap>& overlaps)
+{
+  for(; (first != last) && (first->ll.x <= box.ur.x); ++first)
+  {
+    box_overlap overlap = { std::min(box.ur.x, first->ur.x) - first->ll.x,
+                            std::min(box.ur.y, first->ur.y) - std::max(box.ll.y, first->ll.y) };
+
+    if(overlap.dy >= 0.0)
+      overlaps.push_back(overlap);
+  }
+}
+
+// the number of red and blue pairs whose bounding boxes intersect, estimated from the pairs of a sample of both sets:
+// the samples are scanned from left to right as in the x-order algorithm, so that a large sample is cheap
+double
+sampled_box_overlaps(const std::vector<gde::geom::core::line_segment>& red_segments,
+                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                     std::vector<box_overlap>& overlaps)
+{
+  const std::size_t nred = std::min(overlap_sample_size, red_segments.size());
+  const std::size_t nblue = std::min(overlap_sample_size, blue_segments.size());
+
+  if((nred == 0) || (nblue == 0))
+    return 0.0;
+
+  std::vector<gde::geom::core::rectangle> red_boxes;
+  std::vector<gde::geom::core::rectangle> blue_boxes;
+
+  sample_boxes(red_segments, nred, red_boxes);
+  sample_boxes(blue_segments, nblue, blue_boxes);
+
+// each pair is found from the box that starts first
+  std::vector<gde::geom::core::rectangle>::const_iterator red_it = red_boxes.begin();
+  std::vector<gde::geom::core::rectangle>::const_iterator blue_it = blue_boxes.begin();
+
+  while((red_it != red_boxes.end()) && (blue_it != blue_boxes.end()))
+  {
+    if(red_it->ll.x <= blue_it->ll.x)
+    {
+      scan_box_overlaps(*red_it, blue_it, blue_boxes.end(), overlaps);
+      ++red_it;
+    }
+    else
+    {
+      scan_box_overlaps(*blue_it, red_it, red_boxes.end(), overlaps);
+      ++blue_it;
+    }
+  }
+
+  return static_cast<double>(overlaps.size()) *
+         static_cast<double>(red_segments.size()) / static_cast<double>(nred) *
+         static_cast<double>(blue_segments.size()) / static_cast<double>(nblue);
+}
+
+// how many cells of a grid test each pair whose bounding boxes intersect
+double
+shared_cells(const std::vector<box_overlap>& overlaps, const gde::geom::algorithm::resolution_plan& plan)
+{
+  if(overlaps.empty())
+    return 1.0;
+
+  double cells = 0.0;
+
+  for(const box_overlap& overlap : overlaps)
+    cells += std::min(overlap.dx / plan.dx + 1.0, static_cast<double>(plan.ncols)) *
+             std::min(overlap.dy / plan.dy + 1.0, static_cast<double>(plan.nrows));
+
+  return cells / static_cast<double>(overlaps.size());
+}
+
+double
+sort_cost(std::size_t n)
+{
+  if(n < 2)
+    return 0.0;
+
+  return cost_sort * static_cast<double>(n) * std::log2(static_cast<double>(n));
+}
+
+gde::geom::algorithm::intersection_selection
+gde::geom::algorithm::select_intersection_algorithm(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    const intersection_options& options)
+{
+  intersection_selection selection = { AUTO_ALGORITHM, 1, 0.0, 0.0, gde::geom::core::rectangle(), 0.0, { 0.0, 0.0, 0.0, 0.0, 0.0 } };
+
+  if(red_segments.empty() || blue_segments.empty())
+    return selection;
+
+  gde::geom::core::rectangle red_rect = compute_rectangle(red_segments.begin(), red_segments.end());
+  gde::geom::core::rectangle blue_rect = compute_rectangle(blue_segments.begin(), blue_segments.end());
+
+// no pair of segments can intersect if their rectangles are apart
+  if((red_rect.ur.x < blue_rect.ll.x) || (blue_rect.ur.x < red_rect.ll.x) ||
+     (red_rect.ur.y < blue_rect.ll.y) || (blue_rect.ur.y < red_rect.ll.y))
+    return selection;
+
+  const double xmin = std::min(red_rect.ll.x, blue_rect.ll.x);
+  const double xmax = std::max(red_rect.ur.x, blue_rect.ur.x);
+  const double ymin = std::min(red_rect.ll.y, blue_rect.ll.y);
+  const double ymax = std::max(red_rect.ur.y, blue_rect.ur.y);
+
+  selection.rect = gde::geom::core::rectangle(xmin, ymin, xmax, ymax);
+
+  const std::size_t nsegments = red_segments.size() + blue_segments.size();
+
+// the pairs that reach the orientation tests in all the algorithms
+  std::vector<box_overlap> overlaps;
+
+  const double candidates = sampled_box_overlaps(red_segments, blue_segments, overlaps);
+
+  selection.costs[LAZY_ALGORITHM] = cost_lazy_pair * static_cast<double>(red_segments.size()) * static_cast<double>(blue_segments.size()) +
+                                    cost_full_test * candidates;
+
+// small inputs: the nested loops are cheaper than sorting or indexing the segments
+  if((options.algorithm == AUTO_ALGORITHM) && (selection.costs[LAZY_ALGORITHM] < sort_cost(nsegments)))
+  {
+    selection.algorithm = LAZY_ALGORITHM;
+    selection.cost = selection.costs[LAZY_ALGORITHM];
+
+    return selection;
+  }
+
+  selection.costs[X_ORDER_ALGORITHM] = sort_cost(nsegments) + cost_scan * x_order_scan_length(red_segments, blue_segments, options.sample_size) +
+                                       cost_full_test * candidates;
+
+// the grid and tiling algorithms test a pair in each cell shared by the pair
+  resolution_plan grid_plan = plan_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, options.sample_size);
+
+  selection.costs[FIXED_GRID_ALGORITHM] = grid_plan.cost + cost_full_test * candidates * shared_cells(overlaps, grid_plan);
+
+  resolution_plan tiling_plan = plan_tiling_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, options.sample_size);
+
+  selection.costs[TILING_ALGORITHM] = sort_cost(nsegments) + tiling_plan.cost + cost_full_test * candidates * shared_cells(overlaps, tiling_plan);
+
+  selection.algorithm = options.algorithm;
+
+  if(selection.algorithm == AUTO_ALGORITHM)
+  {
+    selection.algorithm = LAZY_ALGORITHM;
+
+    for(int a = X_ORDER_ALGORITHM; a <= TILING_ALGORITHM; ++a)
+      if(selection.costs[a] < selection.costs[selection.algorithm])
+        selection.algorithm = static_cast<intersection_algorithm_type>(a);
+  }
+
+  if(selection.algorithm == FIXED_GRID_ALGORITHM)
+  {
+    selection.dx = grid_plan.dx;
+    selection.dy = grid_plan.dy;
+  }
+  else if(selection.algorithm == TILING_ALGORITHM)
+  {
+    selection.dx = tiling_plan.dx;
+    selection.dy = tiling_plan.dy;
+  }
+
+  selection.cost = selection.costs[selection.algorithm];
+
+// the work is shared among the threads if it pays for starting them, or if the algorithm was given
+  const double nthreads = static_cast<double>(std::max(options.nthreads, std::size_t(1)));
+
+  const double threaded_cost = selection.cost / nthreads + cost_thread * nthreads;
+
+  if((options.nthreads > 1) && ((options.algorithm != AUTO_ALGORITHM) || (threaded_cost < selection.cost)))
+  {
+    selection.nthreads = options.nthreads;
+    selection.cost = threaded_cost;
+  }
+
+  return selection;
+}
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                      const intersection_options& options)
+{
+  intersection_selection selection;
+
+  return intersection_rb(red_segments, blue_segments, options, selection);
+}
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                      const intersection_options& options,
+                                      intersection_selection& selection)
+{
+  selection = select_intersection_algorithm(red_segments, blue_segments, options);
+
+  std::vector<gde::geom::core::point> ipts;
+
+  if(selection.algorithm == AUTO_ALGORITHM)
+    return ipts;
+
+// the grid and tiling algorithms cover the rectangle of both sets
+  const gde::geom::core::rectangle& r = selection.rect;
+
+  const bool threaded = (selection.nthreads > 1);
+
+  switch(selection.algorithm)
+  {
+    case LAZY_ALGORITHM:
+      if(threaded)
+        lazy_intersection_rb_thread(red_segments, blue_segments, selection.nthreads, ipts);
+      else
+        ipts = lazy_intersection_rb(red_segments, blue_segments);
+      break;
+
+    case X_ORDER_ALGORITHM:
+      if(threaded)
+        x_order_intersection_rb_thread(red_segments, blue_segments, selection.nthreads, ipts);
+      else
+        ipts = x_order_intersection_rb(red_segments, blue_segments);
+      break;
+
+    case FIXED_GRID_ALGORITHM:
+      if(threaded)
+        fixed_grid_intersection_rb_thread(red_segments, blue_segments, selection.nthreads, selection.dx, selection.dy,
+                                          r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
+      else
+        ipts = fixed_grid_intersection_rb(red_segments, blue_segments, selection.dx, selection.dy,
+                                          r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+      break;
+
+    case TILING_ALGORITHM:
+      if(threaded)
+        tiling_intersection_rb_thread(red_segments, blue_segments, selection.nthreads, selection.dx, selection.dy,
+                                      r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
+      else
+        ipts = tiling_intersection_rb(red_segments, blue_segments, selection.dx, selection.dy,
+                                      r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+      break;
+
+    default:
+      break;
+  }
+
+  return ipts;
+}
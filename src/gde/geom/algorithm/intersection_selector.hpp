@@ -0,0 +1,131 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/intersection_selector.hpp
+
+  \brief A red-blue intersection entry point that chooses the algorithm from statistics of its input.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+#ifndef __GDE_GEOM_ALGORITHM_INTERSECTION_SELECTOR_HPP__
+#define __GDE_GEOM_ALGORITHM_INTERSECTION_SELECTOR_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "resolution_planner.hpp"
+
+// STL
+#include <cstddef>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \enum intersection_algorithm_type
+
+        \brief The red-blue intersection algorithms that intersection_rb can run.
+       */
+      enum intersection_algorithm_type
+      {
+        AUTO_ALGORITHM,        //!< Let intersection_rb choose the algorithm.
+        LAZY_ALGORITHM,        //!< Test all the pairs: lazy_intersection_rb.
+        X_ORDER_ALGORITHM,     //!< Scan the segments from left to right: x_order_intersection_rb.
+        FIXED_GRID_ALGORITHM,  //!< Index the blue segments in a uniform grid: fixed_grid_intersection_rb.
+        TILING_ALGORITHM       //!< Scan the tiles of a grid from left to right: the two-dimensional tiling_intersection_rb.
+      };
+
+      /*!
+        \struct intersection_options
+
+        \brief The options of intersection_rb.
+       */
+      struct intersection_options
+      {
+        intersection_algorithm_type algorithm = AUTO_ALGORITHM;  //!< The algorithm to run or AUTO_ALGORITHM.
+        std::size_t nthreads = 1;                                //!< The threads that may be used: 1 for the serial algorithms.
+        std::size_t sample_size = planner_sample_size;           //!< The number of segments of each set sampled for the statistics.
+      };
+
+      /*!
+        \struct intersection_selection
+
+        \brief The algorithm chosen by intersection_rb and the estimated costs it was chosen from.
+
+        Costs are in the units of resolution_plan: about the cost of one bounding box test in a grid cell.
+       */
+      struct intersection_selection
+      {
+        intersection_algorithm_type algorithm;  //!< The chosen algorithm, or AUTO_ALGORITHM if no pair of segments can intersect.
+        std::size_t nthreads;                   //!< The threads used by the chosen algorithm: 1 for the serial version.
+        double dx;                              //!< The cell size of the grid or tiling algorithms.
+        double dy;
+        gde::geom::core::rectangle rect;        //!< The rectangle of both sets, covered by the grid or tiling algorithms.
+        double cost;                            //!< The estimated cost of the chosen algorithm.
+        double costs[5];                        //!< The estimated serial cost of each algorithm, indexed by intersection_algorithm_type (0 if not estimated).
+      };
+
+      /*!
+        \brief Choose the red-blue intersection algorithm with the lowest estimated cost for the given segments.
+
+        The statistics are cheap: the size of each set, the overlap of their bounding rectangles,
+        the pairs of a sample of both sets whose bounding boxes intersect and the occupancy of
+        x-bands by the sampled segments, from which the length of the x-order scan is estimated.
+        The grid and tiling costs are the ones of their resolution planners.
+
+        The threaded version of the algorithm is chosen if more than one thread is allowed and
+        the estimated work is large enough to pay for starting them.
+       */
+      intersection_selection
+      select_intersection_algorithm(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    const intersection_options& options = intersection_options());
+
+      /*!
+        \brief Given a set of segments red and blue compute the intersection points between each pair,
+               running the algorithm chosen by select_intersection_algorithm.
+
+        An algorithm given in the options is run instead, with its threaded version if more than
+        one thread is allowed.
+       */
+      std::vector<gde::geom::core::point>
+      intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                      const intersection_options& options = intersection_options());
+
+      /*! \brief The same as above but it also reports the chosen algorithm. */
+      std::vector<gde::geom::core::point>
+      intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                      const intersection_options& options,
+                      intersection_selection& selection);
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_INTERSECTION_SELECTOR_HPP__
@@ -0,0 +1,182 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/intersection_visitor.cpp
+
+  \brief Visitors that receive the intersection points as the algorithms find them.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "intersection_visitor.hpp"
+
+// STL
+#include <stdexcept>
+
+// the number of points kept by a point_file_writer before writing them
+const std::size_t point_file_writer_buffer_size = 8192;
+
+gde::geom::algorithm::callback_visitor::callback_visitor(const callback_type& f)
+  : f_(f)
+{
+}
+
+void
+gde::geom::algorithm::callback_visitor::operator()(segment_relation_type relation,
+                                                   const gde::geom::core::point& p,
+                                                   std::size_t red_index, std::size_t blue_index)
+{
+  f_(relation, p, red_index, blue_index);
+}
+
+gde::geom::algorithm::point_ring_buffer::point_ring_buffer(std::size_t capacity)
+  : buffer_(capacity == 0 ? 1 : capacity),
+    head_(0),
+    size_(0),
+    closed_(false)
+{
+}
+
+void
+gde::geom::algorithm::point_ring_buffer::operator()(segment_relation_type,
+                                                    const gde::geom::core::point& p,
+                                                    std::size_t, std::size_t)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+
+  not_full_.wait(lock, [this]{ return (size_ != buffer_.size()) || closed_; });
+
+// a consumer that closed the buffer takes no more points
+  if(closed_)
+    return;
+
+  buffer_[(head_ + size_) % buffer_.size()] = p;
+
+  ++size_;
+
+  lock.unlock();
+
+  not_empty_.notify_one();
+}
+
+bool
+gde::geom::algorithm::point_ring_buffer::pop(gde::geom::core::point& p)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+
+  not_empty_.wait(lock, [this]{ return (size_ != 0) || closed_; });
+
+  if(size_ == 0)
+    return false;
+
+  p = buffer_[head_];
+
+  head_ = (head_ + 1) % buffer_.size();
+
+  --size_;
+
+  lock.unlock();
+
+  not_full_.notify_one();
+
+  return true;
+}
+
+void
+gde::geom::algorithm::point_ring_buffer::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    closed_ = true;
+  }
+
+  not_empty_.notify_all();
+  not_full_.notify_all();
+}
+
+gde::geom::algorithm::point_file_writer::point_file_writer(const std::string& file_name)
+  : file_(std::fopen(file_name.c_str(), "wb")),
+    npoints_(0)
+{
+  if(file_ == nullptr)
+    throw std::runtime_error("point_file_writer: could not open file '" + file_name + "'.");
+
+  buffer_.reserve(2 * point_file_writer_buffer_size);
+}
+
+gde::geom::algorithm::point_file_writer::~point_file_writer()
+{
+// errors can not be reported from here: call flush before to check them
+  if(!buffer_.empty())
+    std::fwrite(buffer_.data(), sizeof(double), buffer_.size(), file_);
+
+  std::fclose(file_);
+}
+
+void
+gde::geom::algorithm::point_file_writer::operator()(segment_relation_type,
+                                                    const gde::geom::core::point& p,
+                                                    std::size_t, std::size_t)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+
+  buffer_.push_back(p.x);
+  buffer_.push_back(p.y);
+
+  ++npoints_;
+
+  if(buffer_.size() == 2 * point_file_writer_buffer_size)
+    write_buffer();
+}
+
+void
+gde::geom::algorithm::point_file_writer::flush()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+
+  write_buffer();
+
+  if(std::fflush(file_) != 0)
+    throw std::runtime_error("point_file_writer: could not write the points.");
+}
+
+std::size_t
+gde::geom::algorithm::point_file_writer::size() const
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+
+  return npoints_;
+}
+
+void
+gde::geom::algorithm::point_file_writer::write_buffer()
+{
+  const std::size_t n = buffer_.size();
+
+  const std::size_t nwritten = std::fwrite(buffer_.data(), sizeof(double), n, file_);
+
+  buffer_.clear();
+
+  if(nwritten != n)
+    throw std::runtime_error("point_file_writer: could not write the points.");
+}
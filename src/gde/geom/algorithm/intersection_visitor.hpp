@@ -0,0 +1,203 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/intersection_visitor.hpp
+
+  \brief Visitors that receive the intersection points as the algorithms find them.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_INTERSECTION_VISITOR_HPP__
+#define __GDE_GEOM_ALGORITHM_INTERSECTION_VISITOR_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "line_segment_intersection.hpp"
+
+// STL
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \class intersection_visitor
+
+        \brief Receives each intersection point as soon as an algorithm finds it.
+
+        The streaming versions of the algorithms don't keep any point: memory use
+        doesn't depend on the number of points. A visitor is called with the same
+        arguments as the output sinks of the templated core (see intersection_core.hpp):
+        the relation, the point and the indexes of the red and blue segments.
+
+        The threaded algorithms call the same visitor from all of their workers.
+       */
+      class intersection_visitor
+      {
+        public:
+
+          virtual ~intersection_visitor() { }
+
+          virtual void operator()(segment_relation_type relation,
+                                  const gde::geom::core::point& p,
+                                  std::size_t red_index, std::size_t blue_index) = 0;
+      };
+
+      /*!
+        \class callback_visitor
+
+        \brief A visitor that calls a function.
+
+        \note It doesn't synchronize calls: with the threaded algorithms the function must be thread-safe.
+       */
+      class callback_visitor : public intersection_visitor
+      {
+        public:
+
+          typedef std::function<void(segment_relation_type, const gde::geom::core::point&,
+                                     std::size_t, std::size_t)> callback_type;
+
+          explicit callback_visitor(const callback_type& f);
+
+          void operator()(segment_relation_type relation,
+                          const gde::geom::core::point& p,
+                          std::size_t red_index, std::size_t blue_index);
+
+        private:
+
+          callback_type f_;
+      };
+
+      /*!
+        \class point_ring_buffer
+
+        \brief A bounded queue of points between the algorithm threads and a consumer thread.
+
+        The algorithm blocks while the buffer is full, so a slow consumer
+        bounds the memory used instead of letting results pile up.
+        The consumer pops points until the producer closes the buffer.
+        The consumer may also close it to stop early: the producers are woken up
+        and the points pushed after that are dropped.
+       */
+      class point_ring_buffer : public intersection_visitor
+      {
+        public:
+
+          /*! \brief Create a buffer that holds up to capacity points (at least one). */
+          explicit point_ring_buffer(std::size_t capacity);
+
+          point_ring_buffer(const point_ring_buffer&) = delete;
+
+          point_ring_buffer& operator=(const point_ring_buffer&) = delete;
+
+          /*! \brief Push a point: it waits for room in the buffer, or drops the point if the buffer is closed. */
+          void operator()(segment_relation_type relation,
+                          const gde::geom::core::point& p,
+                          std::size_t red_index, std::size_t blue_index);
+
+          /*!
+            \brief Take the oldest point: it waits for a point or for the buffer to be closed.
+
+            \return False if the buffer is closed and empty.
+           */
+          bool pop(gde::geom::core::point& p);
+
+          /*! \brief Tell the consumer that no more points will come, or the producers that no more points are taken. */
+          void close();
+
+        private:
+
+          std::vector<gde::geom::core::point> buffer_;
+          std::size_t head_;
+          std::size_t size_;
+          bool closed_;
+          std::mutex mtx_;
+          std::condition_variable not_full_;
+          std::condition_variable not_empty_;
+      };
+
+      /*!
+        \class point_file_writer
+
+        \brief A visitor that writes the points to a binary file as they come.
+
+        Each point is written as two doubles (x and y) in the byte order of the machine.
+        Points go through a buffer of fixed size, so memory use doesn't grow with the output.
+        Calls are synchronized: the threaded algorithms can share a writer.
+       */
+      class point_file_writer : public intersection_visitor
+      {
+        public:
+
+          /*!
+            \brief Create (or truncate) the file.
+
+            \exception std::runtime_error If the file can not be opened.
+           */
+          explicit point_file_writer(const std::string& file_name);
+
+          /*! \brief Write the buffered points and close the file. */
+          ~point_file_writer();
+
+          point_file_writer(const point_file_writer&) = delete;
+
+          point_file_writer& operator=(const point_file_writer&) = delete;
+
+          void operator()(segment_relation_type relation,
+                          const gde::geom::core::point& p,
+                          std::size_t red_index, std::size_t blue_index);
+
+          /*!
+            \brief Write the buffered points.
+
+            \exception std::runtime_error If the points can not be written.
+           */
+          void flush();
+
+          /*! \brief The number of points received so far. */
+          std::size_t size() const;
+
+        private:
+
+          void write_buffer();
+
+          std::FILE* file_;
+          std::vector<double> buffer_;
+          std::size_t npoints_;
+          mutable std::mutex mtx_;
+      };
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_INTERSECTION_VISITOR_HPP__
@@ -29,43 +29,27 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
-#include "line_segment_intersection.hpp"
+#include "intersection_core.hpp"
 
 std::vector<gde::geom::core::point>
 gde::geom::algorithm::lazy_intersection(const std::vector<gde::geom::core::line_segment>& segments)
 {
   std::vector<gde::geom::core::point> result;
 
-  gde::geom::core::point ip1;
-  gde::geom::core::point ip2;
+  point_vector_sink sink = { &result };
 
-  const std::size_t number_of_segments = segments.size();
+  lazy_intersection_core<default_kernel, bbox_test>(segments, 0, segments.size(), sink);
 
-  for(std::size_t i = 0; i < number_of_segments; ++i)
-  {
-    const gde::geom::core::line_segment& red = segments[i];
-
-    for(std::size_t j = i; j < number_of_segments; ++j)
-    {
-      if(i == j)
-        continue;
-
-      const gde::geom::core::line_segment& blue = segments[j];
-      
-      if(!do_bounding_box_intersects(red, blue))
-        continue;
-
-      segment_relation_type spatial_relation = compute_intesection_v3(red, blue, ip1, ip2);
-
-      if(spatial_relation == DISJOINT)
-        continue;
+  return result;
+}
 
-      result.push_back(ip1);
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::lazy_intersection_count(const std::vector<gde::geom::core::line_segment>& segments)
+{
+  intersection_count_sink sink = {};
 
-      if(spatial_relation == OVERLAP)
-        result.push_back(ip2);
-    }
-  }
+// the relations are classified by the same kernel as the other count functions
+  lazy_intersection_core<default_kernel, bbox_test>(segments, 0, segments.size(), sink);
 
-  return result;
+  return sink.count;
 }
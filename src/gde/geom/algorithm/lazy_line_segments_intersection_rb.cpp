@@ -29,7 +29,7 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
-#include "line_segment_intersection.hpp"
+#include "intersection_core.hpp"
 
 std::vector<gde::geom::core::point>
 gde::geom::algorithm::lazy_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
@@ -37,34 +37,20 @@ gde::geom::algorithm::lazy_intersection_rb(const std::vector<gde::geom::core::li
 {
   std::vector<gde::geom::core::point> result;
 
-  gde::geom::core::point ip1;
-  gde::geom::core::point ip2;
-  
-  const std::size_t rsize = red_segments.size();
-  const std::size_t bsize = blue_segments.size();
+  point_vector_sink sink = { &result };
 
-  for(std::size_t i = 0; i != rsize; ++i)
-  {
-    const gde::geom::core::line_segment& red = red_segments[i];
+  lazy_rb_intersection_core<default_kernel, bbox_test>(red_segments, 0, red_segments.size(), blue_segments, sink);
 
-    for(std::size_t j = 0; j < bsize; ++j)
-    {
-      const gde::geom::core::line_segment& blue = blue_segments[j];
-
-      if(!do_bounding_box_intersects(red, blue))
-        continue;
-
-      segment_relation_type spatial_relation = compute_intesection_v3(red, blue, ip1, ip2);
-
-      if(spatial_relation == DISJOINT)
-        continue;
+  return result;
+}
 
-      result.push_back(ip1);
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::lazy_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                 const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  intersection_count_sink sink = {};
 
-      if(spatial_relation == OVERLAP)
-        result.push_back(ip2);
-    }
-  }
+  lazy_rb_intersection_core<default_kernel, bbox_test>(red_segments, 0, red_segments.size(), blue_segments, sink);
 
-  return result;
+  return sink.count;
 }
@@ -29,50 +29,24 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
+#include "count_then_fill.hpp"
 #include "line_segment_intersection.hpp"
+#include "intersection_core.hpp"
+#include "work_stealing_scheduler.hpp"
 
 // STL
 #include <algorithm>
-#include <thread>
 
-struct intersection_computer
+struct lazy_rb_scan
 {
-  std::size_t thread_pos;
-  std::size_t num_threads;
-  std::vector<gde::geom::core::point>* ipts;
   const std::vector<gde::geom::core::line_segment>* red_segments;
   const std::vector<gde::geom::core::line_segment>* blue_segments;
-  
-  void operator()()
+
+  template<class Sink>
+  void operator()(std::size_t first, std::size_t last, Sink& sink) const
   {
-    gde::geom::core::point ip1;
-    gde::geom::core::point ip2;
-    
-    std::size_t nred_segments = red_segments->size();
-    std::size_t nblue_segments = blue_segments->size();
-    
-    for(std::size_t i = thread_pos; i < nred_segments; i += num_threads)
-    {
-      const gde::geom::core::line_segment& red = (*red_segments)[i];
-      
-      for(std::size_t j = 0; j < nblue_segments; ++j)
-      {
-        const gde::geom::core::line_segment& blue = (*blue_segments)[j];
-        
-        if(!gde::geom::algorithm::do_bounding_box_intersects(red, blue))
-          continue;
-        
-        gde::geom::algorithm::segment_relation_type spatial_relation = gde::geom::algorithm::compute_intesection_v3(red, blue, ip1, ip2);
-        
-        if(spatial_relation == gde::geom::algorithm::DISJOINT)
-          continue;
-        
-        ipts->push_back(ip1);
-        
-        if(spatial_relation == gde::geom::algorithm::OVERLAP)
-          ipts->push_back(ip2);
-      }
-    }
+    gde::geom::algorithm::lazy_rb_intersection_core<gde::geom::algorithm::default_kernel,
+                                                    gde::geom::algorithm::bbox_test>(*red_segments, first, last, *blue_segments, sink);
   }
 };
 
@@ -82,16 +56,60 @@ gde::geom::algorithm::lazy_intersection_rb_thread(const std::vector<gde::geom::c
                                                   std::size_t nthreads,
                                                   std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
 {
-  intersetion_pts.resize(nthreads);
-  
-  std::vector<std::thread> threads;
-  
-  for(std::size_t i = 0; i != nthreads; ++i)
-  {
-    intersection_computer ic = { i, nthreads, &(intersetion_pts[i]), &red_segments, &blue_segments};
-    threads.push_back(std::thread(ic));
-  }
+  thread_pool pool(nthreads);
   
-  for(std::size_t i = 0; i != nthreads; ++i)
-    threads[i].join();
+  lazy_intersection_rb_thread(red_segments, blue_segments, pool, intersetion_pts);
+}
+
+void
+gde::geom::algorithm::lazy_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                  thread_pool& pool,
+                                                  std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
+{
+  lazy_rb_scan scan = { &red_segments, &blue_segments };
+
+  scan_per_thread(pool, red_segments.size(), scan, intersetion_pts);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::lazy_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                        std::size_t nthreads)
+{
+  thread_pool pool(nthreads);
+
+  return lazy_intersection_rb_count_thread(red_segments, blue_segments, pool);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::lazy_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                        thread_pool& pool)
+{
+  lazy_rb_scan scan = { &red_segments, &blue_segments };
+
+  return count_per_thread(pool, red_segments.size(), scan);
+}
+
+void
+gde::geom::algorithm::lazy_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                  std::size_t nthreads,
+                                                  std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  lazy_intersection_rb_thread(red_segments, blue_segments, pool, intersection_pts);
+}
+
+void
+gde::geom::algorithm::lazy_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                  thread_pool& pool,
+                                                  std::vector<gde::geom::core::point>& intersection_pts)
+{
+  lazy_rb_scan scan = { &red_segments, &blue_segments };
+
+  count_then_fill(pool, red_segments.size(), scan, intersection_pts);
 }
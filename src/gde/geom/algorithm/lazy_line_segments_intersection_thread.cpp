@@ -29,51 +29,22 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
-#include "line_segment_intersection.hpp"
+#include "count_then_fill.hpp"
+#include "intersection_core.hpp"
+#include "work_stealing_scheduler.hpp"
 
 // STL
 #include <algorithm>
-#include <thread>
 
-struct intersection_computer
+struct lazy_scan
 {
-  std::size_t thread_pos;
-  std::size_t num_threads;
-  std::vector<gde::geom::core::point>* ipts;
   const std::vector<gde::geom::core::line_segment>* segments;
-  
-  void operator()()
+
+  template<class Sink>
+  void operator()(std::size_t first, std::size_t last, Sink& sink) const
   {
-    gde::geom::core::point ip1;
-    gde::geom::core::point ip2;
-    
-    std::size_t nsegments = segments->size();
-    
-    for(std::size_t i = thread_pos; i < nsegments; i += num_threads)
-    {
-      const gde::geom::core::line_segment& red = (*segments)[i];
-      
-      for(std::size_t j = i; j < nsegments; ++j)
-      {
-        if(i == j)
-          continue;
-        
-        const gde::geom::core::line_segment& blue = (*segments)[j];
-        
-        if(!gde::geom::algorithm::do_bounding_box_intersects(red, blue))
-          continue;
-        
-        gde::geom::algorithm::segment_relation_type spatial_relation = gde::geom::algorithm::compute_intesection_v3(red, blue, ip1, ip2);
-        
-        if(spatial_relation == gde::geom::algorithm::DISJOINT)
-          continue;
-        
-        ipts->push_back(ip1);
-        
-        if(spatial_relation == gde::geom::algorithm::OVERLAP)
-          ipts->push_back(ip2);
-      }
-    }
+    gde::geom::algorithm::lazy_intersection_core<gde::geom::algorithm::default_kernel,
+                                                 gde::geom::algorithm::bbox_test>(*segments, first, last, sink);
   }
 };
 
@@ -82,16 +53,55 @@ gde::geom::algorithm::lazy_intersection_thread(const std::vector<gde::geom::core
                                                std::size_t nthreads,
                                                std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
 {
-  intersetion_pts.resize(nthreads);
-  
-  std::vector<std::thread> threads;
+  thread_pool pool(nthreads);
   
-  for(std::size_t i = 0; i != nthreads; ++i)
-  {
-    intersection_computer ic = { i, nthreads, &(intersetion_pts[i]), &segments};
-    threads.push_back(std::thread(ic));
-  }
-  
-  for(std::size_t i = 0; i != nthreads; ++i)
-    threads[i].join();
+  lazy_intersection_thread(segments, pool, intersetion_pts);
+}
+
+void
+gde::geom::algorithm::lazy_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                               thread_pool& pool,
+                                               std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
+{
+  lazy_scan scan = { &segments };
+
+  scan_per_thread(pool, segments.size(), scan, intersetion_pts);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::lazy_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                     std::size_t nthreads)
+{
+  thread_pool pool(nthreads);
+
+  return lazy_intersection_count_thread(segments, pool);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::lazy_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                     thread_pool& pool)
+{
+  lazy_scan scan = { &segments };
+
+  return count_per_thread(pool, segments.size(), scan);
+}
+
+void
+gde::geom::algorithm::lazy_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                               std::size_t nthreads,
+                                               std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  lazy_intersection_thread(segments, pool, intersection_pts);
+}
+
+void
+gde::geom::algorithm::lazy_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                               thread_pool& pool,
+                                               std::vector<gde::geom::core::point>& intersection_pts)
+{
+  lazy_scan scan = { &segments };
+
+  count_then_fill(pool, segments.size(), scan, intersection_pts);
 }
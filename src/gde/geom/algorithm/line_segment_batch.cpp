@@ -0,0 +1,254 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/line_segment_batch.cpp
+
+  \brief Intersection tests between one segment and a batch of segments stored as structure of arrays.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "line_segment_batch.hpp"
+
+// STL
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GDE_GEOM_ALGORITHM_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+// the same arithmetic as compute_intesection_v3, one pair at a time
+unsigned int
+compute_intersection_pairs_x4_scalar(const double* sx1, const double* sy1,
+                                     const double* sx2, const double* sy2,
+                                     const double* x1, const double* y1,
+                                     const double* x2, const double* y2,
+                                     gde::geom::core::point ips[4],
+                                     unsigned int& parallel)
+{
+  unsigned int hits = 0;
+
+  parallel = 0;
+
+  for(unsigned int k = 0; k != 4; ++k)
+  {
+    const double ax = sx2[k] - sx1[k];
+    const double ay = sy2[k] - sy1[k];
+
+    const double bx = x1[k] - x2[k];
+    const double by = y1[k] - y2[k];
+
+    const double den = ay * bx - ax * by;
+
+    if(den == 0.0)
+    {
+      parallel |= (1u << k);
+      continue;
+    }
+
+    const double cx = sx1[k] - x1[k];
+    const double cy = sy1[k] - y1[k];
+
+    const double num_alpha = by * cx - bx * cy;
+    const double num_beta = ax * cy - ay * cx;
+
+    const bool in_range = (den > 0.0) ? ((num_alpha >= 0.0) && (num_alpha <= den) && (num_beta >= 0.0) && (num_beta <= den))
+                                      : ((num_alpha <= 0.0) && (num_alpha >= den) && (num_beta <= 0.0) && (num_beta >= den));
+
+    if(!in_range)
+      continue;
+
+    const double alpha = num_alpha / den;
+
+    ips[k].x = sx1[k] + alpha * ax;
+    ips[k].y = sy1[k] + alpha * ay;
+
+    hits |= (1u << k);
+  }
+
+  return hits;
+}
+
+#ifdef GDE_GEOM_ALGORITHM_AVX2_KERNEL
+
+// segments s = (sx, sy) + (ax, ay) against 4 segments, 4 lanes at a time
+__attribute__((target("avx2")))
+inline unsigned int
+compute_intersection_x4_avx2(__m256d sx, __m256d sy, __m256d ax, __m256d ay,
+                             const double* x1, const double* y1,
+                             const double* x2, const double* y2,
+                             gde::geom::core::point ips[4],
+                             unsigned int& parallel)
+{
+  const __m256d bx1 = _mm256_loadu_pd(x1);
+  const __m256d by1 = _mm256_loadu_pd(y1);
+
+  const __m256d bx = _mm256_sub_pd(bx1, _mm256_loadu_pd(x2));
+  const __m256d by = _mm256_sub_pd(by1, _mm256_loadu_pd(y2));
+
+  const __m256d den = _mm256_sub_pd(_mm256_mul_pd(ay, bx), _mm256_mul_pd(ax, by));
+
+  const __m256d cx = _mm256_sub_pd(sx, bx1);
+  const __m256d cy = _mm256_sub_pd(sy, by1);
+
+  const __m256d num_alpha = _mm256_sub_pd(_mm256_mul_pd(by, cx), _mm256_mul_pd(bx, cy));
+  const __m256d num_beta = _mm256_sub_pd(_mm256_mul_pd(ax, cy), _mm256_mul_pd(ay, cx));
+
+  const __m256d zero = _mm256_setzero_pd();
+
+// 0 <= num <= den when den > 0 and den <= num <= 0 when den < 0
+  const __m256d in_pos = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(num_alpha, zero, _CMP_GE_OQ), _mm256_cmp_pd(num_alpha, den, _CMP_LE_OQ)),
+                                       _mm256_and_pd(_mm256_cmp_pd(num_beta, zero, _CMP_GE_OQ), _mm256_cmp_pd(num_beta, den, _CMP_LE_OQ)));
+
+  const __m256d in_neg = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(num_alpha, zero, _CMP_LE_OQ), _mm256_cmp_pd(num_alpha, den, _CMP_GE_OQ)),
+                                       _mm256_and_pd(_mm256_cmp_pd(num_beta, zero, _CMP_LE_OQ), _mm256_cmp_pd(num_beta, den, _CMP_GE_OQ)));
+
+  const __m256d hit = _mm256_or_pd(_mm256_and_pd(_mm256_cmp_pd(den, zero, _CMP_GT_OQ), in_pos),
+                                   _mm256_and_pd(_mm256_cmp_pd(den, zero, _CMP_LT_OQ), in_neg));
+
+  parallel = static_cast<unsigned int>(_mm256_movemask_pd(_mm256_cmp_pd(den, zero, _CMP_EQ_OQ)));
+
+  const unsigned int hits = static_cast<unsigned int>(_mm256_movemask_pd(hit));
+
+  if(hits == 0)
+    return 0;
+
+  const __m256d alpha = _mm256_div_pd(num_alpha, den);
+
+  double x[4];
+  double y[4];
+
+  _mm256_storeu_pd(x, _mm256_add_pd(sx, _mm256_mul_pd(alpha, ax)));
+  _mm256_storeu_pd(y, _mm256_add_pd(sy, _mm256_mul_pd(alpha, ay)));
+
+  for(unsigned int k = 0; k != 4; ++k)
+  {
+    ips[k].x = x[k];
+    ips[k].y = y[k];
+  }
+
+  return hits;
+}
+
+__attribute__((target("avx2")))
+unsigned int
+compute_intersection_x4_avx2(const gde::geom::core::line_segment& s,
+                             const double* x1, const double* y1,
+                             const double* x2, const double* y2,
+                             gde::geom::core::point ips[4],
+                             unsigned int& parallel)
+{
+  return compute_intersection_x4_avx2(_mm256_set1_pd(s.p1.x), _mm256_set1_pd(s.p1.y),
+                                      _mm256_set1_pd(s.p2.x - s.p1.x), _mm256_set1_pd(s.p2.y - s.p1.y),
+                                      x1, y1, x2, y2, ips, parallel);
+}
+
+__attribute__((target("avx2")))
+unsigned int
+compute_intersection_pairs_x4_avx2(const double* sx1, const double* sy1,
+                                   const double* sx2, const double* sy2,
+                                   const double* x1, const double* y1,
+                                   const double* x2, const double* y2,
+                                   gde::geom::core::point ips[4],
+                                   unsigned int& parallel)
+{
+  const __m256d sx = _mm256_loadu_pd(sx1);
+  const __m256d sy = _mm256_loadu_pd(sy1);
+
+  return compute_intersection_x4_avx2(sx, sy,
+                                      _mm256_sub_pd(_mm256_loadu_pd(sx2), sx), _mm256_sub_pd(_mm256_loadu_pd(sy2), sy),
+                                      x1, y1, x2, y2, ips, parallel);
+}
+
+bool
+has_avx2()
+{
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+
+  return avx2;
+}
+
+#endif // GDE_GEOM_ALGORITHM_AVX2_KERNEL
+
+void
+gde::geom::algorithm::build_line_segment_soa(const std::vector<gde::geom::core::line_segment>& segments,
+                                             line_segment_soa& soa)
+{
+  const std::size_t n = segments.size();
+
+  const std::size_t padded = (n + 3) & ~static_cast<std::size_t>(3);
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+
+  soa.nsegments = n;
+
+  soa.x1.assign(padded, nan);
+  soa.y1.assign(padded, nan);
+  soa.x2.assign(padded, nan);
+  soa.y2.assign(padded, nan);
+
+  for(std::size_t i = 0; i != n; ++i)
+  {
+    soa.x1[i] = segments[i].p1.x;
+    soa.y1[i] = segments[i].p1.y;
+    soa.x2[i] = segments[i].p2.x;
+    soa.y2[i] = segments[i].p2.y;
+  }
+}
+
+unsigned int
+gde::geom::algorithm::compute_intersection_x4(const gde::geom::core::line_segment& s,
+                                              const double* x1, const double* y1,
+                                              const double* x2, const double* y2,
+                                              gde::geom::core::point ips[4],
+                                              unsigned int& parallel)
+{
+#ifdef GDE_GEOM_ALGORITHM_AVX2_KERNEL
+  if(has_avx2())
+    return compute_intersection_x4_avx2(s, x1, y1, x2, y2, ips, parallel);
+#endif
+
+  const double sx1[4] = { s.p1.x, s.p1.x, s.p1.x, s.p1.x };
+  const double sy1[4] = { s.p1.y, s.p1.y, s.p1.y, s.p1.y };
+  const double sx2[4] = { s.p2.x, s.p2.x, s.p2.x, s.p2.x };
+  const double sy2[4] = { s.p2.y, s.p2.y, s.p2.y, s.p2.y };
+
+  return compute_intersection_pairs_x4_scalar(sx1, sy1, sx2, sy2, x1, y1, x2, y2, ips, parallel);
+}
+
+unsigned int
+gde::geom::algorithm::compute_intersection_pairs_x4(const double* sx1, const double* sy1,
+                                                    const double* sx2, const double* sy2,
+                                                    const double* x1, const double* y1,
+                                                    const double* x2, const double* y2,
+                                                    gde::geom::core::point ips[4],
+                                                    unsigned int& parallel)
+{
+#ifdef GDE_GEOM_ALGORITHM_AVX2_KERNEL
+  if(has_avx2())
+    return compute_intersection_pairs_x4_avx2(sx1, sy1, sx2, sy2, x1, y1, x2, y2, ips, parallel);
+#endif
+
+  return compute_intersection_pairs_x4_scalar(sx1, sy1, sx2, sy2, x1, y1, x2, y2, ips, parallel);
+}
@@ -0,0 +1,145 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/line_segment_batch.hpp
+
+  \brief Intersection tests between one segment and a batch of segments stored as structure of arrays.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_LINE_SEGMENT_BATCH_HPP__
+#define __GDE_GEOM_ALGORITHM_LINE_SEGMENT_BATCH_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+
+// STL
+#include <cstddef>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \struct line_segment_soa
+
+        \brief A set of segments stored as separate coordinate arrays (structure of arrays).
+
+        The arrays are padded with NaN up to a multiple of 4, so a batch kernel can always
+        read 4 segments: padding segments never intersect anything.
+       */
+      struct line_segment_soa
+      {
+        std::vector<double> x1;
+        std::vector<double> y1;
+        std::vector<double> x2;
+        std::vector<double> y2;
+        std::size_t nsegments;
+
+        std::size_t size() const { return nsegments; }
+      };
+
+      /*! \brief Copy the coordinates of a set of segments to a structure of arrays. */
+      void
+      build_line_segment_soa(const std::vector<gde::geom::core::line_segment>& segments,
+                             line_segment_soa& soa);
+
+      /*!
+        \brief Test a segment against 4 segments whose coordinates start at x1, y1, x2 and y2.
+
+        This is the same test as compute_intesection_v3 for segments that are not parallel.
+        Where AVX2 is available the 4 tests run in a single pass of vector instructions.
+
+        \param ips      The intersection point with each segment.
+        \param parallel Output mask: bit k is set if s is parallel (or collinear) to the k-th segment.
+                        These segments must be tested with compute_intesection_v3.
+
+        \return A mask where bit k is set if s crosses or touches the k-th segment.
+       */
+      unsigned int
+      compute_intersection_x4(const gde::geom::core::line_segment& s,
+                              const double* x1, const double* y1,
+                              const double* x2, const double* y2,
+                              gde::geom::core::point ips[4],
+                              unsigned int& parallel);
+
+      /*!
+        \brief Test 4 pairs of segments: the k-th segment of the first set against the k-th of the second set.
+
+        \see compute_intersection_x4
+       */
+      unsigned int
+      compute_intersection_pairs_x4(const double* sx1, const double* sy1,
+                                    const double* sx2, const double* sy2,
+                                    const double* x1, const double* y1,
+                                    const double* x2, const double* y2,
+                                    gde::geom::core::point ips[4],
+                                    unsigned int& parallel);
+
+      /*!
+        \struct line_segment_batch
+
+        \brief Up to 4 candidate pairs of segments waiting to be tested together.
+       */
+      struct line_segment_batch
+      {
+        double sx1[4];
+        double sy1[4];
+        double sx2[4];
+        double sy2[4];
+        double x1[4];
+        double y1[4];
+        double x2[4];
+        double y2[4];
+        const gde::geom::core::line_segment* first[4];
+        const gde::geom::core::line_segment* second[4];
+        std::size_t size;
+
+        line_segment_batch() : size(0) { }
+
+        bool full() const { return size == 4; }
+
+        void push_back(const gde::geom::core::line_segment& s, const gde::geom::core::line_segment& t)
+        {
+          sx1[size] = s.p1.x;
+          sy1[size] = s.p1.y;
+          sx2[size] = s.p2.x;
+          sy2[size] = s.p2.y;
+          x1[size] = t.p1.x;
+          y1[size] = t.p1.y;
+          x2[size] = t.p2.x;
+          y2[size] = t.p2.y;
+          first[size] = &s;
+          second[size] = &t;
+          ++size;
+        }
+      };
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_LINE_SEGMENT_BATCH_HPP__
@@ -31,8 +31,14 @@
 #define __GDE_GEOM_ALGORITHM_LINE_SEGMENT_INTERSECTION_HPP__
 
 // GDE
+#include "robust_predicates.hpp"
 #include "utils.hpp"
 
+// STL
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
 namespace gde
 {
   namespace geom
@@ -58,6 +64,43 @@ namespace gde
         TOUCH,    //!< Segments touches in one of their end-points.
         OVERLAP   //!< Segments overlap: their intersection is another segment.
       };
+
+      /*!
+        \struct intersection_pair
+
+        \brief An intersection point given by the pair of segments that produced it.
+
+        The parameters tell where the point is along each segment:
+        0 at the first end-point and 1 at the second one, as given in the input.
+       */
+      struct intersection_pair
+      {
+        std::uint32_t red_index;          //!< The index of the red segment (or the first one for a single set).
+        std::uint32_t blue_index;         //!< The index of the blue segment (or the second one for a single set).
+        segment_relation_type relation;   //!< The relation between the two segments.
+        double t_red;                     //!< The parameter of the point along the red segment.
+        double t_blue;                    //!< The parameter of the point along the blue segment.
+      };
+
+      /*!
+        \struct intersection_count
+
+        \brief The number of intersection points found by an algorithm for each type of relation.
+
+        An overlap gives two points: the end-points of the common part.
+       */
+      struct intersection_count
+      {
+        std::size_t relations[4];   //!< The number of points of each segment_relation_type: DISJOINT is always 0.
+
+        std::size_t total() const { return relations[CROSS] + relations[TOUCH] + relations[OVERLAP]; }
+
+        void add(const intersection_count& other)
+        {
+          for(std::size_t i = 0; i != 4; ++i)
+            relations[i] += other.relations[i];
+        }
+      };
       
       /*! \brief Test if two collinear segments intersects. */
       inline bool
@@ -79,6 +122,19 @@ namespace gde
         return false;
       }
 
+      /*!
+        \brief Compute the intersection of two collinear segments that are known to intersect.
+
+        \return TOUCH if they share a single end-point and OVERLAP otherwise.
+
+        \note It is kept out-of-line so that the inlined kernels stay small.
+       */
+      segment_relation_type
+      compute_collinear_intesection(const gde::geom::core::line_segment& s1,
+                                    const gde::geom::core::line_segment& s2,
+                                    gde::geom::core::point& first,
+                                    gde::geom::core::point& second);
+
       /*!
         \brief Test if both segments intersects.
 
@@ -121,11 +177,61 @@ namespace gde
 
         \warning Doesn't perform bounding box intersect test between segments.
        */
-      segment_relation_type
+      inline segment_relation_type
       compute_intesection_v1(const gde::geom::core::line_segment& s1,
                              const gde::geom::core::line_segment& s2,
                              gde::geom::core::point& first,
-                             gde::geom::core::point& second);
+                             gde::geom::core::point& second)
+      {
+        double a1 = s1.p2.y - s1.p1.y;
+        double b1 = s1.p1.x - s1.p2.x;
+        double c1 = (s1.p2.x * s1.p1.y) - (s1.p1.x * s1.p2.y);
+
+        double r3 = a1 * s2.p1.x + b1 * s2.p1.y + c1;
+        double r4 = a1 * s2.p2.x + b1 * s2.p2.y + c1;
+
+// if both points from segment s2 are to the sime side of line defined by segment s1,
+// we are sure s2 can not intersects s1
+        if((r3 != 0.0) && (r4 != 0.0) && same_signs(r3, r4))
+          return DISJOINT;
+
+// compute general line equation for segment s2
+        double a2 = s2.p2.y - s2.p1.y;
+        double b2 = s2.p1.x - s2.p2.x;
+        double c2 = (s2.p2.x * s2.p1.y) - (s2.p1.x * s2.p2.y);
+
+        double r1 = a2 * s1.p1.x + b2 * s1.p1.y + c2;
+        double r2 = a2 * s1.p2.x + b2 * s1.p2.y + c2;
+
+// if both points from segment s1 are to the sime side of line defined by segment s2,
+// we are sure s1 can not intersects s2
+        if((r1 != 0.0) && (r2 != 0.0) && same_signs(r1, r2))
+          return DISJOINT;
+
+// setting the denominator
+        double denom = a1 * b2 - a2 * c1;
+
+        if(denom == 0.0)  // are they collinear?
+        {
+          if(do_collinear_segments_intersects(s1, s2) == false)
+            return DISJOINT;
+// and we know they intersects: let's order the segments and find out intersection(s)
+          return compute_collinear_intesection(s1, s2, first, second);
+        }
+
+// ok: they are not collinear!
+        double offset = denom < 0.0 ? - denom / 2.0 : denom / 2.0;
+
+// setting the numerator
+// compute intersection point
+        double num_alpha = b1 * c2 - b2 * c1;
+        first.x = (num_alpha < 0.0 ? num_alpha - offset : num_alpha + offset) / denom;
+
+        double num_beta = a2 * c1 - a1 * c2;
+        first.y = (num_beta < 0.0 ? num_beta - offset : num_beta + offset) / denom;
+
+        return CROSS;
+      }
       
       /*!
        \brief Compute the intersection point between two line segments, if one exists.
@@ -136,11 +242,56 @@ namespace gde
 
        \warning Doesn't perform  bounding box intersect test between segments.
        */
-      segment_relation_type
+      inline segment_relation_type
       compute_intesection_v2(const gde::geom::core::line_segment& s1,
                              const gde::geom::core::line_segment& s2,
                              gde::geom::core::point& first,
-                             gde::geom::core::point& second);
+                             gde::geom::core::point& second)
+      {
+        double a = (s2.p1.x - s1.p1.x) * (s1.p2.y - s1.p1.y) - (s2.p1.y - s1.p1.y) * (s1.p2.x - s1.p1.x);
+        double b = (s2.p2.x - s1.p1.x) * (s1.p2.y - s1.p1.y) - (s2.p2.y - s1.p1.y) * (s1.p2.x - s1.p1.x);
+
+// if the endpoints of the second segment lie on the opposite
+        if((a != 0.0) && (b != 0.0) && same_signs(a, b))
+          return DISJOINT;
+
+        double c = (s1.p1.x - s2.p1.x) * (s2.p2.y - s2.p1.y) - (s1.p1.y - s2.p1.y) * (s2.p2.x - s2.p1.x);
+        double d = (s1.p2.x - s2.p1.x) * (s2.p2.y - s2.p1.y) - (s1.p2.y - s2.p1.y) * (s2.p2.x - s2.p1.x);
+
+// if the endpoints of the first segment lie on the opposite
+        if((c != 0.0) && (d != 0.0) && same_signs(c, d))
+          return DISJOINT;
+
+        double det = a - b;
+
+        if(det == 0.0)  // are the segments collinear?
+        {
+          if(do_collinear_segments_intersects(s1, s2) == false)
+            return DISJOINT;
+
+// and we know they intersects: let's order the segments and find out intersection(s)
+          return compute_collinear_intesection(s1, s2, first, second);
+        }
+
+// ok: they are not collinear!
+
+        double tdet = -c;
+
+// the denominator of the parameter must be positive
+        if(det < 0.0)
+        {
+          det = -det;
+          tdet = -tdet;
+        }
+
+// compute intersection point
+        double alpha = tdet / det;
+
+        first.x = s1.p1.x + alpha * (s1.p2.x - s1.p1.x);
+        first.y = s1.p1.y + alpha * (s1.p2.y - s1.p1.y);
+
+        return CROSS;
+      }
       
       
       /*!
@@ -152,11 +303,290 @@ namespace gde
 
         \warning Doesn't perform  bounding box intersect test between segments.
        */
-      segment_relation_type
+      inline segment_relation_type
       compute_intesection_v3(const gde::geom::core::line_segment& s1,
                              const gde::geom::core::line_segment& s2,
                              gde::geom::core::point& first,
-                             gde::geom::core::point& second);
+                             gde::geom::core::point& second)
+      {
+        double ax = s1.p2.x - s1.p1.x;
+        double ay = s1.p2.y - s1.p1.y;
+
+        double bx = s2.p1.x - s2.p2.x;
+        double by = s2.p1.y - s2.p2.y;
+
+        double den = ay * bx - ax * by;
+
+        if(den == 0.0) // are they collinear?
+        {
+// or just parallel?
+          if((orientation(s1.p1, s1.p2, s2.p1) != 0.0) || (orientation(s2.p1, s2.p2, s1.p1) != 0.0))
+            return DISJOINT;
+
+// yes!
+          if(do_collinear_segments_intersects(s1, s2) == false)
+            return DISJOINT;
+
+// and we know they intersects: let's order the segments and find out intersection(s)
+          return compute_collinear_intesection(s1, s2, first, second);
+        }
+
+// they are not collinear, let's see if they intersects
+        double cx = s1.p1.x - s2.p1.x;
+        double cy = s1.p1.y - s2.p1.y;
+
+// is alpha in the range [0..1]
+        double num_alpha = by * cx - bx * cy;
+
+        if(den > 0.0)
+        {
+// is alpha before the range [0..1] or after it?
+          if((num_alpha < 0.0) || (num_alpha > den))
+            return DISJOINT;
+        }
+        else // den < 0
+        {
+// is alpha before the range [0..1] or after it?
+          if((num_alpha > 0.0) || (num_alpha < den))
+            return DISJOINT;
+        }
+
+// is beta in the range [0..1]
+        double num_beta = ax * cy - ay * cx;
+
+        if(den > 0.0)
+        {
+// is beta before the range [0..1] or after it?
+          if((num_beta < 0.0) || (num_beta > den))
+            return DISJOINT;
+        }
+        else // den < 0
+        {
+          // is beta before the range [0..1] or after it?
+          if((num_beta > 0.0) || (num_beta < den))
+            return DISJOINT;
+        }
+
+// compute intersection point
+        double alpha = num_alpha / den;
+
+        first.x = s1.p1.x + alpha * (s1.p2.x - s1.p1.x);
+        first.y = s1.p1.y + alpha * (s1.p2.y - s1.p1.y);
+
+        return CROSS;
+      }
+
+      /*!
+        \brief Compute the intersection point between two line segments, if one exists,
+               without branching on the signs of the terms.
+
+        It uses the same terms as compute_intesection_v3, but the range tests are done
+        on terms with the sign of the denominator removed, and combined without
+        short-circuit. The point is always computed, so the only branch left is
+        the rare case of parallel segments.
+
+        \return The type of intersection between line segments: the same as compute_intesection_v3.
+
+        \note first is also written when segments are disjoint.
+
+        \warning Doesn't perform bounding box intersect test between segments.
+       */
+      inline segment_relation_type
+      compute_intesection_branchless(const gde::geom::core::line_segment& s1,
+                                     const gde::geom::core::line_segment& s2,
+                                     gde::geom::core::point& first,
+                                     gde::geom::core::point& second)
+      {
+        double ax = s1.p2.x - s1.p1.x;
+        double ay = s1.p2.y - s1.p1.y;
+
+        double bx = s2.p1.x - s2.p2.x;
+        double by = s2.p1.y - s2.p2.y;
+
+        double den = ay * bx - ax * by;
+
+// parallel segments are rare: let the general kernel handle them
+        if(den == 0.0)
+          return compute_intesection_v3(s1, s2, first, second);
+
+        double cx = s1.p1.x - s2.p1.x;
+        double cy = s1.p1.y - s2.p1.y;
+
+        double num_alpha = by * cx - bx * cy;
+        double num_beta = ax * cy - ay * cx;
+
+// remove the sign of den: alpha and beta are in [0..1] if both numerators are in [0..|den|]
+        double abs_den = std::fabs(den);
+        double sign = std::copysign(1.0, den);
+
+        double na = num_alpha * sign;
+        double nb = num_beta * sign;
+
+        int inside = (na >= 0.0) & (na <= abs_den) & (nb >= 0.0) & (nb <= abs_den);
+
+// compute intersection point
+        double alpha = num_alpha / den;
+
+        first.x = s1.p1.x + alpha * ax;
+        first.y = s1.p1.y + alpha * ay;
+
+// CROSS is 1 and DISJOINT is 0
+        return static_cast<segment_relation_type>(inside * CROSS);
+      }
+
+      /*!
+        \brief Test if both segments intersects, with exact orientation tests.
+
+        \note It uses the adaptive predicate orient2d: it is correct for any input,
+              including end-points that are on the other segment or nearly so.
+       */
+      inline bool
+      do_intersects_robust(const gde::geom::core::line_segment& s1,
+                           const gde::geom::core::line_segment& s2)
+      {
+        double o1 = orient2d(s1.p1, s1.p2, s2.p1);
+        double o2 = orient2d(s1.p1, s1.p2, s2.p2);
+
+// are both end-points of s2 on the same side of s1?
+        if(same_signs(o1, o2))
+          return false;
+
+        double o3 = orient2d(s2.p1, s2.p2, s1.p1);
+        double o4 = orient2d(s2.p1, s2.p2, s1.p2);
+
+// are both end-points of s1 on the same side of s2?
+        if(same_signs(o3, o4))
+          return false;
+
+// are they collinear?
+        if((o1 == 0.0) && (o2 == 0.0))
+          return do_collinear_segments_intersects(s1, s2);
+
+        return true;
+      }
+
+      /*!
+        \brief Compute the intersection point between two line segments, if one exists,
+               with exact orientation tests.
+
+        The relation is decided only by the signs of orient2d, so it is always correct:
+        when an end-point lies on the other segment the relation is TOUCH and this end-point
+        is the intersection point. For a proper crossing the point is interpolated
+        from the orientation values, so it always lies on s1 between its end-points.
+
+        \return The type of intersection between line segments.
+
+        \note Intersections that compute_intesection_v3 reports as CROSS at an end-point are TOUCH here.
+
+        \warning Doesn't perform bounding box intersect test between segments.
+       */
+      inline segment_relation_type
+      compute_intesection_robust(const gde::geom::core::line_segment& s1,
+                                 const gde::geom::core::line_segment& s2,
+                                 gde::geom::core::point& first,
+                                 gde::geom::core::point& second)
+      {
+        double o1 = orient2d(s1.p1, s1.p2, s2.p1);
+        double o2 = orient2d(s1.p1, s1.p2, s2.p2);
+
+// are both end-points of s2 on the same side of s1?
+        if(same_signs(o1, o2))
+          return DISJOINT;
+
+// are they collinear?
+        if((o1 == 0.0) && (o2 == 0.0))
+        {
+          if(do_collinear_segments_intersects(s1, s2) == false)
+            return DISJOINT;
+
+          return compute_collinear_intesection(s1, s2, first, second);
+        }
+
+        double o3 = orient2d(s2.p1, s2.p2, s1.p1);
+        double o4 = orient2d(s2.p1, s2.p2, s1.p2);
+
+// are both end-points of s1 on the same side of s2?
+        if(same_signs(o3, o4))
+          return DISJOINT;
+
+// does an end-point touch the other segment?
+        if(o1 == 0.0)
+        {
+          first = s2.p1;
+          return TOUCH;
+        }
+
+        if(o2 == 0.0)
+        {
+          first = s2.p2;
+          return TOUCH;
+        }
+
+        if(o3 == 0.0)
+        {
+          first = s1.p1;
+          return TOUCH;
+        }
+
+        if(o4 == 0.0)
+        {
+          first = s1.p2;
+          return TOUCH;
+        }
+
+// o3 and o4 have opposite signs: alpha is in the range [0..1]
+        double alpha = o3 / (o3 - o4);
+
+        first.x = s1.p1.x + alpha * (s1.p2.x - s1.p1.x);
+        first.y = s1.p1.y + alpha * (s1.p2.y - s1.p1.y);
+
+        return CROSS;
+      }
+
+      /*!
+        \brief The intersection kernel used by every algorithm on sets of segments, and by their count variants.
+
+        It is compute_intesection_v3, compute_intesection_robust when
+        GDE_GEOM_ALGORITHM_ROBUST_KERNEL is defined at compile time
+        or compute_intesection_branchless when GDE_GEOM_ALGORITHM_BRANCHLESS_KERNEL is defined.
+        Only compute_intesection_v3 has a 4-wide version: the batched paths test their pairs
+        one at a time with the other kernels (see pair_batch).
+       */
+      inline segment_relation_type
+      compute_intesection(const gde::geom::core::line_segment& s1,
+                          const gde::geom::core::line_segment& s2,
+                          gde::geom::core::point& first,
+                          gde::geom::core::point& second)
+      {
+#if defined(GDE_GEOM_ALGORITHM_ROBUST_KERNEL)
+        return compute_intesection_robust(s1, s2, first, second);
+#elif defined(GDE_GEOM_ALGORITHM_BRANCHLESS_KERNEL)
+        return compute_intesection_branchless(s1, s2, first, second);
+#else
+        return compute_intesection_v3(s1, s2, first, second);
+#endif
+      }
+
+      /*!
+        \brief The parameter of a point on a segment: 0 at p1 and 1 at p2.
+
+        The point is projected on the line of the segment, so a point computed with
+        some rounding error gets the parameter of the closest point on this line.
+       */
+      inline double
+      segment_parameter(const gde::geom::core::line_segment& s,
+                        const gde::geom::core::point& p)
+      {
+        const double dx = s.p2.x - s.p1.x;
+        const double dy = s.p2.y - s.p1.y;
+
+        const double len2 = (dx * dx) + (dy * dy);
+
+        if(len2 == 0.0)
+          return 0.0;
+
+        return (((p.x - s.p1.x) * dx) + ((p.y - s.p1.y) * dy)) / len2;
+      }
 
     } // end namespace algorithm
   }   // end namespace geom
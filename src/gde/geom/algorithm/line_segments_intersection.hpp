@@ -23,6 +23,13 @@
 
   \brief Algorithms for computing intersection points between a set of line segments.
 
+  \note Except for the lazy and sweep-line algorithms, the segments are indexed with 32-bit integers:
+        the input sets can hold up to 2^32 - 1 segments together (see max_indexed_segments)
+        and larger sets throw std::length_error.
+
+  \note The threaded algorithms that take a number of threads run on a thread_pool of that size:
+        nthreads = 0 works as nthreads = 1, the calling thread doing all the work.
+
   \author Joao Vitor Chagas
   \author Gilberto Ribeiro de Queiroz
  */
@@ -32,8 +39,16 @@
 
 // GDE
 #include "../core/geometric_primitives.hpp"
+#include "intersection_selector.hpp"
+#include "intersection_visitor.hpp"
+#include "line_segment_intersection.hpp"
+#include "packed_rtree.hpp"
+#include "quadtree_index.hpp"
+#include "resolution_planner.hpp"
+#include "thread_pool.hpp"
 
 // STL
+#include <cstdint>
 #include <vector>
 
 namespace gde
@@ -83,6 +98,12 @@ namespace gde
                                std::size_t nthreads,
                                std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
 
+      /*! \brief The same as above but running on the threads of a given pool, with one output vector for each worker. */
+      void
+      lazy_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                               thread_pool& pool,
+                               std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
+
       /*!
         \brief Given two set of segments, called red and blue sets, compute the intersection points
                between red and blue segments.
@@ -102,6 +123,13 @@ namespace gde
                                   std::size_t nthreads,
                                   std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
 
+      /*! \brief The same as above but running on the threads of a given pool, with one output vector for each worker. */
+      void
+      lazy_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                  thread_pool& pool,
+                                  std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
+
       /*!
         \brief Given a set of segments compute the intersection points between each pair.
 
@@ -123,6 +151,25 @@ namespace gde
       std::vector<gde::geom::core::point>
       x_order_intersection(const std::vector<gde::geom::core::line_segment>& segments);
 
+      /*!
+        \brief Given a set of segments compute the intersection points between each pair.
+
+        This is the Bentley-Ottmann plane-sweep algorithm: an event queue
+        with the segments end-points and the crossing points found so far,
+        and a balanced tree with the segments that intersect the sweep-line.
+        Only segments that become adjacent in the sweep-line or that meet at
+        an event point are tested for intersection.
+
+        It reports the same points as x_order_intersection, one (or two, for
+        overlapping segments) for each pair of intersecting segments,
+        although not in the same order.
+
+        \note This algorithm runs in O((n + k) log n), where n is the number of input segments
+              and k the number of intersecting pairs.
+       */
+      std::vector<gde::geom::core::point>
+      bentley_ottmann_intersection(const std::vector<gde::geom::core::line_segment>& segments);
+
       /*!
         \brief Given two set of segments, called red and blue sets, compute the intersection points
                between red and blue segments.
@@ -144,10 +191,49 @@ namespace gde
       x_order_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
                               const std::vector<gde::geom::core::line_segment>& blue_segments);
       
+      /*!
+        \brief The x-order algorithm for red and blue segments over a subset of segments given by their indexes.
+
+        \param segments The red segments followed by the blue ones, all of them left-right ordered.
+        \param nred     The number of red segments: indexes below nred refer to red segments.
+        \param first    The first index of the subset.
+        \param last     One past the last index of the subset.
+        \param ipts     The intersection points found are appended to this list.
+
+        \pre The indexes must be sorted from left to right by their segments (see line_segment_id_xy_cmp).
+       */
+      void
+      x_order_intersection_rb(const std::vector<gde::geom::core::line_segment>& segments,
+                              std::size_t nred,
+                              const std::uint32_t* first, const std::uint32_t* last,
+                              std::vector<gde::geom::core::point>& ipts);
+
       std::vector<gde::geom::core::point>
       x_order_intersection_rb2(const std::vector<gde::geom::core::line_segment>& red_segments,
                                const std::vector<gde::geom::core::line_segment>& blue_segments);
 
+      /*!
+        \brief Given two set of segments, called red and blue sets, compute the intersection points
+               between red and blue segments.
+
+        This algorithm assumes that red segments don't cross each other and
+        that blue segments don't cross each other, as in the overlay of two
+        planar maps. Segments of the same color may touch at their end-points.
+
+        It is a lazy plane-sweep: the red and the blue segments are kept in
+        two balanced trees and the mixed order of all segments is only
+        updated around each end-point. Each red and blue pair swapped in
+        this update is an intersection, so no useless pair is ever tested.
+
+        It reports the same points as x_order_intersection_rb, although not in the same order.
+
+        \note This algorithm runs in O(n log n + k), where n is the number of segments
+              in both sets and k the number of intersecting pairs.
+       */
+      std::vector<gde::geom::core::point>
+      trapezoid_sweep_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                      const std::vector<gde::geom::core::line_segment>& blue_segments);
+
       /*!
         \brief Given a set of segments compute the intersection points between each pair.
 
@@ -171,6 +257,12 @@ namespace gde
       x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
                                   std::size_t nthreads,
                                   std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
+
+      /*! \brief The same as above but running on the threads of a given pool, with one output vector for each worker. */
+      void
+      x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                  thread_pool& pool,
+                                  std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
       
       /*!
         \brief Given two set of segments, called red and blue sets, compute the intersection points
@@ -193,8 +285,24 @@ namespace gde
                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
                                      std::size_t nthreads,
                                      std::vector<std::vector<gde::geom::core::point> >& intersection_pts);
+
+      /*! \brief The same as above but running on the threads of a given pool, with one output vector for each worker. */
+      void
+      x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                     thread_pool& pool,
+                                     std::vector<std::vector<gde::geom::core::point> >& intersection_pts);
       
-      
+      /*!
+        \brief Given a set of segments red and blue compute the intersection points between each pair.
+
+        The blue segments are indexed in a uniform grid with cells of size dx by dy covering
+        the given extent, and each red segment is tested against the blue segments of its cells.
+
+        Pass auto_resolution as dx or dy to let plan_fixed_grid_resolution choose it.
+
+        \pre All blue segments must be inside the extent: red segments may go beyond it.
+       */
       std::vector<gde::geom::core::point>
       fixed_grid_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
@@ -208,6 +316,14 @@ namespace gde
                                         double xmax,double ymin, double ymax,
                                         std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
 
+      /*! \brief The same as above but running on the threads of a given pool, with one output vector for each worker. */
+      void
+      fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        thread_pool& pool, double dx, double dy, double xmin,
+                                        double xmax,double ymin, double ymax,
+                                        std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
+
 
       /*!
         \brief Given a set of segments compute the intersection points between each pair.
@@ -229,6 +345,8 @@ namespace gde
         using an x -order algorithm to find the intersection points
         between segments of each block.
 
+        Pass auto_resolution as dy to let plan_tile_height choose it.
+
         \note ????.
        */
 
@@ -243,6 +361,557 @@ namespace gde
                                     std::size_t nthreads,double dy, double ymin, double ymax,
                                     std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
 
+      /*! \brief The same as above but running on the threads of a given pool, with one output vector for each worker. */
+      void
+      tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    thread_pool& pool, double dy, double ymin, double ymax,
+                                    std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
+
+      /*!
+        \brief Given a set of segments red and blue compute the intersection points between each pair.
+
+        This is the two-dimensional version of tiling_intersection_rb: segments are
+        separated into tiles of size dx by dy covering the given extent, and an
+        x-order algorithm finds the intersection points in each tile.
+
+        A point found in a tile is only reported if it lies inside the tile, so the points
+        of segments that share many tiles are reported once.
+
+        Pass auto_resolution as dx or dy to let plan_tiling_resolution choose it.
+
+        \pre All segments must be inside the extent.
+       */
+      std::vector<gde::geom::core::point>
+      tiling_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                             double dx, double dy, double xmin, double xmax,
+                             double ymin, double ymax);
+
+      /*!
+        \brief The two-dimensional version of tiling_intersection_rb_thread: tiles of size
+               dx by dy are shared among the given number of threads.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    std::size_t nthreads,
+                                    double dx, double dy, double xmin, double xmax,
+                                    double ymin, double ymax,
+                                    std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
+
+      /*! \brief The same as above but running on the threads of a given pool, with one output vector for each worker. */
+      void
+      tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    thread_pool& pool,
+                                    double dx, double dy, double xmin, double xmax,
+                                    double ymin, double ymax,
+                                    std::vector<std::vector<gde::geom::core::point> >& intersetion_pts);
+
+      /*!
+        \brief Given a set of segments red and blue compute the intersection points between each pair.
+
+        Both sets are indexed in packed R-trees built in Hilbert order (see build_packed_rtree).
+        The red segments are queried in batches: each leaf node of the red tree walks the blue
+        tree once for all of its segments.
+
+        Unlike the grid and tiling algorithms there is no cell size to choose: a segment has
+        a single entry whatever its length, so sets that mix very short and very long segments
+        or whose density varies a lot don't replicate entries.
+       */
+      std::vector<gde::geom::core::point>
+      rtree_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                            std::size_t node_capacity = rtree_node_capacity);
+
+      /*!
+        \brief The same as rtree_intersection_rb using a given number of threads: the trees are built in parallel
+               and the leaf nodes of the red tree are shared among the threads.
+
+        The points are written to one contiguous vector, as in the other threaded algorithms (see count_then_fill).
+       */
+      void
+      rtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                   std::size_t nthreads, std::size_t node_capacity,
+                                   std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      rtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                   thread_pool& pool, std::size_t node_capacity,
+                                   std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*!
+        \brief Given a set of segments red and blue compute the intersection points between each pair.
+
+        Both sets are indexed in the same adaptive quadtree (see build_quadtree_index):
+        space is split in quadrants until each leaf holds at most leaf_capacity segments,
+        so dense regions get small leaves and sparse ones large leaves. Each leaf is then
+        scanned from left to right as in x_order_intersection_rb.
+
+        A point found in a leaf is reported only if it lies inside that leaf, the same rule
+        the tiling algorithms use for the cells of their grid.
+       */
+      std::vector<gde::geom::core::point>
+      quadtree_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                               const std::vector<gde::geom::core::line_segment>& blue_segments,
+                               std::size_t leaf_capacity = quadtree_leaf_capacity);
+
+      /*!
+        \brief The same as quadtree_intersection_rb using a given number of threads: the subtrees
+               are built in parallel and each leaf is a task scanned by any of the threads.
+
+        The points are written to one contiguous vector, as in the other threaded algorithms (see count_then_fill).
+       */
+      void
+      quadtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                      std::size_t nthreads, std::size_t leaf_capacity,
+                                      std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      quadtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                      thread_pool& pool, std::size_t leaf_capacity,
+                                      std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*!
+        \brief Given a set of segments red and blue compute the intersection points between each pair.
+
+        Both sets are indexed in multi-level grids whose finest cells are of size dx by dy
+        (see build_multilevel_grid_index): each segment is kept only in the level whose cells
+        match its size, so it has at most 4 entries, where fixed_grid_intersection_rb copies a long
+        segment to every small cell it crosses. Each pair of segments is tested from the shorter one,
+        which visits the cells it crosses on the coarser levels of the other set: at most 4 on each.
+
+        Pass auto_resolution as dx or dy to let plan_fixed_grid_resolution choose the finest cells.
+
+        \pre All segments must be inside the extent.
+       */
+      std::vector<gde::geom::core::point>
+      multilevel_grid_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                      double dx, double dy, double xmin, double xmax,
+                                      double ymin, double ymax);
+
+      /*!
+        \brief The same as multilevel_grid_intersection_rb using a given number of threads: the queries of the segments are shared among them.
+
+        The points are written to one contiguous vector, as in the other threaded algorithms (see count_then_fill).
+       */
+      void
+      multilevel_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                             std::size_t nthreads, double dx, double dy, double xmin,
+                                             double xmax, double ymin, double ymax,
+                                             std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      multilevel_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                             thread_pool& pool, double dx, double dy, double xmin,
+                                             double xmax, double ymin, double ymax,
+                                             std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*!
+        \brief The same as lazy_intersection but it reports the pair of segments of each intersection point.
+
+        Each record has the indexes of the two segments, the lowest one first, their relation
+        and the parameters of the point along each segment. An overlap gives two records,
+        one for each end-point of the common part.
+       */
+      std::vector<intersection_pair>
+      lazy_intersection_pairs(const std::vector<gde::geom::core::line_segment>& segments);
+
+      /*! \brief The same as lazy_intersection_rb but it reports the red and blue segments of each intersection point. */
+      std::vector<intersection_pair>
+      lazy_intersection_rb_pairs(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                 const std::vector<gde::geom::core::line_segment>& blue_segments);
+
+      /*!
+        \brief The same as x_order_intersection but it reports the pair of segments of each intersection point.
+
+        The indexes and the parameters refer to the input segments,
+        not to the left-right ordered copies scanned by the algorithm.
+       */
+      std::vector<intersection_pair>
+      x_order_intersection_pairs(const std::vector<gde::geom::core::line_segment>& segments);
+
+      /*! \brief The same as x_order_intersection_rb but it reports the red and blue segments of each intersection point. */
+      std::vector<intersection_pair>
+      x_order_intersection_rb_pairs(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments);
+
+      /*! \brief The same as fixed_grid_intersection_rb but it reports the red and blue segments of each intersection point. */
+      std::vector<intersection_pair>
+      fixed_grid_intersection_rb_pairs(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                       const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                       double dx, double dy, double xmin, double xmax,
+                                       double ymin, double ymax);
+
+      /*!
+        \brief The same as lazy_intersection but it only counts the intersection points of each type of relation.
+
+        The count functions never write an intersection point: the threaded ones keep
+        a counter for each range of work and sum them at the end.
+        All of them classify the relations with the kernel of compute_intesection.
+       */
+      intersection_count
+      lazy_intersection_count(const std::vector<gde::geom::core::line_segment>& segments);
+
+      intersection_count
+      lazy_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                     std::size_t nthreads);
+
+      intersection_count
+      lazy_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                     thread_pool& pool);
+
+      /*! \brief The same as lazy_intersection_rb but it only counts the intersection points of each type of relation. */
+      intersection_count
+      lazy_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                 const std::vector<gde::geom::core::line_segment>& blue_segments);
+
+      intersection_count
+      lazy_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        std::size_t nthreads);
+
+      intersection_count
+      lazy_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        thread_pool& pool);
+
+      /*! \brief The same as x_order_intersection but it only counts the intersection points of each type of relation. */
+      intersection_count
+      x_order_intersection_count(const std::vector<gde::geom::core::line_segment>& segments);
+
+      intersection_count
+      x_order_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                        std::size_t nthreads);
+
+      intersection_count
+      x_order_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                        thread_pool& pool);
+
+      /*!
+        \brief The same as bentley_ottmann_intersection but it only counts the intersection points of each type of relation.
+
+        The sweep is serial: there is no threaded version.
+       */
+      intersection_count
+      bentley_ottmann_intersection_count(const std::vector<gde::geom::core::line_segment>& segments);
+
+      /*! \brief The same as x_order_intersection_rb but it only counts the intersection points of each type of relation. */
+      intersection_count
+      x_order_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments);
+
+      intersection_count
+      x_order_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                           const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                           std::size_t nthreads);
+
+      intersection_count
+      x_order_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                           const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                           thread_pool& pool);
+
+      /*!
+        \brief The same as trapezoid_sweep_intersection_rb but it only counts the intersection points of each type of relation.
+
+        The sweep is serial: there is no threaded version.
+       */
+      intersection_count
+      trapezoid_sweep_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                            const std::vector<gde::geom::core::line_segment>& blue_segments);
+
+      /*! \brief The same as fixed_grid_intersection_rb but it only counts the intersection points of each type of relation. */
+      intersection_count
+      fixed_grid_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                       const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                       double dx, double dy, double xmin, double xmax,
+                                       double ymin, double ymax);
+
+      intersection_count
+      fixed_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                              const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                              std::size_t nthreads, double dx, double dy, double xmin,
+                                              double xmax, double ymin, double ymax);
+
+      intersection_count
+      fixed_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                              const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                              thread_pool& pool, double dx, double dy, double xmin,
+                                              double xmax, double ymin, double ymax);
+
+      /*! \brief The same as tiling_intersection_rb but it only counts the intersection points of each type of relation. */
+      intersection_count
+      tiling_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                   double dy, double ymin, double ymax);
+
+      intersection_count
+      tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                          std::size_t nthreads, double dy, double ymin, double ymax);
+
+      intersection_count
+      tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                          thread_pool& pool, double dy, double ymin, double ymax);
+
+      /*!
+        \brief The same as the two-dimensional tiling_intersection_rb but it only counts the intersection points of each type of relation.
+
+        \pre All segments must be inside the extent.
+       */
+      intersection_count
+      tiling_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                   double dx, double dy, double xmin, double xmax,
+                                   double ymin, double ymax);
+
+      intersection_count
+      tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                          std::size_t nthreads,
+                                          double dx, double dy, double xmin, double xmax,
+                                          double ymin, double ymax);
+
+      intersection_count
+      tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                          thread_pool& pool,
+                                          double dx, double dy, double xmin, double xmax,
+                                          double ymin, double ymax);
+
+      /*! \brief The same as rtree_intersection_rb but it only counts the intersection points of each type of relation. */
+      intersection_count
+      rtree_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                  std::size_t node_capacity = rtree_node_capacity);
+
+      intersection_count
+      rtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                         const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                         std::size_t nthreads, std::size_t node_capacity);
+
+      intersection_count
+      rtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                         const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                         thread_pool& pool, std::size_t node_capacity);
+
+      /*! \brief The same as quadtree_intersection_rb but it only counts the intersection points of each type of relation. */
+      intersection_count
+      quadtree_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                     std::size_t leaf_capacity = quadtree_leaf_capacity);
+
+      intersection_count
+      quadtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                            std::size_t nthreads, std::size_t leaf_capacity);
+
+      intersection_count
+      quadtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                            thread_pool& pool, std::size_t leaf_capacity);
+
+      /*! \brief The same as multilevel_grid_intersection_rb but it only counts the intersection points of each type of relation. */
+      intersection_count
+      multilevel_grid_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                            double dx, double dy, double xmin, double xmax,
+                                            double ymin, double ymax);
+
+      intersection_count
+      multilevel_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                   std::size_t nthreads, double dx, double dy, double xmin,
+                                                   double xmax, double ymin, double ymax);
+
+      intersection_count
+      multilevel_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                   thread_pool& pool, double dx, double dy, double xmin,
+                                                   double xmax, double ymin, double ymax);
+
+      /*!
+        \brief The same as x_order_intersection but each point is passed to a visitor instead of being kept.
+
+        The visitor receives the indexes of the two input segments, the lowest one first.
+       */
+      void
+      x_order_intersection(const std::vector<gde::geom::core::line_segment>& segments,
+                           intersection_visitor& visitor);
+
+      /*! \brief The same as above running on the given number of threads: the visitor is called from all of them. */
+      void
+      x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                  std::size_t nthreads,
+                                  intersection_visitor& visitor);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                  thread_pool& pool,
+                                  intersection_visitor& visitor);
+
+      /*! \brief The same as x_order_intersection_rb but each point is passed to a visitor instead of being kept. */
+      void
+      x_order_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                              const std::vector<gde::geom::core::line_segment>& blue_segments,
+                              intersection_visitor& visitor);
+
+      /*! \brief The same as above running on the given number of threads: the visitor is called from all of them. */
+      void
+      x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                     std::size_t nthreads,
+                                     intersection_visitor& visitor);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                     thread_pool& pool,
+                                     intersection_visitor& visitor);
+
+      /*! \brief The same as fixed_grid_intersection_rb but each point is passed to a visitor instead of being kept. */
+      void
+      fixed_grid_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                 const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                 double dx, double dy, double xmin, double xmax,
+                                 double ymin, double ymax,
+                                 intersection_visitor& visitor);
+
+      /*! \brief The same as above running on the given number of threads: the visitor is called from all of them. */
+      void
+      fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        std::size_t nthreads, double dx, double dy, double xmin,
+                                        double xmax, double ymin, double ymax,
+                                        intersection_visitor& visitor);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        thread_pool& pool, double dx, double dy, double xmin,
+                                        double xmax, double ymin, double ymax,
+                                        intersection_visitor& visitor);
+
+      /*!
+        \brief The same as lazy_intersection_thread but the points are written to one contiguous vector.
+
+        The threaded algorithms with a single output vector run in two passes (see count_then_fill):
+        they count the points of fixed units of work, then each unit writes its points at its
+        own offset. The output doesn't need to be merged and its order doesn't depend on the number of threads.
+       */
+      void
+      lazy_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                               std::size_t nthreads,
+                               std::vector<gde::geom::core::point>& intersection_pts);
+
+      void
+      lazy_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                               thread_pool& pool,
+                               std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as lazy_intersection_rb_thread but the points are written to one contiguous vector. */
+      void
+      lazy_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                  std::size_t nthreads,
+                                  std::vector<gde::geom::core::point>& intersection_pts);
+
+      void
+      lazy_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                  thread_pool& pool,
+                                  std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as x_order_intersection_thread but the points are written to one contiguous vector. */
+      void
+      x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                  std::size_t nthreads,
+                                  std::vector<gde::geom::core::point>& intersection_pts);
+
+      void
+      x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                  thread_pool& pool,
+                                  std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as x_order_intersection_rb_thread but the points are written to one contiguous vector. */
+      void
+      x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                     std::size_t nthreads,
+                                     std::vector<gde::geom::core::point>& intersection_pts);
+
+      void
+      x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                     thread_pool& pool,
+                                     std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as fixed_grid_intersection_rb_thread but the points are written to one contiguous vector. */
+      void
+      fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        std::size_t nthreads, double dx, double dy, double xmin,
+                                        double xmax, double ymin, double ymax,
+                                        std::vector<gde::geom::core::point>& intersection_pts);
+
+      void
+      fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                        thread_pool& pool, double dx, double dy, double xmin,
+                                        double xmax, double ymin, double ymax,
+                                        std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*! \brief The same as tiling_intersection_rb_thread but the points are written to one contiguous vector. */
+      void
+      tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    std::size_t nthreads, double dy, double ymin, double ymax,
+                                    std::vector<gde::geom::core::point>& intersection_pts);
+
+      void
+      tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    thread_pool& pool, double dy, double ymin, double ymax,
+                                    std::vector<gde::geom::core::point>& intersection_pts);
+
+      /*!
+        \brief The same as the two-dimensional tiling_intersection_rb_thread but the points are written to one contiguous vector.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    std::size_t nthreads,
+                                    double dx, double dy, double xmin, double xmax,
+                                    double ymin, double ymax,
+                                    std::vector<gde::geom::core::point>& intersection_pts);
+
+      void
+      tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    thread_pool& pool,
+                                    double dx, double dy, double xmin, double xmax,
+                                    double ymin, double ymax,
+                                    std::vector<gde::geom::core::point>& intersection_pts);
+
       /*!
         \brief Given a set of segments compute the intersection points between each pair with thread.
 
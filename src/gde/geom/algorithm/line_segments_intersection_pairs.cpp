@@ -0,0 +1,144 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/line_segments_intersection_pairs.cpp
+
+  \brief Intersection algorithms that report the pairs of segments of each intersection point.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "intersection_core.hpp"
+#include "grid_index.hpp"
+#include "resolution_planner.hpp"
+#include "utils.hpp"
+
+// STL
+#include <algorithm>
+
+std::vector<gde::geom::algorithm::intersection_pair>
+gde::geom::algorithm::lazy_intersection_pairs(const std::vector<gde::geom::core::line_segment>& segments)
+{
+  std::vector<intersection_pair> pairs;
+
+  intersection_pair_sink sink = { &pairs, &segments, &segments };
+
+  lazy_intersection_core<default_kernel, bbox_test>(segments, 0, segments.size(), sink);
+
+  return pairs;
+}
+
+std::vector<gde::geom::algorithm::intersection_pair>
+gde::geom::algorithm::lazy_intersection_rb_pairs(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                 const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  std::vector<intersection_pair> pairs;
+
+  intersection_pair_sink sink = { &pairs, &red_segments, &blue_segments };
+
+  lazy_rb_intersection_core<default_kernel, bbox_test>(red_segments, 0, red_segments.size(), blue_segments, sink);
+
+  return pairs;
+}
+
+std::vector<gde::geom::algorithm::intersection_pair>
+gde::geom::algorithm::x_order_intersection_pairs(const std::vector<gde::geom::core::line_segment>& segments)
+{
+  std::vector<intersection_pair> pairs;
+
+  const std::size_t nsegments = segments.size();
+
+// check if we have at least two segments to scan!
+  if(nsegments <= 1)
+    return pairs;
+
+  std::vector<gde::geom::core::line_segment> normalized_segments;
+  std::vector<std::uint32_t> ordered_ids;
+
+  prepare_ordered_segments(segments, std::vector<gde::geom::core::line_segment>(), normalized_segments, ordered_ids);
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(nsegments);
+
+  std::transform(ordered_ids.begin(), ordered_ids.end(), ordered_segments.begin(), gather_ordered_segment{&normalized_segments});
+
+// the scan gives positions in ordered_segments: the sink maps them back to the input
+  intersection_pair_sink pair_sink = { &pairs, &segments, &segments };
+
+  ordered_pair_sink<intersection_pair_sink> sink = { &pair_sink, ordered_ids.data() };
+
+  x_order_intersection_core<default_kernel, y_interval_test>(ordered_segments, 0, nsegments - 1, sink);
+
+  return pairs;
+}
+
+std::vector<gde::geom::algorithm::intersection_pair>
+gde::geom::algorithm::x_order_intersection_rb_pairs(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  std::vector<intersection_pair> pairs;
+
+  const std::size_t nred_segments = red_segments.size();
+
+  if((nred_segments == 0) || blue_segments.empty())
+    return pairs;
+
+// red segments followed by the blue ones: ids below nred_segments are red
+  std::vector<gde::geom::core::line_segment> segments;
+  std::vector<std::uint32_t> ordered_ids;
+
+  prepare_ordered_segments(red_segments, blue_segments, segments, ordered_ids);
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(segments.size());
+
+  std::transform(ordered_ids.begin(), ordered_ids.end(), ordered_segments.begin(), gather_ordered_segment{&segments});
+
+  intersection_pair_sink sink = { &pairs, &red_segments, &blue_segments };
+
+  x_order_rb_intersection_core<default_kernel, y_interval_test>(ordered_segments, ordered_ids, nred_segments,
+                                                                0, ordered_segments.size() - 1, sink);
+
+  return pairs;
+}
+
+std::vector<gde::geom::algorithm::intersection_pair>
+gde::geom::algorithm::fixed_grid_intersection_rb_pairs(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                       const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                       double dx, double dy, double xmin, double xmax,
+                                                       double ymin, double ymax)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  std::vector<intersection_pair> pairs;
+
+// index blue segments in a grid
+  grid_index blue_grid;
+
+  build_grid_index(blue_segments, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
+
+  intersection_pair_sink sink = { &pairs, &red_segments, &blue_segments };
+
+  grid_intersection_core<default_kernel, bbox_test>(red_segments, 0, red_segments.size(), blue_segments, blue_grid, sink);
+
+  return pairs;
+}
@@ -0,0 +1,239 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/line_segments_intersection_visitor.cpp
+
+  \brief Intersection algorithms that pass each intersection point to a visitor.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "intersection_core.hpp"
+#include "grid_index.hpp"
+#include "resolution_planner.hpp"
+#include "parallel_sort.hpp"
+#include "utils.hpp"
+#include "work_stealing_scheduler.hpp"
+
+// STL
+#include <algorithm>
+
+struct visitor_computer3
+{
+  gde::geom::algorithm::intersection_visitor* visitor;
+  const std::vector<gde::geom::core::line_segment>* ordered_segments;
+  const std::vector<std::uint32_t>* ordered_ids;
+
+  void operator()(std::size_t, std::size_t first, std::size_t last)
+  {
+    gde::geom::algorithm::ordered_pair_sink<gde::geom::algorithm::intersection_visitor> sink = { visitor, ordered_ids->data() };
+
+    gde::geom::algorithm::x_order_intersection_core<gde::geom::algorithm::default_kernel,
+                                                    gde::geom::algorithm::y_interval_test>(*ordered_segments, first, last, sink);
+  }
+};
+
+struct visitor_computer4
+{
+  gde::geom::algorithm::intersection_visitor* visitor;
+  const std::vector<gde::geom::core::line_segment>* ordered_segments;
+  const std::vector<std::uint32_t>* ordered_ids;
+  std::size_t nred;
+
+  void operator()(std::size_t, std::size_t first, std::size_t last)
+  {
+    gde::geom::algorithm::x_order_rb_intersection_core<gde::geom::algorithm::default_kernel,
+                                                       gde::geom::algorithm::y_interval_test>(*ordered_segments, *ordered_ids, nred, first, last, *visitor);
+  }
+};
+
+struct visitor_computer6
+{
+  gde::geom::algorithm::intersection_visitor* visitor;
+  const gde::geom::algorithm::grid_index* blue_grid;
+  const std::vector<gde::geom::core::line_segment>* red_segments;
+  const std::vector<gde::geom::core::line_segment>* blue_segments;
+
+  void operator()(std::size_t, std::size_t red_first, std::size_t red_last)
+  {
+    gde::geom::algorithm::grid_intersection_core<gde::geom::algorithm::default_kernel,
+                                                 gde::geom::algorithm::bbox_test>(*red_segments, red_first, red_last, *blue_segments, *blue_grid, *visitor);
+  }
+};
+
+void
+gde::geom::algorithm::x_order_intersection(const std::vector<gde::geom::core::line_segment>& segments,
+                                           intersection_visitor& visitor)
+{
+  if(segments.size() <= 1)
+    return;
+
+  std::vector<gde::geom::core::line_segment> normalized_segments;
+  std::vector<std::uint32_t> ordered_ids;
+
+  prepare_ordered_segments(segments, std::vector<gde::geom::core::line_segment>(), normalized_segments, ordered_ids);
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(segments.size());
+
+  std::transform(ordered_ids.begin(), ordered_ids.end(), ordered_segments.begin(), gather_ordered_segment{&normalized_segments});
+
+  visitor_computer3 vc = { &visitor, &ordered_segments, &ordered_ids };
+
+  vc(0, 0, segments.size() - 1);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  std::size_t nthreads,
+                                                  intersection_visitor& visitor)
+{
+  thread_pool pool(nthreads);
+
+  x_order_intersection_thread(segments, pool, visitor);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  thread_pool& pool,
+                                                  intersection_visitor& visitor)
+{
+  if(segments.size() <= 1)
+    return;
+
+  std::vector<gde::geom::core::line_segment> normalized_segments;
+  std::vector<std::uint32_t> ordered_ids;
+
+  prepare_ordered_segments(segments, std::vector<gde::geom::core::line_segment>(), pool, normalized_segments, ordered_ids);
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(segments.size());
+
+  parallel_transform(pool, ordered_ids.begin(), ordered_ids.end(), ordered_segments.begin(), gather_ordered_segment{&normalized_segments});
+
+  visitor_computer3 vc = { &visitor, &ordered_segments, &ordered_ids };
+
+  parallel_for(pool, 0, segments.size() - 1, vc);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                              const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                              intersection_visitor& visitor)
+{
+  if(red_segments.empty() || blue_segments.empty())
+    return;
+
+// red segments followed by the blue ones: ids below the number of red segments are red
+  std::vector<gde::geom::core::line_segment> segments;
+  std::vector<std::uint32_t> ordered_ids;
+
+  prepare_ordered_segments(red_segments, blue_segments, segments, ordered_ids);
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(segments.size());
+
+  std::transform(ordered_ids.begin(), ordered_ids.end(), ordered_segments.begin(), gather_ordered_segment{&segments});
+
+  visitor_computer4 vc = { &visitor, &ordered_segments, &ordered_ids, red_segments.size() };
+
+  vc(0, 0, segments.size() - 1);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                     std::size_t nthreads,
+                                                     intersection_visitor& visitor)
+{
+  thread_pool pool(nthreads);
+
+  x_order_intersection_rb_thread(red_segments, blue_segments, pool, visitor);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                     thread_pool& pool,
+                                                     intersection_visitor& visitor)
+{
+  if(red_segments.empty() || blue_segments.empty())
+    return;
+
+  std::vector<gde::geom::core::line_segment> segments;
+  std::vector<std::uint32_t> ordered_ids;
+
+  prepare_ordered_segments(red_segments, blue_segments, pool, segments, ordered_ids);
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(segments.size());
+
+  parallel_transform(pool, ordered_ids.begin(), ordered_ids.end(), ordered_segments.begin(), gather_ordered_segment{&segments});
+
+  visitor_computer4 vc = { &visitor, &ordered_segments, &ordered_ids, red_segments.size() };
+
+  parallel_for(pool, 0, segments.size() - 1, vc);
+}
+
+void
+gde::geom::algorithm::fixed_grid_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                 const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                 double dx, double dy, double xmin, double xmax,
+                                                 double ymin, double ymax,
+                                                 intersection_visitor& visitor)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  grid_index blue_grid;
+
+  build_grid_index(blue_segments, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
+
+  grid_intersection_core<default_kernel, bbox_test>(red_segments, 0, red_segments.size(), blue_segments, blue_grid, visitor);
+}
+
+void
+gde::geom::algorithm::fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                        std::size_t nthreads, double dx, double dy, double xmin,
+                                                        double xmax, double ymin, double ymax,
+                                                        intersection_visitor& visitor)
+{
+  thread_pool pool(nthreads);
+
+  fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, visitor);
+}
+
+void
+gde::geom::algorithm::fixed_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                        const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                        thread_pool& pool, double dx, double dy, double xmin,
+                                                        double xmax, double ymin, double ymax,
+                                                        intersection_visitor& visitor)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  grid_index blue_grid;
+
+  build_grid_index_thread(blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
+
+  visitor_computer6 vc = { &visitor, &blue_grid, &red_segments, &blue_segments };
+
+  parallel_for(pool, 0, red_segments.size(), vc);
+}
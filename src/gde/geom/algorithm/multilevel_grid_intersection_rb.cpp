@@ -0,0 +1,82 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/multilevel_grid_intersection_rb.cpp
+
+  \brief Multi-level grid intersection algorithm.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "intersection_core.hpp"
+#include "grid_index.hpp"
+#include "resolution_planner.hpp"
+#include "utils.hpp"
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::multilevel_grid_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                      double dx, double dy, double xmin, double xmax,
+                                                      double ymin, double ymax)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  std::vector<gde::geom::core::point> ipts;
+
+// index each set in the levels of the grid that match the size of its segments
+  multilevel_grid_index red_grid;
+  multilevel_grid_index blue_grid;
+
+  build_multilevel_grid_index(red_segments, dx, dy, xmin, xmax, ymin, ymax, red_grid);
+  build_multilevel_grid_index(blue_segments, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
+
+  point_vector_sink sink = { &ipts };
+
+  multilevel_grid_intersection_core<default_kernel, bbox_test>(red_segments, red_grid, blue_segments, blue_grid,
+                                                               0, red_segments.size() + blue_segments.size(), sink);
+
+  return ipts;
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::multilevel_grid_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                            double dx, double dy, double xmin, double xmax,
+                                                            double ymin, double ymax)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  multilevel_grid_index red_grid;
+  multilevel_grid_index blue_grid;
+
+  build_multilevel_grid_index(red_segments, dx, dy, xmin, xmax, ymin, ymax, red_grid);
+  build_multilevel_grid_index(blue_segments, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
+
+  intersection_count_sink sink = {};
+
+  multilevel_grid_intersection_core<default_kernel, bbox_test>(red_segments, red_grid, blue_segments, blue_grid,
+                                                               0, red_segments.size() + blue_segments.size(), sink);
+
+  return sink.count;
+}
@@ -0,0 +1,118 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/multilevel_grid_intersection_rb_thread.cpp
+
+  \brief Multi-level grid intersection algorithm.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "count_then_fill.hpp"
+#include "intersection_core.hpp"
+#include "grid_index.hpp"
+#include "resolution_planner.hpp"
+#include "utils.hpp"
+#include "work_stealing_scheduler.hpp"
+
+struct multilevel_grid_scan
+{
+  const gde::geom::algorithm::multilevel_grid_index* red_grid;
+  const gde::geom::algorithm::multilevel_grid_index* blue_grid;
+  const std::vector<gde::geom::core::line_segment>* red_segments;
+  const std::vector<gde::geom::core::line_segment>* blue_segments;
+
+  template<class Sink>
+  void operator()(std::size_t first, std::size_t last, Sink& sink) const
+  {
+    gde::geom::algorithm::multilevel_grid_intersection_core<gde::geom::algorithm::default_kernel,
+                                                            gde::geom::algorithm::bbox_test>(*red_segments, *red_grid,
+                                                                                             *blue_segments, *blue_grid,
+                                                                                             first, last, sink);
+  }
+};
+
+void
+gde::geom::algorithm::multilevel_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                             std::size_t nthreads, double dx, double dy, double xmin,
+                                                             double xmax, double ymin, double ymax,
+                                                             std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  multilevel_grid_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, intersection_pts);
+}
+
+void
+gde::geom::algorithm::multilevel_grid_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                             thread_pool& pool, double dx, double dy, double xmin,
+                                                             double xmax, double ymin, double ymax,
+                                                             std::vector<gde::geom::core::point>& intersection_pts)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+// the indexes are small: they are built by the calling thread
+  multilevel_grid_index red_grid;
+  multilevel_grid_index blue_grid;
+
+  build_multilevel_grid_index(red_segments, dx, dy, xmin, xmax, ymin, ymax, red_grid);
+  build_multilevel_grid_index(blue_segments, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
+
+  multilevel_grid_scan scan = { &red_grid, &blue_grid, &red_segments, &blue_segments };
+
+// the queries of the red segments and then the ones of the blue segments
+  count_then_fill(pool, red_segments.size() + blue_segments.size(), scan, intersection_pts);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::multilevel_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                                   std::size_t nthreads, double dx, double dy, double xmin,
+                                                                   double xmax, double ymin, double ymax)
+{
+  thread_pool pool(nthreads);
+
+  return multilevel_grid_intersection_rb_count_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::multilevel_grid_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                                   thread_pool& pool, double dx, double dy, double xmin,
+                                                                   double xmax, double ymin, double ymax)
+{
+  resolve_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  multilevel_grid_index red_grid;
+  multilevel_grid_index blue_grid;
+
+  build_multilevel_grid_index(red_segments, dx, dy, xmin, xmax, ymin, ymax, red_grid);
+  build_multilevel_grid_index(blue_segments, dx, dy, xmin, xmax, ymin, ymax, blue_grid);
+
+  multilevel_grid_scan scan = { &red_grid, &blue_grid, &red_segments, &blue_segments };
+
+  return count_per_thread(pool, red_segments.size() + blue_segments.size(), scan);
+}
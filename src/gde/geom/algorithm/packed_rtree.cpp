@@ -0,0 +1,374 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/packed_rtree.cpp
+
+  \brief A packed R-tree of line segments built in Hilbert order.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "packed_rtree.hpp"
+#include "parallel_sort.hpp"
+#include "utils.hpp"
+#include "work_stealing_scheduler.hpp"
+
+// STL
+#include <algorithm>
+#include <cstdint>
+
+// the order of the Hilbert curve: the extent of the centers is split in 2^16 by 2^16 cells
+const std::uint32_t hilbert_side = 65536;
+
+// spread the 16 low bits of v over the even bits of the result
+std::uint32_t
+interleave_bits(std::uint32_t v)
+{
+  v = (v | (v << 8)) & 0x00FF00FF;
+  v = (v | (v << 4)) & 0x0F0F0F0F;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+
+  return v;
+}
+
+// the position of a cell along the Hilbert curve: the orientation of the curve in each quadrant
+// is computed for all the levels at once with bitwise operations, instead of a loop with a branch per level
+std::uint32_t
+hilbert_key(std::uint32_t x, std::uint32_t y)
+{
+  std::uint32_t a = x ^ y;
+  std::uint32_t b = 0xFFFF ^ a;
+  std::uint32_t c = 0xFFFF ^ (x | y);
+  std::uint32_t d = x & (y ^ 0xFFFF);
+
+  std::uint32_t A = a | (b >> 1);
+  std::uint32_t B = (a >> 1) ^ a;
+  std::uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+  std::uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+  a = A; b = B; c = C; d = D;
+
+  A = (a & (a >> 2)) ^ (b & (b >> 2));
+  B = (a & (b >> 2)) ^ (b & ((a ^ b) >> 2));
+  C ^= (a & (c >> 2)) ^ (b & (d >> 2));
+  D ^= (b & (c >> 2)) ^ ((a ^ b) & (d >> 2));
+
+  a = A; b = B; c = C; d = D;
+
+  A = (a & (a >> 4)) ^ (b & (b >> 4));
+  B = (a & (b >> 4)) ^ (b & ((a ^ b) >> 4));
+  C ^= (a & (c >> 4)) ^ (b & (d >> 4));
+  D ^= (b & (c >> 4)) ^ ((a ^ b) & (d >> 4));
+
+  a = A; b = B; c = C; d = D;
+
+  C ^= (a & (c >> 8)) ^ (b & (d >> 8));
+  D ^= (b & (c >> 8)) ^ ((a ^ b) & (d >> 8));
+
+  a = C ^ (C >> 1);
+  b = D ^ (D >> 1);
+
+  const std::uint32_t i0 = x ^ y;
+  const std::uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+  return (interleave_bits(i1) << 1) | interleave_bits(i0);
+}
+
+// a segment and its position in the tree: the size class of its box, then the position of its center along the Hilbert curve
+struct hilbert_entry
+{
+  std::uint64_t key;
+  std::uint32_t id;
+};
+
+// equal keys keep the order of the input, so the serial and parallel sorts agree
+struct hilbert_entry_cmp
+{
+  bool operator()(const hilbert_entry& lhs, const hilbert_entry& rhs) const
+  {
+    return (lhs.key < rhs.key) || ((lhs.key == rhs.key) && (lhs.id < rhs.id));
+  }
+};
+
+gde::geom::core::rectangle
+segment_box(const gde::geom::core::line_segment& s)
+{
+  return gde::geom::core::rectangle(std::min(s.p1.x, s.p2.x), std::min(s.p1.y, s.p2.y),
+                                    std::max(s.p1.x, s.p2.x), std::max(s.p1.y, s.p2.y));
+}
+
+void
+expand_box(gde::geom::core::rectangle& r, const gde::geom::core::rectangle& other)
+{
+  r.ll.x = std::min(r.ll.x, other.ll.x);
+  r.ll.y = std::min(r.ll.y, other.ll.y);
+  r.ur.x = std::max(r.ur.x, other.ur.x);
+  r.ur.y = std::max(r.ur.y, other.ur.y);
+}
+
+// the cell of the Hilbert grid over the extent of the centers that holds a center
+std::uint32_t
+hilbert_cell(double c, double cmin, double cmax)
+{
+  if(cmax <= cmin)
+    return 0;
+
+  const double scale = static_cast<double>(hilbert_side - 1) / (cmax - cmin);
+
+  return std::min(static_cast<std::uint32_t>((c - cmin) * scale), hilbert_side - 1);
+}
+
+// the size class of a box: the boxes of a class span up to 16 times more cells of the Hilbert grid than the ones of the class below
+std::uint32_t
+size_class(const gde::geom::core::rectangle& box, const gde::geom::core::rectangle& centers)
+{
+  const double range = std::max(centers.ur.x - centers.ll.x, centers.ur.y - centers.ll.y);
+
+  if(range <= 0.0)
+    return 0;
+
+  const double cells = std::max(box.ur.x - box.ll.x, box.ur.y - box.ll.y) * static_cast<double>(hilbert_side) / range;
+
+  std::uint32_t c = 0;
+
+  for(double limit = 16.0; (cells >= limit) && (limit < static_cast<double>(hilbert_side)); limit *= 16.0)
+    ++c;
+
+  return c;
+}
+
+// the key of box k: a long segment is packed with other long segments, so it doesn't stretch the nodes of the short ones
+hilbert_entry
+make_hilbert_entry(const gde::geom::core::rectangle& box, std::size_t k, const gde::geom::core::rectangle& centers)
+{
+  const double cx = 0.5 * (box.ll.x + box.ur.x);
+  const double cy = 0.5 * (box.ll.y + box.ur.y);
+
+  const std::uint64_t position = hilbert_key(hilbert_cell(cx, centers.ll.x, centers.ur.x),
+                                             hilbert_cell(cy, centers.ll.y, centers.ur.y));
+
+  hilbert_entry e = { (static_cast<std::uint64_t>(size_class(box, centers)) << 32) | position,
+                      static_cast<std::uint32_t>(k) };
+
+  return e;
+}
+
+// the levels above the boxes of the segments, up to a single root
+void
+build_upper_levels(gde::geom::algorithm::packed_rtree& tree)
+{
+  const std::size_t capacity = tree.node_capacity;
+
+  std::size_t level = 0;
+
+  do
+  {
+    const std::size_t first = tree.levels[level];
+    const std::size_t last = tree.levels[level + 1];
+
+    for(std::size_t k = first; k < last; k += capacity)
+    {
+      gde::geom::core::rectangle r;
+
+      for(std::size_t child = k; child != std::min(k + capacity, last); ++child)
+        expand_box(r, tree.boxes[child]);
+
+      tree.boxes.push_back(r);
+    }
+
+    tree.levels.push_back(tree.boxes.size());
+
+    ++level;
+  }
+  while(tree.level_size(level) > 1);
+}
+
+void
+gde::geom::algorithm::build_packed_rtree(const std::vector<gde::geom::core::line_segment>& segments,
+                                         std::size_t node_capacity,
+                                         packed_rtree& tree)
+{
+  check_indexed_segments(segments.size(), "build_packed_rtree");
+
+  const std::size_t nsegments = segments.size();
+
+  tree.node_capacity = std::max(node_capacity, std::size_t(2));
+  tree.boxes.clear();
+  tree.ids.resize(nsegments);
+  tree.levels.clear();
+
+  if(nsegments == 0)
+    return;
+
+  std::vector<gde::geom::core::rectangle> segment_boxes(nsegments);
+
+  gde::geom::core::rectangle centers;
+
+  for(std::size_t i = 0; i != nsegments; ++i)
+  {
+    segment_boxes[i] = segment_box(segments[i]);
+
+    const double cx = 0.5 * (segment_boxes[i].ll.x + segment_boxes[i].ur.x);
+    const double cy = 0.5 * (segment_boxes[i].ll.y + segment_boxes[i].ur.y);
+
+    expand_box(centers, gde::geom::core::rectangle(cx, cy, cx, cy));
+  }
+
+// sort the segments along the Hilbert curve
+  std::vector<hilbert_entry> entries(nsegments);
+
+  for(std::size_t i = 0; i != nsegments; ++i)
+    entries[i] = make_hilbert_entry(segment_boxes[i], i, centers);
+
+  std::sort(entries.begin(), entries.end(), hilbert_entry_cmp());
+
+// level 0: the boxes of the segments in Hilbert order
+  tree.boxes.reserve(nsegments + nsegments / (tree.node_capacity - 1) + 1);
+  tree.levels.push_back(0);
+
+  for(std::size_t k = 0; k != nsegments; ++k)
+  {
+    tree.ids[k] = entries[k].id;
+    tree.boxes.push_back(segment_boxes[entries[k].id]);
+  }
+
+  tree.levels.push_back(nsegments);
+
+  build_upper_levels(tree);
+}
+
+/*!
+  \struct rtree_build_computer
+
+  \brief Runs one phase of the parallel R-tree build over a range of segments.
+ */
+struct rtree_build_computer
+{
+  enum phase_type
+  {
+    BOXES,    //!< Compute the box of each segment and the extent of the centers of each worker.
+    KEYS,     //!< Compute the Hilbert key of each segment.
+    GATHER    //!< Copy the boxes and indexes in Hilbert order.
+  };
+
+  phase_type phase;
+  const std::vector<gde::geom::core::line_segment>* segments;
+  std::vector<gde::geom::core::rectangle>* segment_boxes;
+  std::vector<gde::geom::core::rectangle>* centers;
+  std::vector<hilbert_entry>* entries;
+  gde::geom::algorithm::packed_rtree* tree;
+
+  void operator()(std::size_t thread_pos, std::size_t first, std::size_t last)
+  {
+    switch(phase)
+    {
+      case BOXES:
+        for(std::size_t i = first; i != last; ++i)
+        {
+          const gde::geom::core::rectangle box = segment_box((*segments)[i]);
+
+          const double cx = 0.5 * (box.ll.x + box.ur.x);
+          const double cy = 0.5 * (box.ll.y + box.ur.y);
+
+          (*segment_boxes)[i] = box;
+
+          expand_box((*centers)[thread_pos], gde::geom::core::rectangle(cx, cy, cx, cy));
+        }
+      break;
+
+      case KEYS:
+        for(std::size_t i = first; i != last; ++i)
+          (*entries)[i] = make_hilbert_entry((*segment_boxes)[i], i, centers->front());
+      break;
+
+      case GATHER:
+        for(std::size_t k = first; k != last; ++k)
+        {
+          tree->ids[k] = (*entries)[k].id;
+          tree->boxes[k] = (*segment_boxes)[(*entries)[k].id];
+        }
+      break;
+    }
+  }
+};
+
+void
+gde::geom::algorithm::build_packed_rtree_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                std::size_t nthreads,
+                                                std::size_t node_capacity,
+                                                packed_rtree& tree)
+{
+  thread_pool pool(nthreads);
+
+  build_packed_rtree_thread(segments, pool, node_capacity, tree);
+}
+
+void
+gde::geom::algorithm::build_packed_rtree_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                thread_pool& pool,
+                                                std::size_t node_capacity,
+                                                packed_rtree& tree)
+{
+  check_indexed_segments(segments.size(), "build_packed_rtree");
+
+  const std::size_t nsegments = segments.size();
+
+  tree.node_capacity = std::max(node_capacity, std::size_t(2));
+  tree.boxes.clear();
+  tree.ids.resize(nsegments);
+  tree.levels.clear();
+
+  if(nsegments == 0)
+    return;
+
+  std::vector<gde::geom::core::rectangle> segment_boxes(nsegments);
+  std::vector<gde::geom::core::rectangle> centers(pool.size());
+  std::vector<hilbert_entry> entries(nsegments);
+
+  rtree_build_computer rc = { rtree_build_computer::BOXES, &segments, &segment_boxes, &centers, &entries, &tree };
+
+  parallel_for(pool, 0, nsegments, rc);
+
+// the extent of all the centers
+  for(std::size_t t = 1; t != centers.size(); ++t)
+    expand_box(centers.front(), centers[t]);
+
+  rc.phase = rtree_build_computer::KEYS;
+
+  parallel_for(pool, 0, nsegments, rc);
+
+  parallel_sort(pool, entries.begin(), entries.end(), hilbert_entry_cmp());
+
+  tree.boxes.reserve(nsegments + nsegments / (tree.node_capacity - 1) + 1);
+  tree.boxes.resize(nsegments);
+  tree.levels.push_back(0);
+  tree.levels.push_back(nsegments);
+
+  rc.phase = rtree_build_computer::GATHER;
+
+  parallel_for(pool, 0, nsegments, rc);
+
+  build_upper_levels(tree);
+}
@@ -0,0 +1,141 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/packed_rtree.hpp
+
+  \brief A packed R-tree of line segments built in Hilbert order.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+#ifndef __GDE_GEOM_ALGORITHM_PACKED_RTREE_HPP__
+#define __GDE_GEOM_ALGORITHM_PACKED_RTREE_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "thread_pool.hpp"
+
+// STL
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*! \brief The default number of children of each node of a packed R-tree. */
+      const std::size_t rtree_node_capacity = 16;
+
+      /*!
+        \struct packed_rtree
+
+        \brief A static R-tree whose nodes are stored level by level in flat arrays.
+
+        Level 0 holds the bounding boxes of the segments in the order of their centers
+        along a Hilbert curve. Each node of level l + 1 bounds the next node_capacity
+        boxes of level l, so the children of a node are found from its position and
+        no pointer is stored. The last level has a single node: the root.
+
+        Each segment has a single entry, whatever its length: long segments only make
+        the boxes of their nodes larger.
+
+        \note Segment indexes are 32-bit: a tree can hold up to 2^32 - 1 segments (see max_indexed_segments),
+              the build functions throw std::length_error for larger sets.
+       */
+      struct packed_rtree
+      {
+        std::size_t node_capacity;
+        std::vector<gde::geom::core::rectangle> boxes;  //!< The boxes of all the levels, starting with the ones of the segments.
+        std::vector<std::uint32_t> ids;                 //!< The index of the segment of each box of level 0.
+        std::vector<std::size_t> levels;                //!< Start of each level in boxes, plus the number of boxes at the end.
+
+        /*! \brief The number of levels, including the one of the segments: 0 for an empty tree. */
+        std::size_t nlevels() const
+        {
+          return levels.empty() ? 0 : levels.size() - 1;
+        }
+
+        /*! \brief The number of nodes of a level. */
+        std::size_t level_size(std::size_t level) const
+        {
+          return levels[level + 1] - levels[level];
+        }
+
+        /*! \brief The range of the boxes of level - 1 bounded by the box at position k of a level above 0. */
+        std::pair<std::size_t, std::size_t> children(std::size_t level, std::size_t k) const
+        {
+          const std::size_t first = levels[level - 1] + (k - levels[level]) * node_capacity;
+
+          return std::make_pair(first, std::min(first + node_capacity, levels[level]));
+        }
+      };
+
+      /*! \brief Tells if two boxes share at least a point. */
+      inline bool
+      boxes_intersect(const gde::geom::core::rectangle& lhs, const gde::geom::core::rectangle& rhs)
+      {
+        return (lhs.ll.x <= rhs.ur.x) && (rhs.ll.x <= lhs.ur.x) &&
+               (lhs.ll.y <= rhs.ur.y) && (rhs.ll.y <= lhs.ur.y);
+      }
+
+      /*!
+        \brief Index a set of segments in a packed R-tree.
+
+        The segments are sorted by the position of the center of their boxes along a Hilbert curve
+        over the extent of the centers, then the levels are built from the bottom up.
+        An empty set gives a tree without levels.
+       */
+      void
+      build_packed_rtree(const std::vector<gde::geom::core::line_segment>& segments,
+                         std::size_t node_capacity,
+                         packed_rtree& tree);
+
+      /*!
+        \brief Index a set of segments in a packed R-tree using a given number of threads.
+
+        The boxes and the Hilbert keys are computed and sorted in parallel.
+        The result is the same as build_packed_rtree.
+       */
+      void
+      build_packed_rtree_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                std::size_t nthreads,
+                                std::size_t node_capacity,
+                                packed_rtree& tree);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      build_packed_rtree_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                thread_pool& pool,
+                                std::size_t node_capacity,
+                                packed_rtree& tree);
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_PACKED_RTREE_HPP__
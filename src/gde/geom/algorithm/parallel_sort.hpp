@@ -0,0 +1,191 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/parallel_sort.hpp
+
+  \brief Parallel transform and sort stages used to prepare segments for the threaded algorithms.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_PARALLEL_SORT_HPP__
+#define __GDE_GEOM_ALGORITHM_PARALLEL_SORT_HPP__
+
+// GDE
+#include "thread_pool.hpp"
+
+// STL
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \brief Apply op to each element of [first, last) writing the results from out, using the threads of a pool.
+
+        Each worker transforms a contiguous share of the range with its own copy of op.
+       */
+      template<class InputIt, class OutputIt, class UnaryOp>
+      void
+      parallel_transform(thread_pool& pool, InputIt first, InputIt last, OutputIt out, UnaryOp op)
+      {
+        const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+
+        const std::size_t nworkers = pool.size();
+
+        pool.run([first, out, op, n, nworkers](std::size_t thread_pos)
+                 {
+                   const std::size_t begin = (n * thread_pos) / nworkers;
+                   const std::size_t end = (n * (thread_pos + 1)) / nworkers;
+
+                   UnaryOp my_op(op);
+
+                   std::transform(first + begin, first + end, out + begin, my_op);
+                 });
+      }
+
+      /*!
+        \brief The number of elements of the sorted range a that come before the k-th element
+               of the stable merge of a and b.
+       */
+      template<class RandomIt, class Compare>
+      std::size_t
+      merge_path_split(RandomIt a, std::size_t na, RandomIt b, std::size_t nb, std::size_t k, Compare cmp)
+      {
+        std::size_t lo = (k > nb) ? (k - nb) : 0;
+        std::size_t hi = std::min(k, na);
+
+// largest i such that a[i - 1] is merged before b[k - i]
+        while(lo < hi)
+        {
+          const std::size_t i = lo + (hi - lo + 1) / 2;
+
+          if(cmp(b[k - i], a[i - 1]))
+            hi = i - 1;
+          else
+            lo = i;
+        }
+
+        return lo;
+      }
+
+      /*!
+        \brief Sort the range [first, last) using the threads of a pool.
+
+        Each worker sorts a block of the range, then the sorted blocks are merged pairwise.
+        Every merge round is shared among all the workers: each one writes its own part of
+        the output, found with a binary search on the merge path. Equal elements from
+        different blocks keep the order of the blocks.
+
+        Small ranges are sorted by the calling thread.
+
+        \pre [first, last) must be contiguous, as in a std::vector.
+       */
+      template<class RandomIt, class Compare>
+      void
+      parallel_sort(thread_pool& pool, RandomIt first, RandomIt last, Compare cmp)
+      {
+        typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+
+        const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+
+        const std::size_t nblocks = pool.size();
+
+        if((nblocks == 1) || (n < 4096 * nblocks))
+        {
+          std::sort(first, last, cmp);
+          return;
+        }
+
+        std::vector<std::size_t> bounds(nblocks + 1);
+
+        for(std::size_t i = 0; i <= nblocks; ++i)
+          bounds[i] = (n * i) / nblocks;
+
+// sort each block
+        pool.run([first, cmp, &bounds](std::size_t thread_pos)
+                 {
+                   std::sort(first + bounds[thread_pos], first + bounds[thread_pos + 1], cmp);
+                 });
+
+// merge pairs of sorted runs going back and forth between the range and a buffer
+        std::vector<value_type> buffer(n);
+
+        value_type* const data = &(*first);
+        value_type* src = data;
+        value_type* dst = buffer.data();
+
+        for(std::size_t width = 1; width < nblocks; width *= 2)
+        {
+          pool.run([src, dst, n, nblocks, width, cmp, &bounds](std::size_t thread_pos)
+                   {
+// this worker output share
+                     const std::size_t out_first = (n * thread_pos) / nblocks;
+                     const std::size_t out_last = (n * (thread_pos + 1)) / nblocks;
+
+                     for(std::size_t r = 0; r < nblocks; r += 2 * width)
+                     {
+                       const std::size_t lo = bounds[r];
+                       const std::size_t mid = bounds[std::min(r + width, nblocks)];
+                       const std::size_t hi = bounds[std::min(r + 2 * width, nblocks)];
+
+                       const std::size_t a = std::max(lo, out_first);
+                       const std::size_t b = std::min(hi, out_last);
+
+                       if(a >= b)
+                         continue;
+
+                       const std::size_t ia = merge_path_split(src + lo, mid - lo, src + mid, hi - mid, a - lo, cmp);
+                       const std::size_t ib = merge_path_split(src + lo, mid - lo, src + mid, hi - mid, b - lo, cmp);
+
+                       std::merge(src + lo + ia, src + lo + ib,
+                                  src + mid + (a - lo - ia), src + mid + (b - lo - ib),
+                                  dst + a, cmp);
+                     }
+                   });
+
+          std::swap(src, dst);
+        }
+
+        if(src != data)
+        {
+          pool.run([src, data, n, nblocks](std::size_t thread_pos)
+                   {
+                     const std::size_t begin = (n * thread_pos) / nblocks;
+                     const std::size_t end = (n * (thread_pos + 1)) / nblocks;
+
+                     std::copy(src + begin, src + end, data + begin);
+                   });
+        }
+      }
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_PARALLEL_SORT_HPP__
@@ -0,0 +1,367 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/quadtree_index.cpp
+
+  \brief An adaptive quadtree of line segments whose leaves keep the segments in a given order.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "quadtree_index.hpp"
+#include "work_stealing_scheduler.hpp"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// the top levels are split until there are this many nodes, whatever the number of threads,
+// so that the serial and parallel builds give the same leaves in the same order
+const std::size_t quadtree_frontier_size = 64;
+
+/*!
+  \struct quadtree_entry
+
+  \brief A segment and the columns and rows of the deepest level crossed by its bounding box.
+
+  The cells of a level are exactly twice the ones of the next level, so the columns of
+  any level are the ones of the deepest level shifted right: the segments are read only once.
+ */
+struct quadtree_entry
+{
+  std::uint32_t id;
+  std::uint32_t first_col;
+  std::uint32_t last_col;
+  std::uint32_t first_row;
+  std::uint32_t last_row;
+};
+
+// a node still to be split and the positions of the entries of the segments that cross it
+struct quadtree_node
+{
+  gde::geom::algorithm::quadtree_cell cell;
+  std::vector<std::uint32_t> entries;
+};
+
+// the column or row of the deepest level of a coordinate, computed as in is_in_cell
+std::uint32_t
+deepest_cell(double v, double origin, double size)
+{
+  const std::uint32_t last = (std::uint32_t(1) << gde::geom::algorithm::quadtree_max_level) - 1;
+
+  const double c = std::floor((v - origin) / size);
+
+  return (c < 0.0) ? 0 : ((c > last) ? last : static_cast<std::uint32_t>(c));
+}
+
+/*!
+  \struct quadtree_entry_computer
+
+  \brief Computes the entries of a range of segments, in the given order.
+ */
+struct quadtree_entry_computer
+{
+  const std::vector<gde::geom::core::line_segment>* segments;
+  const std::vector<std::uint32_t>* order;
+  const gde::geom::algorithm::quadtree_index* tree;
+  std::vector<quadtree_entry>* entries;
+
+  void operator()(std::size_t, std::size_t first, std::size_t last)
+  {
+    const double dx = tree->dx(gde::geom::algorithm::quadtree_max_level);
+    const double dy = tree->dy(gde::geom::algorithm::quadtree_max_level);
+
+    for(std::size_t i = first; i != last; ++i)
+    {
+      const std::uint32_t id = (*order)[i];
+
+      const gde::geom::core::line_segment& s = (*segments)[id];
+
+      quadtree_entry& e = (*entries)[i];
+
+      e.id = id;
+      e.first_col = deepest_cell(std::min(s.p1.x, s.p2.x), tree->xmin, dx);
+      e.last_col = deepest_cell(std::max(s.p1.x, s.p2.x), tree->xmin, dx);
+      e.first_row = deepest_cell(std::min(s.p1.y, s.p2.y), tree->ymin, dy);
+      e.last_row = deepest_cell(std::max(s.p1.y, s.p2.y), tree->ymin, dy);
+    }
+  }
+};
+
+// distribute the segments of a node among its four children: false if the node must be a leaf
+bool
+split_quadtree_node(const std::vector<quadtree_entry>& entries,
+                    std::size_t leaf_capacity,
+                    const quadtree_node& node,
+                    quadtree_node children[4])
+{
+  if((node.entries.size() <= leaf_capacity) || (node.cell.level >= gde::geom::algorithm::quadtree_max_level))
+    return false;
+
+  const std::uint32_t level = node.cell.level + 1;
+
+  const std::uint32_t shift = static_cast<std::uint32_t>(gde::geom::algorithm::quadtree_max_level) - level;
+
+// the columns and rows of the children of the node
+  const std::uint32_t col0 = 2 * node.cell.col;
+  const std::uint32_t row0 = 2 * node.cell.row;
+
+// each child may get all the entries: write them without branches and trim the lists at the end
+  std::uint32_t* out[4];
+  std::size_t sizes[4] = { 0, 0, 0, 0 };
+
+  for(std::size_t q = 0; q != 4; ++q)
+  {
+    gde::geom::algorithm::quadtree_cell cell = { level, col0 + static_cast<std::uint32_t>(q / 2), row0 + static_cast<std::uint32_t>(q % 2) };
+
+    children[q].cell = cell;
+    children[q].entries.resize(node.entries.size());
+
+    out[q] = children[q].entries.data();
+  }
+
+  for(std::uint32_t pos : node.entries)
+  {
+    const quadtree_entry& e = entries[pos];
+
+// does the segment start in the right (top) half and does it reach it?
+    const bool right_first = (e.first_col >> shift) > col0;
+    const bool right_last = (e.last_col >> shift) > col0;
+    const bool top_first = (e.first_row >> shift) > row0;
+    const bool top_last = (e.last_row >> shift) > row0;
+
+    out[0][sizes[0]] = pos;
+    sizes[0] += !right_first && !top_first;
+
+    out[1][sizes[1]] = pos;
+    sizes[1] += !right_first && top_last;
+
+    out[2][sizes[2]] = pos;
+    sizes[2] += right_last && !top_first;
+
+    out[3][sizes[3]] = pos;
+    sizes[3] += right_last && top_last;
+  }
+
+// segments that cross the node are copied to all the children instead of being split among them
+  if(sizes[0] + sizes[1] + sizes[2] + sizes[3] > 2 * node.entries.size())
+    return false;
+
+  for(std::size_t q = 0; q != 4; ++q)
+    children[q].entries.resize(sizes[q]);
+
+  return true;
+}
+
+void
+add_quadtree_leaf(const std::vector<quadtree_entry>& entries,
+                  const quadtree_node& node,
+                  gde::geom::algorithm::quadtree_index& tree)
+{
+  tree.cells.push_back(node.cell);
+
+  for(std::uint32_t pos : node.entries)
+    tree.ids.push_back(entries[pos].id);
+
+  tree.offsets.push_back(tree.ids.size());
+}
+
+// split a node and its descendants depth first, adding the leaves in order
+void
+build_quadtree_subtree(const std::vector<quadtree_entry>& entries,
+                       std::size_t leaf_capacity,
+                       const quadtree_node& node,
+                       gde::geom::algorithm::quadtree_index& tree)
+{
+  quadtree_node children[4];
+
+  if(!split_quadtree_node(entries, leaf_capacity, node, children))
+  {
+    add_quadtree_leaf(entries, node, tree);
+    return;
+  }
+
+  for(std::size_t q = 0; q != 4; ++q)
+    build_quadtree_subtree(entries, leaf_capacity, children[q], tree);
+}
+
+// the extent of the root: a bit larger than the given one, so its right and top borders are inside
+void
+init_quadtree_index(double xmin, double xmax, double ymin, double ymax,
+                    gde::geom::algorithm::quadtree_index& tree)
+{
+  tree.xmin = xmin;
+  tree.ymin = ymin;
+  tree.width = (xmax > xmin) ? (xmax - xmin) * (1.0 + 1.0 / 1048576.0) : 1.0;
+  tree.height = (ymax > ymin) ? (ymax - ymin) * (1.0 + 1.0 / 1048576.0) : 1.0;
+
+  tree.cells.clear();
+  tree.offsets.assign(1, 0);
+  tree.ids.clear();
+}
+
+// the top levels of the tree, split breadth first
+void
+build_quadtree_frontier(const std::vector<quadtree_entry>& entries,
+                        std::size_t leaf_capacity,
+                        std::vector<quadtree_node>& frontier)
+{
+  frontier.resize(1);
+  frontier[0].cell.level = 0;
+  frontier[0].cell.col = 0;
+  frontier[0].cell.row = 0;
+  frontier[0].entries.resize(entries.size());
+
+  for(std::size_t i = 0; i != entries.size(); ++i)
+    frontier[0].entries[i] = static_cast<std::uint32_t>(i);
+
+// split the nodes level by level while the frontier is small
+  bool splitted = true;
+
+  while(splitted && (frontier.size() < quadtree_frontier_size))
+  {
+    splitted = false;
+
+    std::vector<quadtree_node> next;
+
+    for(quadtree_node& node : frontier)
+    {
+      quadtree_node children[4];
+
+      if(split_quadtree_node(entries, leaf_capacity, node, children))
+      {
+        for(std::size_t q = 0; q != 4; ++q)
+          next.push_back(std::move(children[q]));
+
+        splitted = true;
+      }
+      else
+      {
+        next.push_back(std::move(node));
+      }
+    }
+
+    frontier.swap(next);
+  }
+}
+
+void
+gde::geom::algorithm::build_quadtree_index(const std::vector<gde::geom::core::line_segment>& segments,
+                                           const std::vector<std::uint32_t>& order,
+                                           std::size_t leaf_capacity,
+                                           double xmin, double xmax, double ymin, double ymax,
+                                           quadtree_index& tree)
+{
+  check_indexed_segments(order.size(), "build_quadtree_index");
+
+  init_quadtree_index(xmin, xmax, ymin, ymax, tree);
+
+  std::vector<quadtree_entry> entries(order.size());
+
+  quadtree_entry_computer ec = { &segments, &order, &tree, &entries };
+
+  ec(0, 0, order.size());
+
+  std::vector<quadtree_node> frontier;
+
+  build_quadtree_frontier(entries, leaf_capacity, frontier);
+
+  for(const quadtree_node& node : frontier)
+    build_quadtree_subtree(entries, leaf_capacity, node, tree);
+}
+
+/*!
+  \struct quadtree_build_computer
+
+  \brief Builds the subtrees of a range of nodes of the frontier, each one in its own partial index.
+ */
+struct quadtree_build_computer
+{
+  const std::vector<quadtree_entry>* entries;
+  const std::vector<quadtree_node>* frontier;
+  std::vector<gde::geom::algorithm::quadtree_index>* subtrees;
+  std::size_t leaf_capacity;
+
+  void operator()(std::size_t, std::size_t first, std::size_t last)
+  {
+    for(std::size_t n = first; n != last; ++n)
+      build_quadtree_subtree(*entries, leaf_capacity, (*frontier)[n], (*subtrees)[n]);
+  }
+};
+
+void
+gde::geom::algorithm::build_quadtree_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  const std::vector<std::uint32_t>& order,
+                                                  std::size_t nthreads,
+                                                  std::size_t leaf_capacity,
+                                                  double xmin, double xmax, double ymin, double ymax,
+                                                  quadtree_index& tree)
+{
+  thread_pool pool(nthreads);
+
+  build_quadtree_index_thread(segments, order, pool, leaf_capacity, xmin, xmax, ymin, ymax, tree);
+}
+
+void
+gde::geom::algorithm::build_quadtree_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  const std::vector<std::uint32_t>& order,
+                                                  thread_pool& pool,
+                                                  std::size_t leaf_capacity,
+                                                  double xmin, double xmax, double ymin, double ymax,
+                                                  quadtree_index& tree)
+{
+  check_indexed_segments(order.size(), "build_quadtree_index");
+
+  init_quadtree_index(xmin, xmax, ymin, ymax, tree);
+
+  std::vector<quadtree_entry> entries(order.size());
+
+  quadtree_entry_computer ec = { &segments, &order, &tree, &entries };
+
+  parallel_for(pool, 0, order.size(), ec);
+
+  std::vector<quadtree_node> frontier;
+
+  build_quadtree_frontier(entries, leaf_capacity, frontier);
+
+// each subtree starts empty, with the extent of the root
+  std::vector<quadtree_index> subtrees(frontier.size(), tree);
+
+  quadtree_build_computer qc = { &entries, &frontier, &subtrees, leaf_capacity };
+
+  parallel_for(pool, 0, frontier.size(), qc, 1);
+
+// join the leaves of the subtrees in the order of the frontier
+  for(const quadtree_index& subtree : subtrees)
+  {
+    const std::size_t base = tree.ids.size();
+
+    tree.cells.insert(tree.cells.end(), subtree.cells.begin(), subtree.cells.end());
+    tree.ids.insert(tree.ids.end(), subtree.ids.begin(), subtree.ids.end());
+
+    for(std::size_t k = 1; k < subtree.offsets.size(); ++k)
+      tree.offsets.push_back(base + subtree.offsets[k]);
+  }
+}
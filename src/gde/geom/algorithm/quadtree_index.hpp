@@ -0,0 +1,162 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/quadtree_index.hpp
+
+  \brief An adaptive quadtree of line segments whose leaves keep the segments in a given order.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+#ifndef __GDE_GEOM_ALGORITHM_QUADTREE_INDEX_HPP__
+#define __GDE_GEOM_ALGORITHM_QUADTREE_INDEX_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "thread_pool.hpp"
+#include "utils.hpp"
+
+// STL
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*! \brief The default number of segments above which a quadtree node is split. */
+      const std::size_t quadtree_leaf_capacity = 1024;
+
+      /*! \brief The deepest level of a quadtree: its cells are 2^16 times smaller than the root along each axis. */
+      const std::size_t quadtree_max_level = 16;
+
+      /*!
+        \struct quadtree_cell
+
+        \brief A leaf of a quadtree: the column and row of a cell of the uniform grid of its level.
+       */
+      struct quadtree_cell
+      {
+        std::uint32_t level;
+        std::uint32_t col;
+        std::uint32_t row;
+      };
+
+      /*!
+        \struct quadtree_index
+
+        \brief A quadtree whose leaves hold the indexes of the segments that cross their bounding box.
+
+        The nodes of level l are the cells of a uniform grid of 2^l by 2^l cells over the root,
+        so a point belongs to a single leaf with the same rule as the cells of a grid_index (see is_in_cell).
+        A node is split in four while it holds more segments than the leaf capacity.
+
+        The segments of leaf k are ids[offsets[k]] to ids[offsets[k + 1] - 1].
+
+        \note Segment indexes are 32-bit: an index can hold up to 2^32 - 1 segments (see max_indexed_segments),
+              the build functions throw std::length_error for larger sets.
+       */
+      struct quadtree_index
+      {
+        double xmin;
+        double ymin;
+        double width;                        //!< The width of the root: a bit larger than the extent, so its right border is inside.
+        double height;                       //!< The height of the root: a bit larger than the extent, so its top border is inside.
+        std::vector<quadtree_cell> cells;    //!< The leaves.
+        std::vector<std::size_t> offsets;    //!< Start of each leaf in ids, plus the total number of entries at the end.
+        std::vector<std::uint32_t> ids;      //!< Segment indexes grouped by leaf.
+
+        /*! \brief The width of the cells of a level. */
+        double dx(std::size_t level) const
+        {
+          return std::ldexp(width, -static_cast<int>(level));
+        }
+
+        /*! \brief The height of the cells of a level. */
+        double dy(std::size_t level) const
+        {
+          return std::ldexp(height, -static_cast<int>(level));
+        }
+
+        /*! \brief Tells if a point is inside a leaf. */
+        bool is_in_leaf(std::size_t k, double x, double y) const
+        {
+          const quadtree_cell& c = cells[k];
+
+          return is_in_cell(xmin, ymin, dx(c.level), dy(c.level), c.col, c.row, x, y);
+        }
+      };
+
+      /*!
+        \brief Index a set of segments in an adaptive quadtree covering the given extent.
+
+        Segments are distributed in the given order, which is kept inside each leaf:
+        if the order is sorted from left to right, so are the leaves.
+
+        A node is split while it holds more than leaf_capacity segments, unless it is
+        at quadtree_max_level or its children would hold more than twice its segments:
+        segments that cross the node don't get fewer by splitting it.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      build_quadtree_index(const std::vector<gde::geom::core::line_segment>& segments,
+                           const std::vector<std::uint32_t>& order,
+                           std::size_t leaf_capacity,
+                           double xmin, double xmax, double ymin, double ymax,
+                           quadtree_index& tree);
+
+      /*!
+        \brief Index a set of segments in an adaptive quadtree using a given number of threads.
+
+        The top levels are split by the calling thread, then the subtrees are built in parallel.
+        The result is the same as build_quadtree_index.
+
+        \pre All segments must be inside the extent.
+       */
+      void
+      build_quadtree_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                  const std::vector<std::uint32_t>& order,
+                                  std::size_t nthreads,
+                                  std::size_t leaf_capacity,
+                                  double xmin, double xmax, double ymin, double ymax,
+                                  quadtree_index& tree);
+
+      /*! \brief The same as above but running on the threads of a given pool. */
+      void
+      build_quadtree_index_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                  const std::vector<std::uint32_t>& order,
+                                  thread_pool& pool,
+                                  std::size_t leaf_capacity,
+                                  double xmin, double xmax, double ymin, double ymax,
+                                  quadtree_index& tree);
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_QUADTREE_INDEX_HPP__
@@ -0,0 +1,113 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/quadtree_intersection_rb.cpp
+
+  \brief Adaptive quadtree intersection algorithm.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "intersection_core.hpp"
+#include "quadtree_index.hpp"
+#include "utils.hpp"
+
+// STL
+#include <algorithm>
+
+// scan each leaf from left to right, keeping only the points inside the leaf
+template<class Sink>
+void
+quadtree_leaves_intersection_rb(const std::vector<gde::geom::core::line_segment>& segments,
+                                std::size_t nred,
+                                const gde::geom::algorithm::quadtree_index& tree,
+                                Sink& sink)
+{
+  for(std::size_t k = 0; k != tree.cells.size(); ++k)
+  {
+    gde::geom::algorithm::quadtree_filter_sink<Sink> leaf_sink = { &tree, k, &sink };
+
+    gde::geom::algorithm::x_order_rb_subset_intersection_core<gde::geom::algorithm::default_kernel,
+                                                              gde::geom::algorithm::y_interval_test>(segments, nred,
+                                                                                                     tree.ids.data() + tree.offsets[k],
+                                                                                                     tree.ids.data() + tree.offsets[k + 1],
+                                                                                                     leaf_sink);
+  }
+}
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::quadtree_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                               const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                               std::size_t leaf_capacity)
+{
+  std::vector<gde::geom::core::point> ipts;
+
+  if(red_segments.empty() || blue_segments.empty())
+    return ipts;
+
+  std::vector<gde::geom::core::line_segment> segments;
+  std::vector<std::uint32_t> order;
+
+  prepare_ordered_segments(red_segments, blue_segments, segments, order);
+
+  gde::geom::core::rectangle rect = compute_rectangle(segments.begin(), segments.end());
+
+// index red and blue segments in the same quadtree: each leaf keeps the left to right order
+  quadtree_index tree;
+
+  build_quadtree_index(segments, order, leaf_capacity, rect.ll.x, rect.ur.x, rect.ll.y, rect.ur.y, tree);
+
+  point_vector_sink sink = { &ipts };
+
+  quadtree_leaves_intersection_rb(segments, red_segments.size(), tree, sink);
+
+  return ipts;
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::quadtree_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                     std::size_t leaf_capacity)
+{
+  intersection_count_sink sink = {};
+
+  if(red_segments.empty() || blue_segments.empty())
+    return sink.count;
+
+  std::vector<gde::geom::core::line_segment> segments;
+  std::vector<std::uint32_t> order;
+
+  prepare_ordered_segments(red_segments, blue_segments, segments, order);
+
+  gde::geom::core::rectangle rect = compute_rectangle(segments.begin(), segments.end());
+
+  quadtree_index tree;
+
+  build_quadtree_index(segments, order, leaf_capacity, rect.ll.x, rect.ur.x, rect.ll.y, rect.ur.y, tree);
+
+  quadtree_leaves_intersection_rb(segments, red_segments.size(), tree, sink);
+
+  return sink.count;
+}
@@ -0,0 +1,139 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/quadtree_intersection_rb_thread.cpp
+
+  \brief Adaptive quadtree intersection algorithm.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "count_then_fill.hpp"
+#include "intersection_core.hpp"
+#include "parallel_sort.hpp"
+#include "quadtree_index.hpp"
+#include "utils.hpp"
+#include "work_stealing_scheduler.hpp"
+
+// STL
+#include <algorithm>
+
+struct quadtree_scan
+{
+  std::size_t nred;
+  const std::vector<gde::geom::core::line_segment>* segments;
+  const gde::geom::algorithm::quadtree_index* tree;
+
+  template<class Sink>
+  void operator()(std::size_t leaf_first, std::size_t leaf_last, Sink& sink) const
+  {
+    for(std::size_t k = leaf_first; k != leaf_last; ++k)
+    {
+// only the points inside the leaf are reported
+      gde::geom::algorithm::quadtree_filter_sink<Sink> leaf_sink = { tree, k, &sink };
+
+      gde::geom::algorithm::x_order_rb_subset_intersection_core<gde::geom::algorithm::default_kernel,
+                                                                gde::geom::algorithm::y_interval_test>(*segments, nred,
+                                                                                                       tree->ids.data() + tree->offsets[k],
+                                                                                                       tree->ids.data() + tree->offsets[k + 1],
+                                                                                                       leaf_sink);
+    }
+  }
+};
+
+void
+gde::geom::algorithm::quadtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                      std::size_t nthreads, std::size_t leaf_capacity,
+                                                      std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  quadtree_intersection_rb_thread(red_segments, blue_segments, pool, leaf_capacity, intersection_pts);
+}
+
+void
+gde::geom::algorithm::quadtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                      thread_pool& pool, std::size_t leaf_capacity,
+                                                      std::vector<gde::geom::core::point>& intersection_pts)
+{
+  intersection_pts.clear();
+
+  if(red_segments.empty() || blue_segments.empty())
+    return;
+
+  std::vector<gde::geom::core::line_segment> segments;
+  std::vector<std::uint32_t> order;
+
+  prepare_ordered_segments(red_segments, blue_segments, pool, segments, order);
+
+  gde::geom::core::rectangle rect = compute_rectangle(segments.begin(), segments.end());
+
+// index red and blue segments in the same quadtree: each leaf keeps the left to right order
+  quadtree_index tree;
+
+  build_quadtree_index_thread(segments, order, pool, leaf_capacity, rect.ll.x, rect.ur.x, rect.ll.y, rect.ur.y, tree);
+
+  quadtree_scan scan = { red_segments.size(), &segments, &tree };
+
+// leaves are many and uneven: each one is a task
+  count_then_fill(pool, tree.cells.size(), scan, intersection_pts, 1);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::quadtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                            std::size_t nthreads, std::size_t leaf_capacity)
+{
+  thread_pool pool(nthreads);
+
+  return quadtree_intersection_rb_count_thread(red_segments, blue_segments, pool, leaf_capacity);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::quadtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                            thread_pool& pool, std::size_t leaf_capacity)
+{
+  if(red_segments.empty() || blue_segments.empty())
+    return intersection_count();
+
+  std::vector<gde::geom::core::line_segment> segments;
+  std::vector<std::uint32_t> order;
+
+  prepare_ordered_segments(red_segments, blue_segments, pool, segments, order);
+
+  gde::geom::core::rectangle rect = compute_rectangle(segments.begin(), segments.end());
+
+  quadtree_index tree;
+
+  build_quadtree_index_thread(segments, order, pool, leaf_capacity, rect.ll.x, rect.ur.x, rect.ll.y, rect.ur.y, tree);
+
+  quadtree_scan scan = { red_segments.size(), &segments, &tree };
+
+// leaves are many and uneven: schedule them one by one
+  return count_per_thread(pool, tree.cells.size(), scan, 1);
+}
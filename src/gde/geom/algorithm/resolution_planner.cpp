@@ -0,0 +1,564 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/resolution_planner.cpp
+
+  \brief Planners that choose the cell size of the grid and tiling algorithms from a sample of their input.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "resolution_planner.hpp"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// relative costs of the basic operations of the joins, measured on the grid and tiling algorithms
+const double cost_grid_entry = 6.0;     // count and scatter a segment in a cell
+const double cost_grid_cell = 0.5;      // offset of an empty cell
+const double cost_grid_visit = 5.0;     // a red segment visiting a cell
+const double cost_pair_test = 1.0;      // a bounding box test
+const double cost_tile = 20.0;          // start the x-order scan of a tile
+const double cost_grid_miss = 0.5;      // the growth of the probes of the red segments each time the blue grid doubles past the cache
+
+// the size of the blue grid that the probes of the red segments in input order still find in cache
+const double grid_cache_bytes = 1024.0 * 1024.0;
+
+// bins of the coarse grid that estimates the density of the segments
+const std::size_t density_bins = 64;
+
+// the grids are kept below a few cells per segment
+const std::size_t max_cells_per_segment = 4;
+const std::size_t max_cells = std::size_t(1) << 26;
+
+// the extents of a sample of a set of segments and the density of their midpoints
+struct segment_sample
+{
+  std::size_t nsegments;
+  std::vector<double> ex;
+  std::vector<double> ey;
+  std::vector<double> density;
+};
+
+void
+sample_segments(const std::vector<gde::geom::core::line_segment>& segments,
+                std::size_t sample_size,
+                double xmin, double xmax, double ymin, double ymax,
+                segment_sample& sample)
+{
+  sample.nsegments = segments.size();
+
+  const std::size_t n = std::min(std::max(sample_size, std::size_t(1)), segments.size());
+
+  sample.ex.resize(n);
+  sample.ey.resize(n);
+  sample.density.assign(density_bins * density_bins, 0.0);
+
+  const double bin_dx = (xmax > xmin) ? (xmax - xmin) / static_cast<double>(density_bins) : 1.0;
+  const double bin_dy = (ymax > ymin) ? (ymax - ymin) / static_cast<double>(density_bins) : 1.0;
+
+// a regular stride over the input: an ordered input is sampled along its whole extent
+  const double stride = static_cast<double>(segments.size()) / static_cast<double>(n);
+
+  for(std::size_t k = 0; k != n; ++k)
+  {
+    const gde::geom::core::line_segment& s = segments[static_cast<std::size_t>(static_cast<double>(k) * stride)];
+
+    sample.ex[k] = std::abs(s.p2.x - s.p1.x);
+    sample.ey[k] = std::abs(s.p2.y - s.p1.y);
+
+    const double mx = 0.5 * (s.p1.x + s.p2.x);
+    const double my = 0.5 * (s.p1.y + s.p2.y);
+
+    std::size_t col = std::min(static_cast<std::size_t>(std::max(mx - xmin, 0.0) / bin_dx), density_bins - 1);
+    std::size_t row = std::min(static_cast<std::size_t>(std::max(my - ymin, 0.0) / bin_dy), density_bins - 1);
+
+    sample.density[row + col * density_bins] += 1.0;
+  }
+
+  for(std::size_t b = 0; b != sample.density.size(); ++b)
+    sample.density[b] /= static_cast<double>(std::max(n, std::size_t(1)));
+}
+
+// how many times the pairs of a cell exceed the ones of an uniform distribution:
+// 1 for uniform sets and up to the number of bins for sets packed in a single bin
+double
+density_correlation(const std::vector<double>& lhs, const std::vector<double>& rhs)
+{
+  double c = 0.0;
+
+  for(std::size_t b = 0; b != lhs.size(); ++b)
+    c += lhs[b] * rhs[b];
+
+  return c * static_cast<double>(lhs.size());
+}
+
+// the size of a cell that splits a range in n parts: the grid gets n columns or rows
+// (or n + 1 if the range is not a multiple of the cell size)
+double
+cell_size(double range, std::size_t n)
+{
+  if(range <= 0.0)
+    return 1.0;
+
+  return range / static_cast<double>(n);
+}
+
+// a candidate cell size along one axis and the number of cells crossed by each sampled segment
+struct axis_candidate
+{
+  double size;
+  std::size_t ncells;
+  std::vector<double> red_cells;
+  std::vector<double> blue_cells;
+};
+
+void
+crossed_cells(const std::vector<double>& extents, double size, std::size_t ncells,
+              std::vector<double>& cells)
+{
+  cells.resize(extents.size());
+
+  const double limit = static_cast<double>(ncells);
+
+// a tail of long segments is clamped to the grid instead of being averaged out
+  for(std::size_t k = 0; k != extents.size(); ++k)
+    cells[k] = std::min(extents[k] / size + 1.0, limit);
+}
+
+// the cell sizes along one axis: a geometric sequence of ratio sqrt(2) in the number of cells
+void
+axis_candidates(double range,
+                const std::vector<double>& red_extents,
+                const std::vector<double>& blue_extents,
+                std::size_t budget,
+                std::vector<axis_candidate>& candidates)
+{
+  for(std::size_t n = 1; n <= budget; n = std::max(n + 1, static_cast<std::size_t>(std::ceil(static_cast<double>(n) * 1.4142135623730951))))
+  {
+    axis_candidate c;
+
+    c.size = cell_size(range, n);
+    c.ncells = (range > 0.0) ? static_cast<std::size_t>(range / c.size) + 1 : 1;
+
+    crossed_cells(red_extents, c.size, c.ncells, c.red_cells);
+    crossed_cells(blue_extents, c.size, c.ncells, c.blue_cells);
+
+    candidates.push_back(c);
+  }
+}
+
+// the average number of cells crossed by the bounding box of the sampled segments
+double
+average_cover(const std::vector<double>& col_cells, const std::vector<double>& row_cells)
+{
+  if(col_cells.empty())
+    return 0.0;
+
+  double cover = 0.0;
+
+  for(std::size_t k = 0; k != col_cells.size(); ++k)
+    cover += col_cells[k] * row_cells[k];
+
+  return cover / static_cast<double>(col_cells.size());
+}
+
+// the average fraction of a tile of width dx spanned by the sampled segments
+double
+average_span(const std::vector<double>& extents, double dx)
+{
+  if(extents.empty())
+    return 0.0;
+
+  double span = 0.0;
+
+  for(std::size_t k = 0; k != extents.size(); ++k)
+    span += std::min(extents[k] / dx, 1.0);
+
+  return span / static_cast<double>(extents.size());
+}
+
+std::size_t
+cell_budget(const segment_sample& red, const segment_sample& blue)
+{
+  return std::max(std::size_t(1), std::min(max_cells, max_cells_per_segment * (red.nsegments + blue.nsegments)));
+}
+
+// the correlation of a set with itself: the pairs of a sampled segment with itself
+// are left out, they would make a small sample look clustered
+double
+self_correlation(const segment_sample& sample)
+{
+  const double n = static_cast<double>(sample.ex.size());
+
+  if(n < 2.0)
+    return 1.0;
+
+  double c = 0.0;
+
+  for(std::size_t b = 0; b != sample.density.size(); ++b)
+    c += sample.density[b] * sample.density[b];
+
+  return std::max((c - 1.0 / n) * n / (n - 1.0), 0.0) * static_cast<double>(sample.density.size());
+}
+
+// the correlation of the union of both sets with itself
+double
+union_correlation(const segment_sample& red, const segment_sample& blue)
+{
+  const double n = static_cast<double>(std::max(red.nsegments + blue.nsegments, std::size_t(1)));
+
+  const double wr = static_cast<double>(red.nsegments) / n;
+  const double wb = static_cast<double>(blue.nsegments) / n;
+
+  return wr * wr * self_correlation(red) + 2.0 * wr * wb * density_correlation(red.density, blue.density) + wb * wb * self_correlation(blue);
+}
+
+// the blue grid entries, the cells visited by the red segments and the pairs tested in them
+double
+grid_cost(const segment_sample& red, const segment_sample& blue, double correlation,
+          const axis_candidate& col, const axis_candidate& row)
+{
+  const double ncells = static_cast<double>(col.ncells) * static_cast<double>(row.ncells);
+
+  const double blue_entries = static_cast<double>(blue.nsegments) * average_cover(col.blue_cells, row.blue_cells);
+  const double red_visits = static_cast<double>(red.nsegments) * average_cover(col.red_cells, row.red_cells);
+
+  const double pairs = red_visits * blue_entries * correlation / ncells;
+
+// the red segments probe the cells in no particular order: a grid that does not fit in cache misses on most of them
+  const double grid_bytes = static_cast<double>(sizeof(std::size_t)) * (blue_entries + ncells);
+
+  const double misses = 1.0 + cost_grid_miss * std::log2(std::max(grid_bytes / grid_cache_bytes, 1.0));
+
+  return cost_grid_entry * blue_entries + cost_grid_cell * ncells + misses * (cost_grid_visit * red_visits + cost_pair_test * pairs);
+}
+
+// the entries of both sets and the length of the x-order scan of the tiles
+double
+tiling_cost(const segment_sample& red, const segment_sample& blue, double correlation,
+            const axis_candidate& col, const axis_candidate& row, double tile_width)
+{
+  const double ncells = static_cast<double>(col.ncells) * static_cast<double>(row.ncells);
+
+  const double red_entries = static_cast<double>(red.nsegments) * average_cover(col.red_cells, row.red_cells);
+  const double blue_entries = static_cast<double>(blue.nsegments) * average_cover(col.blue_cells, row.blue_cells);
+  const double entries = red_entries + blue_entries;
+
+// the scan of a segment walks over the segments of the tile that start before its end
+  const double span = (red_entries * average_span(red.ex, tile_width) + blue_entries * average_span(blue.ex, tile_width)) / std::max(entries, 1.0);
+
+  const double walk = entries * entries * correlation * span / ncells;
+
+  return cost_grid_entry * entries + cost_tile * ncells + cost_pair_test * walk;
+}
+
+struct grid_cost_model
+{
+  const segment_sample* red;
+  const segment_sample* blue;
+  double correlation;
+
+  double operator()(const axis_candidate& col, const axis_candidate& row) const
+  {
+    return grid_cost(*red, *blue, correlation, col, row);
+  }
+};
+
+struct tiling_cost_model
+{
+  const segment_sample* red;
+  const segment_sample* blue;
+  double correlation;
+
+  double operator()(const axis_candidate& col, const axis_candidate& row) const
+  {
+    return tiling_cost(*red, *blue, correlation, col, row, col.size);
+  }
+};
+
+// the average extent of the sampled segments of both sets along one axis
+double
+average_extent(const std::vector<double>& red_extents, const std::vector<double>& blue_extents)
+{
+  double extent = 0.0;
+
+  for(double e : red_extents)
+    extent += e;
+
+  for(double e : blue_extents)
+    extent += e;
+
+  return extent / static_cast<double>(std::max(red_extents.size() + blue_extents.size(), std::size_t(1)));
+}
+
+// the candidate grid with the lowest cost: the cells with the shape of the average segment are tried
+// for each number of columns, then the best one moves to a neighbour candidate while it lowers the cost
+template<class CostModel>
+gde::geom::algorithm::resolution_plan
+search_candidates(const std::vector<axis_candidate>& cols,
+                  const std::vector<axis_candidate>& rows,
+                  std::size_t budget, double aspect,
+                  const CostModel& cost_model)
+{
+  const double no_cost = std::numeric_limits<double>::max();
+
+  std::vector<double> costs(cols.size() * rows.size(), -1.0);
+
+  auto cost = [&](std::size_t i, std::size_t j)
+              {
+                double& c = costs[i * rows.size() + j];
+
+                if(c < 0.0)
+                  c = (cols[i].ncells * rows[j].ncells > budget) ? no_cost : cost_model(cols[i], rows[j]);
+
+                return c;
+              };
+
+  std::size_t best_i = 0;
+  std::size_t best_j = 0;
+
+  for(std::size_t i = 0; i != cols.size(); ++i)
+  {
+// the rows whose height is the closest to the width of the columns over the aspect of the segments
+    const double height = cols[i].size / aspect;
+
+    std::size_t j = 0;
+
+    while((j + 1 < rows.size()) && (std::abs(std::log(rows[j + 1].size / height)) < std::abs(std::log(rows[j].size / height))))
+      ++j;
+
+    if(cost(i, j) < cost(best_i, best_j))
+    {
+      best_i = i;
+      best_j = j;
+    }
+  }
+
+  for(bool moved = true; moved; )
+  {
+    moved = false;
+
+    const std::size_t i = best_i;
+    const std::size_t j = best_j;
+
+    for(std::size_t ni = (i == 0 ? 0 : i - 1); (ni <= i + 1) && (ni < cols.size()); ++ni)
+    {
+      for(std::size_t nj = (j == 0 ? 0 : j - 1); (nj <= j + 1) && (nj < rows.size()); ++nj)
+      {
+        if(cost(ni, nj) < cost(best_i, best_j))
+        {
+          best_i = ni;
+          best_j = nj;
+          moved = true;
+        }
+      }
+    }
+  }
+
+  gde::geom::algorithm::resolution_plan plan = { cols[best_i].size, rows[best_j].size, cols[best_i].ncells, rows[best_j].ncells, cost(best_i, best_j) };
+
+  return plan;
+}
+
+// the width over the height of the cells with the shape of the average segment
+double
+segment_aspect(const segment_sample& red, const segment_sample& blue)
+{
+  const double ex = average_extent(red.ex, blue.ex);
+  const double ey = average_extent(red.ey, blue.ey);
+
+  if((ex <= 0.0) || (ey <= 0.0))
+    return 1.0;
+
+  return ex / ey;
+}
+
+gde::geom::algorithm::resolution_plan
+gde::geom::algorithm::plan_fixed_grid_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                 const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                 double xmin, double xmax, double ymin, double ymax,
+                                                 std::size_t sample_size)
+{
+  segment_sample red;
+  segment_sample blue;
+
+  sample_segments(red_segments, sample_size, xmin, xmax, ymin, ymax, red);
+  sample_segments(blue_segments, sample_size, xmin, xmax, ymin, ymax, blue);
+
+  const double correlation = density_correlation(red.density, blue.density);
+
+  const std::size_t budget = cell_budget(red, blue);
+
+  std::vector<axis_candidate> cols;
+  std::vector<axis_candidate> rows;
+
+  axis_candidates(xmax - xmin, red.ex, blue.ex, budget, cols);
+  axis_candidates(ymax - ymin, red.ey, blue.ey, budget, rows);
+
+  grid_cost_model cost_model = { &red, &blue, correlation };
+
+  return search_candidates(cols, rows, budget, segment_aspect(red, blue), cost_model);
+}
+
+gde::geom::algorithm::resolution_plan
+gde::geom::algorithm::plan_tiling_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                             double xmin, double xmax, double ymin, double ymax,
+                                             std::size_t sample_size)
+{
+  segment_sample red;
+  segment_sample blue;
+
+  sample_segments(red_segments, sample_size, xmin, xmax, ymin, ymax, red);
+  sample_segments(blue_segments, sample_size, xmin, xmax, ymin, ymax, blue);
+
+  const double correlation = union_correlation(red, blue);
+
+  const std::size_t budget = cell_budget(red, blue);
+
+  std::vector<axis_candidate> cols;
+  std::vector<axis_candidate> rows;
+
+  axis_candidates(xmax - xmin, red.ex, blue.ex, budget, cols);
+  axis_candidates(ymax - ymin, red.ey, blue.ey, budget, rows);
+
+  tiling_cost_model cost_model = { &red, &blue, correlation };
+
+  return search_candidates(cols, rows, budget, segment_aspect(red, blue), cost_model);
+}
+
+gde::geom::algorithm::resolution_plan
+gde::geom::algorithm::plan_tile_height(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                       const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                       double ymin, double ymax,
+                                       std::size_t sample_size)
+{
+// the tiles span the x range of both sets
+  double xmin = std::numeric_limits<double>::max();
+  double xmax = -std::numeric_limits<double>::max();
+
+  for(const gde::geom::core::line_segment& s : red_segments)
+  {
+    xmin = std::min(xmin, std::min(s.p1.x, s.p2.x));
+    xmax = std::max(xmax, std::max(s.p1.x, s.p2.x));
+  }
+
+  for(const gde::geom::core::line_segment& s : blue_segments)
+  {
+    xmin = std::min(xmin, std::min(s.p1.x, s.p2.x));
+    xmax = std::max(xmax, std::max(s.p1.x, s.p2.x));
+  }
+
+  if(xmax < xmin)
+    xmin = xmax = 0.0;
+
+  segment_sample red;
+  segment_sample blue;
+
+  sample_segments(red_segments, sample_size, xmin, xmax, ymin, ymax, red);
+  sample_segments(blue_segments, sample_size, xmin, xmax, ymin, ymax, blue);
+
+  const double correlation = union_correlation(red, blue);
+
+  const std::size_t budget = cell_budget(red, blue);
+
+// a single column: each segment crosses it once
+  axis_candidate col;
+
+  col.size = (xmax > xmin) ? (xmax - xmin) : 1.0;
+  col.ncells = 1;
+  col.red_cells.assign(red.ex.size(), 1.0);
+  col.blue_cells.assign(blue.ex.size(), 1.0);
+
+  std::vector<axis_candidate> rows;
+
+  axis_candidates(ymax - ymin, red.ey, blue.ey, budget, rows);
+
+  resolution_plan best = { std::numeric_limits<double>::infinity(), rows.front().size, 1, rows.front().ncells, std::numeric_limits<double>::max() };
+
+  for(const axis_candidate& row : rows)
+  {
+    const double cost = tiling_cost(red, blue, correlation, col, row, col.size);
+
+    if(cost < best.cost)
+    {
+      resolution_plan plan = { std::numeric_limits<double>::infinity(), row.size, 1, row.ncells, cost };
+
+      best = plan;
+    }
+  }
+
+  return best;
+}
+
+void
+gde::geom::algorithm::resolve_fixed_grid_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    double xmin, double xmax, double ymin, double ymax,
+                                                    double& dx, double& dy)
+{
+  if((dx != auto_resolution) && (dy != auto_resolution))
+    return;
+
+  resolution_plan plan = plan_fixed_grid_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax);
+
+  if(dx == auto_resolution)
+    dx = plan.dx;
+
+  if(dy == auto_resolution)
+    dy = plan.dy;
+}
+
+void
+gde::geom::algorithm::resolve_tiling_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                double xmin, double xmax, double ymin, double ymax,
+                                                double& dx, double& dy)
+{
+  if((dx != auto_resolution) && (dy != auto_resolution))
+    return;
+
+  resolution_plan plan = plan_tiling_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax);
+
+  if(dx == auto_resolution)
+    dx = plan.dx;
+
+  if(dy == auto_resolution)
+    dy = plan.dy;
+}
+
+void
+gde::geom::algorithm::resolve_tile_height(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                          double ymin, double ymax,
+                                          double& dy)
+{
+  if(dy != auto_resolution)
+    return;
+
+  dy = plan_tile_height(red_segments, blue_segments, ymin, ymax).dy;
+}
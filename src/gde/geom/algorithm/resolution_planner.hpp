@@ -0,0 +1,136 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/resolution_planner.hpp
+
+  \brief Planners that choose the cell size of the grid and tiling algorithms from a sample of their input.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+#ifndef __GDE_GEOM_ALGORITHM_RESOLUTION_PLANNER_HPP__
+#define __GDE_GEOM_ALGORITHM_RESOLUTION_PLANNER_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+
+// STL
+#include <cstddef>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \brief A cell size that asks the fixed grid and tiling algorithms to choose it themselves.
+
+        Pass it as dx or dy: the algorithm replaces it with the size chosen by its planner.
+       */
+      const double auto_resolution = 0.0;
+
+      /*! \brief The default number of segments of each set sampled by the planners. */
+      const std::size_t planner_sample_size = 1024;
+
+      /*!
+        \struct resolution_plan
+
+        \brief The cell size chosen by a planner, the shape of the resulting grid and its estimated cost.
+       */
+      struct resolution_plan
+      {
+        double dx;
+        double dy;
+        std::size_t ncols;
+        std::size_t nrows;
+        double cost;         //!< Estimated cost of the join, in units of one bounding box test.
+      };
+
+      /*!
+        \brief Choose the cell size of fixed_grid_intersection_rb for the given segments and extent.
+
+        A sample of each set gives the bounding box extent of its segments and the density of
+        its midpoints on a coarse grid. For each candidate grid, the model estimates the entries
+        of the blue grid, the cells visited by the red segments and the pairs tested in them, and
+        the grid with the lowest cost is chosen.
+
+        The extents of each sampled segment are used as they are, clamped to the grid: a tail of
+        long segments raises the number of entries of small cells instead of being averaged out.
+       */
+      resolution_plan
+      plan_fixed_grid_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                 const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                 double xmin, double xmax, double ymin, double ymax,
+                                 std::size_t sample_size = planner_sample_size);
+
+      /*!
+        \brief Choose the tile size of the two-dimensional tiling_intersection_rb for the given segments and extent.
+
+        The model is the one of plan_fixed_grid_resolution, but both sets are indexed
+        and the cost of a tile is the length of the x-order scan over its segments.
+       */
+      resolution_plan
+      plan_tiling_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                             double xmin, double xmax, double ymin, double ymax,
+                             std::size_t sample_size = planner_sample_size);
+
+      /*!
+        \brief Choose the tile height of the one-dimensional tiling_intersection_rb for the given segments and range.
+
+        The tiles span the whole x range of the segments: the plan has a single column of infinite width.
+       */
+      resolution_plan
+      plan_tile_height(const std::vector<gde::geom::core::line_segment>& red_segments,
+                       const std::vector<gde::geom::core::line_segment>& blue_segments,
+                       double ymin, double ymax,
+                       std::size_t sample_size = planner_sample_size);
+
+      /*! \brief Replace dx or dy by the one of plan_fixed_grid_resolution if it is auto_resolution. */
+      void
+      resolve_fixed_grid_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                    double xmin, double xmax, double ymin, double ymax,
+                                    double& dx, double& dy);
+
+      /*! \brief Replace dx or dy by the one of plan_tiling_resolution if it is auto_resolution. */
+      void
+      resolve_tiling_resolution(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                double xmin, double xmax, double ymin, double ymax,
+                                double& dx, double& dy);
+
+      /*! \brief Replace dy by the one of plan_tile_height if it is auto_resolution. */
+      void
+      resolve_tile_height(const std::vector<gde::geom::core::line_segment>& red_segments,
+                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                          double ymin, double ymax,
+                          double& dy);
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_RESOLUTION_PLANNER_HPP__
@@ -0,0 +1,297 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/robust_predicates.cpp
+
+  \brief Adaptive robust orientation predicate.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "robust_predicates.hpp"
+
+// STL
+#include <cmath>
+#include <cstddef>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+// half of the machine epsilon and the constant used to split a double in two halves
+      const double expansion_epsilon = 1.1102230246251565e-16;
+      const double expansion_splitter = 134217729.0;
+
+// error bounds of the adaptive stages of orient2d
+      const double orient2d_error_bound_b = (2.0 + 12.0 * expansion_epsilon) * expansion_epsilon;
+      const double orient2d_error_bound_c = (9.0 + 64.0 * expansion_epsilon) * expansion_epsilon * expansion_epsilon;
+      const double expansion_result_error_bound = (3.0 + 8.0 * expansion_epsilon) * expansion_epsilon;
+
+// x + y = a + b exactly, with |a| >= |b|
+      inline void expansion_fast_two_sum(double a, double b, double& x, double& y)
+      {
+        x = a + b;
+        double bvirt = x - a;
+        y = b - bvirt;
+      }
+
+// x + y = a + b exactly
+      inline void expansion_two_sum(double a, double b, double& x, double& y)
+      {
+        x = a + b;
+        double bvirt = x - a;
+        double avirt = x - bvirt;
+        double bround = b - bvirt;
+        double around = a - avirt;
+        y = around + bround;
+      }
+
+// the round-off error y of x = a - b
+      inline void expansion_two_diff_tail(double a, double b, double x, double& y)
+      {
+        double bvirt = a - x;
+        double avirt = x + bvirt;
+        double bround = bvirt - b;
+        double around = a - avirt;
+        y = around + bround;
+      }
+
+// x + y = a - b exactly
+      inline void expansion_two_diff(double a, double b, double& x, double& y)
+      {
+        x = a - b;
+        expansion_two_diff_tail(a, b, x, y);
+      }
+
+// split a in two non-overlapping halves of 26 bits
+      inline void expansion_split(double a, double& ahi, double& alo)
+      {
+        double c = expansion_splitter * a;
+        double abig = c - a;
+        ahi = c - abig;
+        alo = a - ahi;
+      }
+
+// x + y = a * b exactly
+      inline void expansion_two_product(double a, double b, double& x, double& y)
+      {
+        x = a * b;
+
+        double ahi, alo, bhi, blo;
+        expansion_split(a, ahi, alo);
+        expansion_split(b, bhi, blo);
+
+        double err1 = x - (ahi * bhi);
+        double err2 = err1 - (alo * bhi);
+        double err3 = err2 - (ahi * blo);
+        y = (alo * blo) - err3;
+      }
+
+// x[3] + x[2] + x[1] + x[0] = (a1 + a0) - (b1 + b0) exactly
+      inline void expansion_two_two_diff(double a1, double a0, double b1, double b0, double x[4])
+      {
+        double i, j, k;
+
+// (a1 + a0) - b0
+        expansion_two_diff(a0, b0, i, x[0]);
+        expansion_two_sum(a1, i, j, k);
+
+// (j + k) - b1
+        double l;
+        expansion_two_diff(k, b1, l, x[1]);
+        expansion_two_sum(j, l, x[3], x[2]);
+      }
+
+// h = e + f, eliminating zero components: h must have room for elen + flen components
+      std::size_t expansion_sum(std::size_t elen, const double* e,
+                                std::size_t flen, const double* f,
+                                double* h)
+      {
+        std::size_t eindex = 0;
+        std::size_t findex = 0;
+        std::size_t hindex = 0;
+
+        double enow = e[0];
+        double fnow = f[0];
+
+        double q, qnew, hh;
+
+// take the component with the smallest magnitude first
+        if((fnow > enow) == (fnow > -enow))
+        {
+          q = enow;
+          ++eindex;
+        }
+        else
+        {
+          q = fnow;
+          ++findex;
+        }
+
+        if((eindex < elen) && (findex < flen))
+        {
+          enow = e[eindex];
+          fnow = f[findex];
+
+          if((fnow > enow) == (fnow > -enow))
+          {
+            expansion_fast_two_sum(enow, q, qnew, hh);
+            ++eindex;
+          }
+          else
+          {
+            expansion_fast_two_sum(fnow, q, qnew, hh);
+            ++findex;
+          }
+
+          q = qnew;
+
+          if(hh != 0.0)
+            h[hindex++] = hh;
+
+          while((eindex < elen) && (findex < flen))
+          {
+            enow = e[eindex];
+            fnow = f[findex];
+
+            if((fnow > enow) == (fnow > -enow))
+            {
+              expansion_two_sum(q, enow, qnew, hh);
+              ++eindex;
+            }
+            else
+            {
+              expansion_two_sum(q, fnow, qnew, hh);
+              ++findex;
+            }
+
+            q = qnew;
+
+            if(hh != 0.0)
+              h[hindex++] = hh;
+          }
+        }
+
+        for(; eindex < elen; ++eindex)
+        {
+          expansion_two_sum(q, e[eindex], qnew, hh);
+
+          q = qnew;
+
+          if(hh != 0.0)
+            h[hindex++] = hh;
+        }
+
+        for(; findex < flen; ++findex)
+        {
+          expansion_two_sum(q, f[findex], qnew, hh);
+
+          q = qnew;
+
+          if(hh != 0.0)
+            h[hindex++] = hh;
+        }
+
+        if((q != 0.0) || (hindex == 0))
+          h[hindex++] = q;
+
+        return hindex;
+      }
+    }
+  }
+}
+
+double
+gde::geom::algorithm::orient2d_adapt(const gde::geom::core::point& a,
+                                     const gde::geom::core::point& b,
+                                     const gde::geom::core::point& c,
+                                     double detsum)
+{
+  double acx = a.x - c.x;
+  double bcx = b.x - c.x;
+  double acy = a.y - c.y;
+  double bcy = b.y - c.y;
+
+// stage B: the exact determinant of the rounded differences
+  double detleft, detlefttail;
+  double detright, detrighttail;
+
+  expansion_two_product(acx, bcy, detleft, detlefttail);
+  expansion_two_product(acy, bcx, detright, detrighttail);
+
+  double B[4];
+  expansion_two_two_diff(detleft, detlefttail, detright, detrighttail, B);
+
+  double det = B[0] + B[1] + B[2] + B[3];
+  double errbound = orient2d_error_bound_b * detsum;
+
+  if((det >= errbound) || (-det >= errbound))
+    return det;
+
+// if the differences are exact, B is the exact determinant
+  double acxtail, bcxtail, acytail, bcytail;
+
+  expansion_two_diff_tail(a.x, c.x, acx, acxtail);
+  expansion_two_diff_tail(b.x, c.x, bcx, bcxtail);
+  expansion_two_diff_tail(a.y, c.y, acy, acytail);
+  expansion_two_diff_tail(b.y, c.y, bcy, bcytail);
+
+  if((acxtail == 0.0) && (acytail == 0.0) && (bcxtail == 0.0) && (bcytail == 0.0))
+    return det;
+
+// stage C: first order correction with the round-off of the differences
+  errbound = orient2d_error_bound_c * detsum + expansion_result_error_bound * std::fabs(det);
+
+  det += (acx * bcytail + bcy * acxtail) - (acy * bcxtail + bcx * acytail);
+
+  if((det >= errbound) || (-det >= errbound))
+    return det;
+
+// stage D: the exact determinant
+  double s1, s0, t1, t0;
+  double u[4];
+
+  double C1[8];
+  expansion_two_product(acxtail, bcy, s1, s0);
+  expansion_two_product(acytail, bcx, t1, t0);
+  expansion_two_two_diff(s1, s0, t1, t0, u);
+  std::size_t c1length = expansion_sum(4, B, 4, u, C1);
+
+  double C2[12];
+  expansion_two_product(acx, bcytail, s1, s0);
+  expansion_two_product(acy, bcxtail, t1, t0);
+  expansion_two_two_diff(s1, s0, t1, t0, u);
+  std::size_t c2length = expansion_sum(c1length, C1, 4, u, C2);
+
+  double D[16];
+  expansion_two_product(acxtail, bcytail, s1, s0);
+  expansion_two_product(acytail, bcxtail, t1, t0);
+  expansion_two_two_diff(s1, s0, t1, t0, u);
+  std::size_t dlength = expansion_sum(c2length, C2, 4, u, D);
+
+// the largest component has the sign of the expansion
+  return D[dlength - 1];
+}
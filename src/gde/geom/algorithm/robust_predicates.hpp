@@ -0,0 +1,125 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/robust_predicates.hpp
+
+  \brief Adaptive robust orientation predicate.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+#ifndef __GDE_GEOM_ALGORITHM_ROBUST_PREDICATES_HPP__
+#define __GDE_GEOM_ALGORITHM_ROBUST_PREDICATES_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \brief The relative error bound of the floating-point orientation test (Shewchuk's ccwerrboundA).
+
+        If the absolute value of the computed determinant is at least this value times
+        the sum of the absolute values of its two products, the sign is correct.
+       */
+      const double orient2d_error_bound = (3.0 + 16.0 * 1.1102230246251565e-16) * 1.1102230246251565e-16;
+
+      /*!
+        \brief The adaptive stages of orient2d, for the cases the floating-point filter can not decide.
+
+        \param detsum The sum of the absolute values of the two products of the determinant.
+       */
+      double
+      orient2d_adapt(const gde::geom::core::point& a,
+                     const gde::geom::core::point& b,
+                     const gde::geom::core::point& c,
+                     double detsum);
+
+      /*!
+        \brief Robust orientation test: twice the signed area of the triangle (a, b, c).
+
+        The sign of the result is always exact. When an error bound proves the sign of the plain
+        floating-point computation, its value is returned. Otherwise, the determinant is refined
+        with expansion arithmetic until its sign is known.
+
+        \return A positive value if c is to the left of the directed line ab,
+                a negative value if it is to the right and zero if the three points are collinear.
+
+        \note Based on the adaptive predicates of Jonathan Richard Shewchuk (1997), "Adaptive Precision
+              Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+
+        \warning It requires IEEE 754 double precision arithmetic with round-to-nearest: do not compile it
+                 with -ffast-math or with x87 extended precision. The adaptive stages in robust_predicates.cpp
+                 also require that products and sums are not contracted into fused multiply-adds, which GCC
+                 does by default on targets with FMA (aarch64, or x86 with -march=haswell or later): the build
+                 compiles that file with -ffp-contract=off. The floating-point filter of this function does not need it, since
+                 a contraction only removes one of the roundings its error bound accounts for.
+       */
+      inline double
+      orient2d(const gde::geom::core::point& a,
+               const gde::geom::core::point& b,
+               const gde::geom::core::point& c)
+      {
+        double detleft = (a.x - c.x) * (b.y - c.y);
+        double detright = (a.y - c.y) * (b.x - c.x);
+        double det = detleft - detright;
+
+        double detsum = 0.0;
+
+// if the products have different signs, there is no cancellation
+        if(detleft > 0.0)
+        {
+          if(detright <= 0.0)
+            return det;
+
+          detsum = detleft + detright;
+        }
+        else if(detleft < 0.0)
+        {
+          if(detright >= 0.0)
+            return det;
+
+          detsum = -detleft - detright;
+        }
+        else
+        {
+          return det;
+        }
+
+        double errbound = orient2d_error_bound * detsum;
+
+        if((det >= errbound) || (-det >= errbound))
+          return det;
+
+        return orient2d_adapt(a, b, c, detsum);
+      }
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_ROBUST_PREDICATES_HPP__
@@ -0,0 +1,79 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/rtree_intersection_rb.cpp
+
+  \brief Packed R-tree intersection algorithm.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "intersection_core.hpp"
+#include "packed_rtree.hpp"
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::rtree_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                            const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                            std::size_t node_capacity)
+{
+  std::vector<gde::geom::core::point> ipts;
+
+  if(red_segments.empty() || blue_segments.empty())
+    return ipts;
+
+// index both sets: the leaf nodes of the red tree are the batches of red segments
+  packed_rtree red_tree;
+  packed_rtree blue_tree;
+
+  build_packed_rtree(red_segments, node_capacity, red_tree);
+  build_packed_rtree(blue_segments, node_capacity, blue_tree);
+
+  point_vector_sink sink = { &ipts };
+
+  rtree_intersection_core<default_kernel>(red_segments, red_tree, 0, red_tree.level_size(1), blue_segments, blue_tree, sink);
+
+  return ipts;
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::rtree_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                  std::size_t node_capacity)
+{
+  if(red_segments.empty() || blue_segments.empty())
+    return intersection_count();
+
+  packed_rtree red_tree;
+  packed_rtree blue_tree;
+
+  build_packed_rtree(red_segments, node_capacity, red_tree);
+  build_packed_rtree(blue_segments, node_capacity, blue_tree);
+
+  intersection_count_sink sink = {};
+
+  rtree_intersection_core<default_kernel>(red_segments, red_tree, 0, red_tree.level_size(1), blue_segments, blue_tree, sink);
+
+  return sink.count;
+}
@@ -0,0 +1,119 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/rtree_intersection_rb_thread.cpp
+
+  \brief Packed R-tree intersection algorithm.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "count_then_fill.hpp"
+#include "intersection_core.hpp"
+#include "packed_rtree.hpp"
+#include "work_stealing_scheduler.hpp"
+
+// STL
+#include <algorithm>
+
+struct rtree_scan
+{
+  const gde::geom::algorithm::packed_rtree* red_tree;
+  const gde::geom::algorithm::packed_rtree* blue_tree;
+  const std::vector<gde::geom::core::line_segment>* red_segments;
+  const std::vector<gde::geom::core::line_segment>* blue_segments;
+
+  template<class Sink>
+  void operator()(std::size_t first, std::size_t last, Sink& sink) const
+  {
+    gde::geom::algorithm::rtree_intersection_core<gde::geom::algorithm::default_kernel>(*red_segments, *red_tree, first, last,
+                                                                                        *blue_segments, *blue_tree, sink);
+  }
+};
+
+void
+gde::geom::algorithm::rtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                   std::size_t nthreads, std::size_t node_capacity,
+                                                   std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  rtree_intersection_rb_thread(red_segments, blue_segments, pool, node_capacity, intersection_pts);
+}
+
+void
+gde::geom::algorithm::rtree_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                   thread_pool& pool, std::size_t node_capacity,
+                                                   std::vector<gde::geom::core::point>& intersection_pts)
+{
+  intersection_pts.clear();
+
+  if(red_segments.empty() || blue_segments.empty())
+    return;
+
+  packed_rtree red_tree;
+  packed_rtree blue_tree;
+
+  build_packed_rtree_thread(red_segments, pool, node_capacity, red_tree);
+  build_packed_rtree_thread(blue_segments, pool, node_capacity, blue_tree);
+
+  rtree_scan scan = { &red_tree, &blue_tree, &red_segments, &blue_segments };
+
+// the units hold about as many red segments as the ones of the other algorithms
+  const std::size_t unit_size = std::max(count_then_fill_unit_size / red_tree.node_capacity, std::size_t(1));
+
+  count_then_fill(pool, red_tree.level_size(1), scan, intersection_pts, unit_size);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::rtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                         const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                         std::size_t nthreads, std::size_t node_capacity)
+{
+  thread_pool pool(nthreads);
+
+  return rtree_intersection_rb_count_thread(red_segments, blue_segments, pool, node_capacity);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::rtree_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                         const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                         thread_pool& pool, std::size_t node_capacity)
+{
+  if(red_segments.empty() || blue_segments.empty())
+    return intersection_count();
+
+  packed_rtree red_tree;
+  packed_rtree blue_tree;
+
+  build_packed_rtree_thread(red_segments, pool, node_capacity, red_tree);
+  build_packed_rtree_thread(blue_segments, pool, node_capacity, blue_tree);
+
+  rtree_scan scan = { &red_tree, &blue_tree, &red_segments, &blue_segments };
+
+  return count_per_thread(pool, red_tree.level_size(1), scan);
+}
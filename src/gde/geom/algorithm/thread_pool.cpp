@@ -0,0 +1,144 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/thread_pool.cpp
+
+  \brief A pool of persistent threads that can be reused by many algorithm calls.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "thread_pool.hpp"
+
+gde::geom::algorithm::thread_pool::thread_pool(std::size_t nthreads)
+  : task_(nullptr),
+    generation_(0),
+    pending_(0),
+    stop_(false)
+{
+// the calling thread is worker 0
+  for(std::size_t i = 1; i < nthreads; ++i)
+    threads_.push_back(std::thread(&thread_pool::work, this, i));
+}
+
+gde::geom::algorithm::thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+
+  start_cv_.notify_all();
+
+  for(std::size_t i = 0; i != threads_.size(); ++i)
+    threads_[i].join();
+}
+
+std::size_t
+gde::geom::algorithm::thread_pool::size() const
+{
+  return threads_.size() + 1;
+}
+
+void
+gde::geom::algorithm::thread_pool::run(const std::function<void(std::size_t)>& task)
+{
+  std::lock_guard<std::mutex> run_lock(run_mtx_);
+
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    task_ = &task;
+    error_ = nullptr;
+    pending_ = threads_.size();
+    ++generation_;
+  }
+
+  start_cv_.notify_all();
+
+  std::exception_ptr error;
+
+  try
+  {
+    task(0);
+  }
+  catch(...)
+  {
+    error = std::current_exception();
+  }
+
+// the other workers still use the task: wait for them even on error
+  std::unique_lock<std::mutex> lock(mtx_);
+
+  done_cv_.wait(lock, [this]{ return pending_ == 0; });
+
+  task_ = nullptr;
+
+  if(!error)
+    error = error_;
+
+  if(error)
+    std::rethrow_exception(error);
+}
+
+void
+gde::geom::algorithm::thread_pool::work(std::size_t thread_pos)
+{
+  std::size_t generation = 0;
+
+  while(true)
+  {
+    const std::function<void(std::size_t)>* task = nullptr;
+
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+
+      start_cv_.wait(lock, [this, generation]{ return stop_ || (generation_ != generation); });
+
+      if(stop_)
+        return;
+
+      generation = generation_;
+      task = task_;
+    }
+
+    std::exception_ptr error;
+
+    try
+    {
+      (*task)(thread_pos);
+    }
+    catch(...)
+    {
+      error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    if(error && !error_)
+      error_ = error;
+
+    if(--pending_ == 0)
+      done_cv_.notify_one();
+  }
+}
@@ -0,0 +1,106 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/thread_pool.hpp
+
+  \brief A pool of persistent threads that can be reused by many algorithm calls.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_THREAD_POOL_HPP__
+#define __GDE_GEOM_ALGORITHM_THREAD_POOL_HPP__
+
+// STL
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \class thread_pool
+
+        \brief A fixed number of threads created once and reused by every call to run.
+
+        The thread that calls run is one of the workers (thread number 0), so a pool
+        of size n keeps n - 1 threads waiting for work. Pass a pool to the threaded
+        algorithms to avoid creating threads on each call.
+
+        The nthreads overloads of the threaded algorithms create a pool of that size,
+        so nthreads = 0 works as nthreads = 1: the calling thread does all the work
+        and the outputs with one vector for each worker get a single vector.
+       */
+      class thread_pool
+      {
+        public:
+
+          /*! \brief Create a pool with nthreads workers: 0 gives a pool of one worker, as 1 does. */
+          explicit thread_pool(std::size_t nthreads);
+
+          /*! \brief Stop and join the threads of the pool. */
+          ~thread_pool();
+
+          thread_pool(const thread_pool&) = delete;
+
+          thread_pool& operator=(const thread_pool&) = delete;
+
+          /*! \brief The number of workers, including the calling thread. */
+          std::size_t size() const;
+
+          /*!
+            \brief Call task(thread_pos) on each worker and wait for all of them to finish.
+
+            Calls from different threads are serialized. A task must not call run on the
+            same pool. If a task throws, one of the exceptions is rethrown here.
+           */
+          void run(const std::function<void(std::size_t)>& task);
+
+        private:
+
+          void work(std::size_t thread_pos);
+
+          std::vector<std::thread> threads_;
+          std::mutex run_mtx_;
+          std::mutex mtx_;
+          std::condition_variable start_cv_;
+          std::condition_variable done_cv_;
+          const std::function<void(std::size_t)>* task_;
+          std::exception_ptr error_;
+          std::size_t generation_;
+          std::size_t pending_;
+          bool stop_;
+      };
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_THREAD_POOL_HPP__
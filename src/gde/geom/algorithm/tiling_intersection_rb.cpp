@@ -30,65 +30,142 @@
 // GDE
 #include "line_segments_intersection.hpp"
 #include "line_segment_intersection.hpp"
+#include "intersection_core.hpp"
+#include "grid_index.hpp"
+#include "resolution_planner.hpp"
 #include "utils.hpp"
 
 // STL
 #include <algorithm>
-#include <iterator>
+
+// compute intersections using x-order for each tile!
+template<class Sink>
+void
+tiling_cells_intersection_rb(const std::vector<gde::geom::core::line_segment>& segments,
+                             std::size_t nred,
+                             const gde::geom::algorithm::grid_index& tile_idx,
+                             Sink& sink)
+{
+  const std::size_t ncells = tile_idx.ncols * tile_idx.nrows;
+
+  for(std::size_t c = 0; c != ncells; ++c)
+  {
+// keep only the points inside the tile: this way a point in many tiles is reported once
+    gde::geom::algorithm::cell_filter_sink<Sink> tile_sink = { &tile_idx, c / tile_idx.nrows, c % tile_idx.nrows, &sink };
+
+    gde::geom::algorithm::x_order_rb_subset_intersection_core<gde::geom::algorithm::default_kernel,
+                                                              gde::geom::algorithm::y_interval_test>(segments, nred,
+                                                                                                     tile_idx.ids.data() + tile_idx.offsets[c],
+                                                                                                     tile_idx.ids.data() + tile_idx.offsets[c + 1],
+                                                                                                     tile_sink);
+  }
+}
+
+// index red and blue segments in the same tile-index: each tile keeps the left to right order
+void
+build_tiles(const std::vector<gde::geom::core::line_segment>& red_segments,
+            const std::vector<gde::geom::core::line_segment>& blue_segments,
+            double dy, double ymin, double ymax,
+            std::vector<gde::geom::core::line_segment>& segments,
+            gde::geom::algorithm::grid_index& tile_idx)
+{
+  gde::geom::algorithm::resolve_tile_height(red_segments, blue_segments, ymin, ymax, dy);
+
+  std::vector<std::uint32_t> order;
+
+  gde::geom::algorithm::prepare_ordered_segments(red_segments, blue_segments, segments, order);
+
+  gde::geom::algorithm::build_tile_index(segments, order, dy, ymin, ymax, tile_idx);
+}
+
+// index red and blue segments in the same grid: each tile keeps the left to right order
+void
+build_tiles(const std::vector<gde::geom::core::line_segment>& red_segments,
+            const std::vector<gde::geom::core::line_segment>& blue_segments,
+            double dx, double dy, double xmin, double xmax,
+            double ymin, double ymax,
+            std::vector<gde::geom::core::line_segment>& segments,
+            gde::geom::algorithm::grid_index& tile_idx)
+{
+  gde::geom::algorithm::resolve_tiling_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
+
+  std::vector<std::uint32_t> order;
+
+  gde::geom::algorithm::prepare_ordered_segments(red_segments, blue_segments, segments, order);
+
+  gde::geom::algorithm::build_grid_index(segments, order, dx, dy, xmin, xmax, ymin, ymax, tile_idx);
+}
 
 std::vector<gde::geom::core::point>
 gde::geom::algorithm::tiling_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
                                              const std::vector<gde::geom::core::line_segment>& blue_segments,
                                              double dy, double ymin, double ymax)
 {
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles(red_segments, blue_segments, dy, ymin, ymax, segments, tile_idx);
+
   std::vector<gde::geom::core::point> ipts;
-  
-  std::size_t nrows = std::ceil(((ymax - ymin) / dy));
-  
-// index red and blue segments in separated tile-index
-  std::vector<std::vector<gde::geom::core::line_segment> > red_tile_idx(nrows + 1);
-  std::vector<std::vector<gde::geom::core::line_segment> > blue_tile_idx(nrows + 1);
-  
-  for(const auto& red : red_segments)
-  {
-    std::size_t first_row = (red.p1.y - ymin) / dy;
-    std::size_t second_row = (red.p2.y - ymin) / dy;
-    
-    std::pair<std::size_t, std::size_t> min_max_row = std::minmax(first_row, second_row);
-    
-    for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
-    {
-      red_tile_idx[row].push_back(red);
-    }
-  }
-  
-  for(const auto& blue : blue_segments)
-  {
-    std::size_t first_row = (blue.p1.y - ymin) / dy;
-    std::size_t second_row = (blue.p2.y - ymin) / dy;
-    
-    std::pair<std::size_t, std::size_t> min_max_row = std::minmax(first_row, second_row);
-    
-    for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
-    {
-      blue_tile_idx[row].push_back(blue);
-    }
-  }
-  
-// compute intersections using x-order for each tile!
-  for(std::size_t i = 0; i <= nrows; ++i)
-  {
-    const std::vector<gde::geom::core::line_segment>& r_segs = red_tile_idx[i];
-    const std::vector<gde::geom::core::line_segment>& b_segs = blue_tile_idx[i];
-    
-    std::vector<gde::geom::core::point> ips = x_order_intersection_rb(r_segs, b_segs);
-    
-    std::copy_if(ips.begin(), ips.end(), std::back_inserter(ipts), [&i, &dy, &ymin]
-                                                                   (const gde::geom::core::point& ip)
-                                                                   { return is_in_tile(ymin, dy, i, ip.y); } );
-  }
-  
+
+  point_vector_sink sink = { &ipts };
+
+  tiling_cells_intersection_rb(segments, red_segments.size(), tile_idx, sink);
+
+  return ipts;
+}
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::tiling_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                             const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                             double dx, double dy, double xmin, double xmax,
+                                             double ymin, double ymax)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles(red_segments, blue_segments, dx, dy, xmin, xmax, ymin, ymax, segments, tile_idx);
+
+  std::vector<gde::geom::core::point> ipts;
+
+  point_vector_sink sink = { &ipts };
+
+  tiling_cells_intersection_rb(segments, red_segments.size(), tile_idx, sink);
+
   return ipts;
 }
 
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::tiling_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                   double dy, double ymin, double ymax)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles(red_segments, blue_segments, dy, ymin, ymax, segments, tile_idx);
+
+  intersection_count_sink sink = {};
+
+  tiling_cells_intersection_rb(segments, red_segments.size(), tile_idx, sink);
+
+  return sink.count;
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::tiling_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                   double dx, double dy, double xmin, double xmax,
+                                                   double ymin, double ymax)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles(red_segments, blue_segments, dx, dy, xmin, xmax, ymin, ymax, segments, tile_idx);
 
+  intersection_count_sink sink = {};
+
+  tiling_cells_intersection_rb(segments, red_segments.size(), tile_idx, sink);
+
+  return sink.count;
+}
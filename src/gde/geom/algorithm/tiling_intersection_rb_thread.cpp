@@ -29,71 +29,77 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
+#include "count_then_fill.hpp"
 #include "line_segment_intersection.hpp"
+#include "intersection_core.hpp"
+#include "grid_index.hpp"
+#include "resolution_planner.hpp"
+#include "parallel_sort.hpp"
 #include "utils.hpp"
+#include "work_stealing_scheduler.hpp"
 
 // STL
 #include <algorithm>
-#include <thread>
 
-struct tiling_computer
+struct tiling_scan
 {
-  const double dy;
-  const double ymin;
+  std::size_t nred;
   const std::vector<gde::geom::core::line_segment>* segments;
-  std::vector<std::vector<gde::geom::core::line_segment> >* tile_idx;
+  const gde::geom::algorithm::grid_index* tile_idx;
 
-  void operator()()
+  template<class Sink>
+  void operator()(std::size_t cell_first, std::size_t cell_last, Sink& sink) const
   {
-      for(const auto& seg : (*segments))
-      {
-        std::size_t first_row = (seg.p1.y - ymin) / dy;
-        std::size_t second_row = (seg.p2.y - ymin) / dy;
-
-        std::pair<std::size_t, std::size_t> min_max_row = std::minmax(first_row, second_row);
-
-        for(std::size_t row = min_max_row.first; row <= min_max_row.second; ++row)
-        {
-          (*tile_idx)[row].push_back(seg);
-        }
-      }
+    for(std::size_t c = cell_first; c != cell_last; ++c)
+    {
+// only the points inside the tile are reported
+      gde::geom::algorithm::cell_filter_sink<Sink> tile_sink = { tile_idx, c / tile_idx->nrows, c % tile_idx->nrows, &sink };
+
+      gde::geom::algorithm::x_order_rb_subset_intersection_core<gde::geom::algorithm::default_kernel,
+                                                                gde::geom::algorithm::y_interval_test>(*segments, nred,
+                                                                                                       tile_idx->ids.data() + tile_idx->offsets[c],
+                                                                                                       tile_idx->ids.data() + tile_idx->offsets[c + 1],
+                                                                                                       tile_sink);
+    }
   }
 };
 
-struct intersection_computer5
+// index red and blue segments in the same tile-index: each tile keeps the left to right order
+void
+build_tiles_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                   gde::geom::algorithm::thread_pool& pool,
+                   double dy, double ymin, double ymax,
+                   std::vector<gde::geom::core::line_segment>& segments,
+                   gde::geom::algorithm::grid_index& tile_idx)
 {
-  std::size_t thread_pos;
-  std::size_t nthread;
-  std::vector<gde::geom::core::point>* ipts;
-  const std::size_t nrows;
-  double dy;
-  double ymin;
-  const std::vector<std::vector<gde::geom::core::line_segment> >* red_tile_idx;
-  const std::vector<std::vector<gde::geom::core::line_segment> >* blue_tile_idx;
-
-  void operator()()
-  {
-      double dy;
-      double ymin;
+  gde::geom::algorithm::resolve_tile_height(red_segments, blue_segments, ymin, ymax, dy);
 
-      dy = this->dy;
-      ymin = this->ymin;
+  std::vector<std::uint32_t> order;
 
-// compute intersections using x-order for each tile!
-    for(std::size_t i = thread_pos; i <= nrows; i += nthread)
-    {
-      const std::vector<gde::geom::core::line_segment>& r_segs = (*red_tile_idx)[i];
-      const std::vector<gde::geom::core::line_segment>& b_segs = (*blue_tile_idx)[i];
+  gde::geom::algorithm::prepare_ordered_segments(red_segments, blue_segments, pool, segments, order);
 
-      std::vector<gde::geom::core::point> ips = gde::geom::algorithm::x_order_intersection_rb(r_segs , b_segs);
+  gde::geom::algorithm::build_tile_index_thread(segments, order, pool, dy, ymin, ymax, tile_idx);
+}
 
-      std::copy_if(ips.begin(), ips.end(), std::back_inserter(*ipts), [&i, &dy, &ymin]
-                                                                   (const gde::geom::core::point& ip)
-                                                                   { return gde::geom::algorithm::is_in_tile(ymin, dy, i, ip.y); } );
+// index red and blue segments in the same grid: each tile keeps the left to right order
+void
+build_tiles_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                   gde::geom::algorithm::thread_pool& pool,
+                   double dx, double dy, double xmin, double xmax,
+                   double ymin, double ymax,
+                   std::vector<gde::geom::core::line_segment>& segments,
+                   gde::geom::algorithm::grid_index& tile_idx)
+{
+  gde::geom::algorithm::resolve_tiling_resolution(red_segments, blue_segments, xmin, xmax, ymin, ymax, dx, dy);
 
-    }
-  }
-};
+  std::vector<std::uint32_t> order;
+
+  gde::geom::algorithm::prepare_ordered_segments(red_segments, blue_segments, pool, segments, order);
+
+  gde::geom::algorithm::build_grid_index_thread(segments, order, pool, dx, dy, xmin, xmax, ymin, ymax, tile_idx);
+}
 
 void
 gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
@@ -101,34 +107,177 @@ gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom:
                                                     std::size_t nthreads,double dy, double ymin, double ymax,
                                                     std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
 {
-  std::size_t nrows = std::ceil(((ymax - ymin) / dy));
+  thread_pool pool(nthreads);
+
+  tiling_intersection_rb_thread(red_segments, blue_segments, pool, dy, ymin, ymax, intersetion_pts);
+}
+
+void
+gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    thread_pool& pool,
+                                                    double dy, double ymin, double ymax,
+                                                    std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles_thread(red_segments, blue_segments, pool, dy, ymin, ymax, segments, tile_idx);
+
+  tiling_scan scan = { red_segments.size(), &segments, &tile_idx };
+
+// tiles are few and uneven: schedule them one by one
+  scan_per_thread(pool, tile_idx.ncols * tile_idx.nrows, scan, intersetion_pts, 1);
+}
+
+void
+gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    std::size_t nthreads,
+                                                    double dx, double dy, double xmin, double xmax,
+                                                    double ymin, double ymax,
+                                                    std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
+{
+  thread_pool pool(nthreads);
 
-// index red and blue segments in separated tile-index
-  std::vector<std::vector<gde::geom::core::line_segment> > red_tile_idx(nrows + 1);
-  std::vector<std::vector<gde::geom::core::line_segment> > blue_tile_idx(nrows + 1);
+  tiling_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, intersetion_pts);
+}
 
-  intersetion_pts.resize(nthreads);
+void
+gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    thread_pool& pool,
+                                                    double dx, double dy, double xmin, double xmax,
+                                                    double ymin, double ymax,
+                                                    std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
 
-  std::vector<std::thread> threads;
+  build_tiles_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, segments, tile_idx);
 
-  tiling_computer rt = {dy, ymin, &red_segments, &red_tile_idx};
-  threads.push_back(std::thread(rt));
+  tiling_scan scan = { red_segments.size(), &segments, &tile_idx };
 
-  tiling_computer bt = {dy, ymin, &blue_segments, &blue_tile_idx};
-  threads.push_back(std::thread(bt));
+// tiles are few and uneven: schedule them one by one
+  scan_per_thread(pool, tile_idx.ncols * tile_idx.nrows, scan, intersetion_pts, 1);
+}
 
-  for(std::size_t i = 0; i != 2; ++i)
-    threads[i].join();
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                          std::size_t nthreads,
+                                                          double dy, double ymin, double ymax)
+{
+  thread_pool pool(nthreads);
 
-  threads.clear();
+  return tiling_intersection_rb_count_thread(red_segments, blue_segments, pool, dy, ymin, ymax);
+}
 
-  for(std::size_t i = 0; i != nthreads; ++i)
-  {
-    intersection_computer5 ic = {i,nthreads ,&(intersetion_pts[i]),nrows, dy, ymin, &red_tile_idx, &blue_tile_idx};
-    threads.push_back(std::thread(ic));
-  }
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                          thread_pool& pool,
+                                                          double dy, double ymin, double ymax)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles_thread(red_segments, blue_segments, pool, dy, ymin, ymax, segments, tile_idx);
+
+  tiling_scan scan = { red_segments.size(), &segments, &tile_idx };
+
+// tiles are few and uneven: schedule them one by one
+  return count_per_thread(pool, tile_idx.ncols * tile_idx.nrows, scan, 1);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                          std::size_t nthreads,
+                                                          double dx, double dy, double xmin, double xmax,
+                                                          double ymin, double ymax)
+{
+  thread_pool pool(nthreads);
+
+  return tiling_intersection_rb_count_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::tiling_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                          const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                          thread_pool& pool,
+                                                          double dx, double dy, double xmin, double xmax,
+                                                          double ymin, double ymax)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, segments, tile_idx);
+
+  tiling_scan scan = { red_segments.size(), &segments, &tile_idx };
+
+// tiles are few and uneven: schedule them one by one
+  return count_per_thread(pool, tile_idx.ncols * tile_idx.nrows, scan, 1);
+}
+
+void
+gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    std::size_t nthreads,
+                                                    double dy, double ymin, double ymax,
+                                                    std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  tiling_intersection_rb_thread(red_segments, blue_segments, pool, dy, ymin, ymax, intersection_pts);
+}
+
+void
+gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    thread_pool& pool,
+                                                    double dy, double ymin, double ymax,
+                                                    std::vector<gde::geom::core::point>& intersection_pts)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles_thread(red_segments, blue_segments, pool, dy, ymin, ymax, segments, tile_idx);
+
+  tiling_scan scan = { red_segments.size(), &segments, &tile_idx };
+
+// tiles are few and uneven: each one is a unit of work
+  count_then_fill(pool, tile_idx.ncols * tile_idx.nrows, scan, intersection_pts, 1);
+}
+
+void
+gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    std::size_t nthreads,
+                                                    double dx, double dy, double xmin, double xmax,
+                                                    double ymin, double ymax,
+                                                    std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  tiling_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, intersection_pts);
+}
+
+void
+gde::geom::algorithm::tiling_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                    const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                    thread_pool& pool,
+                                                    double dx, double dy, double xmin, double xmax,
+                                                    double ymin, double ymax,
+                                                    std::vector<gde::geom::core::point>& intersection_pts)
+{
+  std::vector<gde::geom::core::line_segment> segments;
+  grid_index tile_idx;
+
+  build_tiles_thread(red_segments, blue_segments, pool, dx, dy, xmin, xmax, ymin, ymax, segments, tile_idx);
 
-  for(std::size_t i = 0; i != nthreads; ++i)
-    threads[i].join();
+  tiling_scan scan = { red_segments.size(), &segments, &tile_idx };
 
+// tiles are few and uneven: each one is a unit of work
+  count_then_fill(pool, tile_idx.ncols * tile_idx.nrows, scan, intersection_pts, 1);
 }
@@ -0,0 +1,489 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/trapezoid_sweep_intersection_rb.cpp
+
+  \brief Red-blue intersection by a lazy (trapezoid) plane-sweep.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "line_segments_intersection.hpp"
+#include "line_segment_intersection.hpp"
+#include "utils.hpp"
+
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <set>
+#include <unordered_set>
+
+/*!
+  \struct trapezoid_sweep_end_point
+
+  \brief An end-point of a segment in the event list.
+ */
+struct trapezoid_sweep_end_point
+{
+  gde::geom::core::point pt;
+  std::size_t id;
+  bool left;
+};
+
+/*!
+  \struct trapezoid_sweep_end_point_cmp
+
+  \brief Orders the end-points from left to right, and from bottom to top.
+ */
+struct trapezoid_sweep_end_point_cmp
+{
+  bool operator()(const trapezoid_sweep_end_point& lhs, const trapezoid_sweep_end_point& rhs) const
+  {
+    return gde::geom::algorithm::point_xy_cmp()(lhs.pt, rhs.pt);
+  }
+};
+
+/*!
+  \struct trapezoid_sweep_item
+
+  \brief An item of the mixed (red and blue) list of active segments.
+
+  Labels grow along the list so that the position of two items can be compared in constant time.
+ */
+struct trapezoid_sweep_item
+{
+  std::size_t id;
+  std::uint64_t label;
+};
+
+struct trapezoid_sweep;
+
+/*!
+  \struct trapezoid_sweep_cmp
+
+  \brief Orders the active segments of a single color from bottom to top at the current event point.
+ */
+struct trapezoid_sweep_cmp
+{
+  const trapezoid_sweep* sweep;
+
+  bool operator()(std::size_t a, std::size_t b) const;
+};
+
+/*!
+  \struct trapezoid_sweep
+
+  \brief The state of the red-blue sweep.
+
+  Segments of the same color never cross, so the active red segments and the active
+  blue segments can be kept in two balanced trees whose order never changes.
+
+  The mixed list has all active segments in the order they are crossed by a curve
+  that lags behind the sweep-line: only the part of the list around each event point
+  is brought up to date. Each pair of red and blue segments swapped in this update
+  crosses between the old curve and the event point, so the update costs
+  O(log n) plus the number of intersections reported.
+ */
+struct trapezoid_sweep
+{
+  typedef std::set<std::size_t, trapezoid_sweep_cmp> color_set;
+  typedef std::list<trapezoid_sweep_item> mixed_list;
+
+  std::vector<gde::geom::core::line_segment> segments;
+  std::size_t nred;
+  std::size_t probe;
+  gde::geom::core::point sweep_pt;
+  color_set colors[2];
+  std::vector<color_set::iterator> color_handles;
+  mixed_list items;
+  std::vector<mixed_list::iterator> item_handles;
+  std::vector<char> active;
+  std::unordered_set<std::uint64_t> overlaps;
+  std::vector<gde::geom::core::point>* ipts;        // null if only the points are counted
+  gde::geom::algorithm::intersection_count count;
+
+  trapezoid_sweep(const std::vector<gde::geom::core::line_segment>& red_segments,
+                  const std::vector<gde::geom::core::line_segment>& blue_segments,
+                  std::vector<gde::geom::core::point>* output)
+    : segments(red_segments.size() + blue_segments.size()),
+      nred(red_segments.size()),
+      probe(red_segments.size() + blue_segments.size()),
+      colors{color_set(trapezoid_sweep_cmp{this}), color_set(trapezoid_sweep_cmp{this})},
+      color_handles(probe),
+      item_handles(probe),
+      active(probe, 0),
+      ipts(output),
+      count()
+  {
+// copy the input segments and order each one of them from left to right
+    auto it = std::transform(red_segments.begin(), red_segments.end(), segments.begin(), gde::geom::algorithm::sort_segment_xy());
+    std::transform(blue_segments.begin(), blue_segments.end(), it, gde::geom::algorithm::sort_segment_xy());
+  }
+
+  std::size_t color(std::size_t s) const
+  {
+    return (s < nred) ? 0 : 1;
+  }
+
+// where is segment s relative to the event point?
+  gde::geom::algorithm::sweep_side_type side(std::size_t s) const
+  {
+    return gde::geom::algorithm::sweep_side(segments[s], sweep_pt);
+  }
+
+  void run()
+  {
+    std::vector<trapezoid_sweep_end_point> events;
+
+    events.reserve(2 * probe);
+
+    for(std::size_t i = 0; i != probe; ++i)
+    {
+      events.push_back(trapezoid_sweep_end_point{segments[i].p1, i, true});
+      events.push_back(trapezoid_sweep_end_point{segments[i].p2, i, false});
+    }
+
+    std::sort(events.begin(), events.end(), trapezoid_sweep_end_point_cmp());
+
+    std::vector<std::size_t> starting;
+    std::vector<std::size_t> ending;
+
+    std::size_t i = 0;
+
+    while(i != events.size())
+    {
+      sweep_pt = events[i].pt;
+
+      starting.clear();
+      ending.clear();
+
+      for(; (i != events.size()) && (events[i].pt == sweep_pt); ++i)
+      {
+        if(events[i].left)
+          starting.push_back(events[i].id);
+        else
+          ending.push_back(events[i].id);
+      }
+
+      handle_event(starting, ending);
+    }
+  }
+
+  void handle_event(const std::vector<std::size_t>& starting, const std::vector<std::size_t>& ending)
+  {
+// find the first segment not below the event point and the last one not above it:
+// only the segments between them in the mixed list may be out of order
+    mixed_list::iterator first = items.end();
+    mixed_list::iterator last = items.end();
+
+    for(std::size_t c = 0; c != 2; ++c)
+    {
+      color_set::iterator lo = colors[c].lower_bound(probe);
+
+      if((lo != colors[c].end()) &&
+         ((first == items.end()) || (item_handles[*lo]->label < first->label)))
+        first = item_handles[*lo];
+
+      color_set::iterator hi = colors[c].upper_bound(probe);
+
+      if(hi == colors[c].begin())
+        continue;
+
+      --hi;
+
+      if((last == items.end()) || (item_handles[*hi]->label > last->label))
+        last = item_handles[*hi];
+    }
+
+    std::vector<std::size_t> below;
+    std::vector<std::size_t> at;
+    std::vector<std::size_t> above;
+
+    std::vector<std::size_t> not_below[2];
+    std::vector<std::size_t> at_colors[2];
+    std::vector<std::size_t> above_colors[2];
+
+    mixed_list::iterator pos = first;
+
+    if((first != items.end()) && (last != items.end()) && (first->label <= last->label))
+    {
+      pos = std::next(last);
+
+// report the pairs of red and blue segments that are out of order
+      for(mixed_list::iterator it = first; it != pos; ++it)
+      {
+        std::size_t s = it->id;
+        std::size_t c = color(s);
+
+        switch(side(s))
+        {
+          case gde::geom::algorithm::SWEEP_BELOW:
+            for(std::size_t t : not_below[1 - c])
+              report(s, t);
+
+            below.push_back(s);
+          break;
+
+          case gde::geom::algorithm::SWEEP_AT:
+            for(std::size_t t : above_colors[1 - c])
+              report(s, t);
+
+            not_below[c].push_back(s);
+            at_colors[c].push_back(s);
+            at.push_back(s);
+          break;
+
+          case gde::geom::algorithm::SWEEP_ABOVE:
+            not_below[c].push_back(s);
+            above_colors[c].push_back(s);
+            above.push_back(s);
+          break;
+        }
+      }
+
+      items.erase(first, pos);
+    }
+
+// the segments starting at the event point
+    for(std::size_t s : starting)
+    {
+      at_colors[color(s)].push_back(s);
+
+      if(!(segments[s].p2 == sweep_pt))
+        at.push_back(s);
+    }
+
+// all red and blue segments through the event point intersect there
+    for(std::size_t r : at_colors[0])
+      for(std::size_t b : at_colors[1])
+        report(r, b);
+
+// remove the segments ending at the event point
+    for(std::size_t s : ending)
+    {
+      if(!active[s])
+        continue;
+
+      colors[color(s)].erase(color_handles[s]);
+      active[s] = 0;
+    }
+
+    at.erase(std::remove_if(at.begin(), at.end(), [this](std::size_t s) { return segments[s].p2 == sweep_pt; }), at.end());
+
+// and insert the ones starting there
+    for(std::size_t s : starting)
+    {
+      if(segments[s].p2 == sweep_pt)
+        continue;
+
+      color_handles[s] = colors[color(s)].insert(s).first;
+      active[s] = 1;
+    }
+
+// the segments through the event point continue ordered by their directions
+    std::sort(at.begin(), at.end(), [this](std::size_t a, std::size_t b) { return gde::geom::algorithm::below_after_sweep_pt(segments, a, b); });
+
+    std::vector<std::size_t> order(below);
+
+    order.insert(order.end(), at.begin(), at.end());
+    order.insert(order.end(), above.begin(), above.end());
+
+    insert_items(pos, order);
+  }
+
+// insert the segments in the mixed list before pos
+  void insert_items(mixed_list::iterator pos, const std::vector<std::size_t>& order)
+  {
+    if(order.empty())
+      return;
+
+// labels are in the range [1, 2^62)
+    std::uint64_t lo = (pos == items.begin()) ? 0 : std::prev(pos)->label;
+    std::uint64_t hi = (pos == items.end()) ? (std::uint64_t(1) << 62) : pos->label;
+
+    mixed_list::iterator first = items.end();
+
+    for(std::size_t s : order)
+    {
+      mixed_list::iterator it = items.insert(pos, trapezoid_sweep_item{s, 0});
+
+      item_handles[s] = it;
+
+      if(first == items.end())
+        first = it;
+    }
+
+    const std::uint64_t n = order.size();
+
+    if((hi - lo) > n)
+    {
+      const std::uint64_t step = (hi - lo) / (n + 1);
+
+      std::uint64_t label = lo;
+
+      for(mixed_list::iterator it = first; it != pos; ++it)
+      {
+        label += step;
+        it->label = label;
+      }
+
+      return;
+    }
+
+    relabel(first, pos, n, lo);
+  }
+
+// spread the labels in the smallest enclosing range that is not too dense
+  void relabel(mixed_list::iterator first, mixed_list::iterator last, std::uint64_t n, std::uint64_t anchor)
+  {
+    double max_count = 1.0;
+
+    for(unsigned int j = 1; j <= 62; ++j)
+    {
+      max_count *= (4.0 / 3.0);
+
+      const std::uint64_t size = std::uint64_t(1) << j;
+      const std::uint64_t base = anchor & ~(size - 1);
+
+      mixed_list::iterator begin = first;
+
+      std::uint64_t count = n;
+
+      while((begin != items.begin()) && (std::prev(begin)->label >= base))
+      {
+        --begin;
+        ++count;
+      }
+
+      mixed_list::iterator end = last;
+
+      while((end != items.end()) && (end->label < (base + size)))
+      {
+        ++end;
+        ++count;
+      }
+
+      if((j != 62) && (static_cast<double>(count) >= max_count))
+        continue;
+
+      const std::uint64_t step = size / (count + 1);
+
+      std::uint64_t label = base;
+
+      for(mixed_list::iterator it = begin; it != end; ++it)
+      {
+        label += step;
+        it->label = label;
+      }
+
+      return;
+    }
+  }
+
+// report the intersection point(s) between a red and a blue segment
+  void report(std::size_t a, std::size_t b)
+  {
+// keep the same argument order as the x-order algorithm
+    if(gde::geom::algorithm::line_segment_xy_cmp()(segments[b], segments[a]))
+      std::swap(a, b);
+
+    gde::geom::core::point ip1, ip2;
+
+    gde::geom::algorithm::segment_relation_type result = gde::geom::algorithm::DISJOINT;
+
+    if(gde::geom::algorithm::do_bounding_box_intersects_v2(segments[a], segments[b]))
+      result = gde::geom::algorithm::compute_intesection(segments[a], segments[b], ip1, ip2);
+
+    if(result == gde::geom::algorithm::DISJOINT)
+      return;
+
+// overlapping segments meet at more than one event point: report them once
+    if(result == gde::geom::algorithm::OVERLAP)
+    {
+      std::uint64_t key = static_cast<std::uint64_t>(std::min(a, b)) * probe + std::max(a, b);
+
+      if(!overlaps.insert(key).second)
+        return;
+    }
+
+    ++count.relations[result];
+
+    if(result == gde::geom::algorithm::OVERLAP)
+      ++count.relations[result];
+
+    if(ipts == nullptr)
+      return;
+
+    ipts->push_back(ip1);
+
+    if(result == gde::geom::algorithm::OVERLAP)
+      ipts->push_back(ip2);
+  }
+};
+
+bool
+trapezoid_sweep_cmp::operator()(std::size_t a, std::size_t b) const
+{
+// the probe stays between the segments below and the ones above the event point
+  if(a == sweep->probe)
+    return sweep->side(b) == gde::geom::algorithm::SWEEP_ABOVE;
+
+  if(b == sweep->probe)
+    return sweep->side(a) == gde::geom::algorithm::SWEEP_BELOW;
+
+// only a segment starting at the event point is compared to the others
+  return gde::geom::algorithm::sweep_status_less(sweep->segments, a, sweep->side(a), b, sweep->side(b));
+}
+
+std::vector<gde::geom::core::point>
+gde::geom::algorithm::trapezoid_sweep_intersection_rb(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                      const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+// output list of intersection points
+  std::vector<gde::geom::core::point> ipts;
+
+// check if we have at least two segments to test!
+  if(red_segments.empty() || blue_segments.empty())
+    return ipts;
+
+  trapezoid_sweep sweep(red_segments, blue_segments, &ipts);
+
+  sweep.run();
+
+  return ipts;
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::trapezoid_sweep_intersection_rb_count(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                            const std::vector<gde::geom::core::line_segment>& blue_segments)
+{
+  if(red_segments.empty() || blue_segments.empty())
+    return intersection_count();
+
+  trapezoid_sweep sweep(red_segments, blue_segments, nullptr);
+
+  sweep.run();
+
+  return sweep.count;
+}
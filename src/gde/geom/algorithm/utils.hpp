@@ -36,8 +36,14 @@
 // STL
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace gde
 {
@@ -45,6 +51,22 @@ namespace gde
   {
     namespace algorithm
     {
+      /*! \brief The largest number of segments of an index or of a sorted order: segment indexes are 32-bit. */
+      const std::size_t max_indexed_segments = std::numeric_limits<std::uint32_t>::max();
+
+      /*!
+        \brief Throws std::length_error if a set of segments is too large for 32-bit segment indexes.
+
+        \param nsegments The number of segments to index.
+        \param where     The name of the calling function, for the error message.
+       */
+      inline void
+      check_indexed_segments(std::size_t nsegments, const char* where)
+      {
+        if(nsegments > max_indexed_segments)
+          throw std::length_error(std::string(where) + ": more than 2^32 - 1 segments to index.");
+      }
+
       /*! \brief Test if values v1 and v2 have the same sign. */
       inline bool same_signs(double v1, double v2)
       {
@@ -133,6 +155,20 @@ namespace gde
         return true;
       }
 
+      /*!
+        \brief Orientation test: twice the signed area of the triangle (a, b, c).
+
+        \return A positive value if c is to the left of the directed line ab,
+                a negative value if it is to the right and zero if the three points are collinear.
+       */
+      inline double
+      orientation(const gde::geom::core::point& a,
+                  const gde::geom::core::point& b,
+                  const gde::geom::core::point& c)
+      {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+      }
+
       /*!
         \brief checks if the number is negative.
        */
@@ -224,6 +260,23 @@ namespace gde
         }
       };
       
+      /*!
+        \struct line_segment_id_xy_cmp
+       
+        A functor to compare two segments, given by their indexes, from left to right.
+       
+        \pre Both segments must be left-right ordered.
+       */
+      struct line_segment_id_xy_cmp
+      {
+        const std::vector<gde::geom::core::line_segment>* segments;
+        
+        bool operator()(std::uint32_t lhs, std::uint32_t rhs) const
+        {
+          return line_segment_xy_cmp()((*segments)[lhs], (*segments)[rhs]);
+        }
+      };
+      
       /*!
         \struct point_xy_cmp
        
@@ -275,6 +328,67 @@ namespace gde
           return s;
         }
       };
+
+      /*! \brief The position of a segment relative to the event point of a plane sweep. */
+      enum sweep_side_type
+      {
+        SWEEP_BELOW = -1,
+        SWEEP_AT = 0,
+        SWEEP_ABOVE = 1
+      };
+
+      /*! \brief Where is a segment, ordered from left to right, relative to the event point of a sweep? */
+      inline sweep_side_type
+      sweep_side(const gde::geom::core::line_segment& s, const gde::geom::core::point& sweep_pt)
+      {
+        double o = orientation(s.p1, s.p2, sweep_pt);
+
+        return (o > 0.0) ? SWEEP_BELOW : ((o < 0.0) ? SWEEP_ABOVE : SWEEP_AT);
+      }
+
+      /*!
+        \brief Is the direction of segment a clockwise to the direction of segment b?
+
+        It orders the segments through the event point of a sweep as they are just after it.
+        Segments with the same direction are ordered by their indexes.
+       */
+      inline bool
+      below_after_sweep_pt(const std::vector<gde::geom::core::line_segment>& segments,
+                           std::size_t a, std::size_t b)
+      {
+        const gde::geom::core::line_segment& sa = segments[a];
+        const gde::geom::core::line_segment& sb = segments[b];
+
+        double c = (sa.p2.x - sa.p1.x) * (sb.p2.y - sb.p1.y) - (sa.p2.y - sa.p1.y) * (sb.p2.x - sb.p1.x);
+
+        if(c != 0.0)
+          return c > 0.0;
+
+        return a < b;
+      }
+
+      /*!
+        \brief The bottom to top order of the status of a sweep at its event point.
+
+        The segments below the event point come first, then the ones through it
+        ordered by below_after_sweep_pt, and then the ones above it.
+
+        \param side_a The side of segment a given by sweep_side, or SWEEP_AT if it is known to pass through the event point.
+        \param side_b The same for segment b.
+       */
+      inline bool
+      sweep_status_less(const std::vector<gde::geom::core::line_segment>& segments,
+                        std::size_t a, sweep_side_type side_a,
+                        std::size_t b, sweep_side_type side_b)
+      {
+        if(side_a != side_b)
+          return side_a < side_b;
+
+        if(side_a == SWEEP_AT)
+          return below_after_sweep_pt(segments, a, b);
+
+        return a < b;
+      }
       
       template<class ForwardIt> inline
       gde::geom::core::rectangle
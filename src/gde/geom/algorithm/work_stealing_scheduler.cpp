@@ -0,0 +1,121 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/work_stealing_scheduler.cpp
+
+  \brief A work-stealing scheduler for loops over a range of indexes.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "work_stealing_scheduler.hpp"
+
+// STL
+#include <algorithm>
+
+gde::geom::algorithm::work_stealing_scheduler::work_stealing_scheduler(std::size_t first, std::size_t last,
+                                                                        std::size_t nworkers, std::size_t grain)
+  : ranges_(std::max<std::size_t>(nworkers, 1)),
+    grain_(grain)
+{
+  const std::size_t n = (last > first) ? (last - first) : 0;
+
+  const std::size_t nranges = ranges_.size();
+
+// about 64 chunks for each worker
+  if(grain_ == 0)
+    grain_ = std::max<std::size_t>(1, n / (nranges * 64));
+
+// each worker starts with a contiguous share of the range
+  for(std::size_t i = 0; i != nranges; ++i)
+  {
+    ranges_[i].begin = first + (n * i) / nranges;
+    ranges_[i].end = first + (n * (i + 1)) / nranges;
+  }
+}
+
+bool
+gde::geom::algorithm::work_stealing_scheduler::next(std::size_t worker, std::size_t& begin, std::size_t& end)
+{
+  worker_range& mine = ranges_[worker];
+
+  {
+    std::lock_guard<std::mutex> lock(mine.mtx);
+
+    if(mine.begin < mine.end)
+    {
+      begin = mine.begin;
+      end = std::min(mine.begin + grain_, mine.end);
+
+      mine.begin = end;
+
+      return true;
+    }
+  }
+
+  return steal(worker, begin, end);
+}
+
+bool
+gde::geom::algorithm::work_stealing_scheduler::steal(std::size_t worker, std::size_t& begin, std::size_t& end)
+{
+  const std::size_t nranges = ranges_.size();
+
+  for(std::size_t k = 1; k != nranges; ++k)
+  {
+    worker_range& victim = ranges_[(worker + k) % nranges];
+
+    std::size_t stolen_begin = 0;
+    std::size_t stolen_end = 0;
+
+    {
+      std::lock_guard<std::mutex> lock(victim.mtx);
+
+      if(victim.begin >= victim.end)
+        continue;
+
+      const std::size_t remaining = victim.end - victim.begin;
+
+// take the upper half of the victim range, or all of it if it is a single chunk
+      stolen_end = victim.end;
+      stolen_begin = (remaining > grain_) ? (victim.begin + remaining / 2) : victim.begin;
+
+      victim.end = stolen_begin;
+    }
+
+// process the first chunk and keep the rest as our own range
+    begin = stolen_begin;
+    end = std::min(stolen_begin + grain_, stolen_end);
+
+    worker_range& mine = ranges_[worker];
+
+    std::lock_guard<std::mutex> lock(mine.mtx);
+
+    mine.begin = end;
+    mine.end = stolen_end;
+
+    return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,151 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/work_stealing_scheduler.hpp
+
+  \brief A work-stealing scheduler for loops over a range of indexes.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_WORK_STEALING_SCHEDULER_HPP__
+#define __GDE_GEOM_ALGORITHM_WORK_STEALING_SCHEDULER_HPP__
+
+// GDE
+#include "thread_pool.hpp"
+
+// STL
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \class work_stealing_scheduler
+
+        \brief Shares a range of indexes [first, last) among a number of workers.
+
+        Each worker starts with a contiguous share of the range and takes chunks
+        of grain indexes from its front. A worker that runs out of work steals
+        the upper half of the remaining range of another worker, so skewed work
+        is balanced without a central queue.
+       */
+      class work_stealing_scheduler
+      {
+        public:
+
+          /*!
+            \brief Split the range [first, last) among nworkers.
+
+            \param grain The number of indexes in each chunk. If zero, a grain is chosen
+                         so that each worker gets about 64 chunks.
+           */
+          work_stealing_scheduler(std::size_t first, std::size_t last,
+                                  std::size_t nworkers, std::size_t grain = 0);
+
+          /*!
+            \brief Get the next chunk [begin, end) for the given worker.
+
+            \return False when there is no more work.
+           */
+          bool next(std::size_t worker, std::size_t& begin, std::size_t& end);
+
+        private:
+
+          /*! \brief The remaining range of a worker, padded to avoid false sharing. */
+          struct worker_range
+          {
+            std::mutex mtx;
+            std::size_t begin;
+            std::size_t end;
+            char pad[64];
+          };
+
+          bool steal(std::size_t worker, std::size_t& begin, std::size_t& end);
+
+          std::vector<worker_range> ranges_;
+          std::size_t grain_;
+      };
+
+      /*!
+        \brief Run f over the range [first, last) on the threads of a pool using work-stealing.
+
+        The function object is called as f(thread_pos, begin, end) for each chunk [begin, end),
+        where thread_pos is the number of the pool worker running it, so that each worker
+        can write to its own output.
+
+        \param grain The number of indexes in each chunk (zero means automatic).
+       */
+      template<class F>
+      void
+      parallel_for(thread_pool& pool, std::size_t first, std::size_t last, F& f, std::size_t grain = 0)
+      {
+        if(first >= last)
+          return;
+
+        if(pool.size() == 1)
+        {
+          f(0, first, last);
+          return;
+        }
+
+        work_stealing_scheduler scheduler(first, last, pool.size(), grain);
+
+        pool.run([&scheduler, &f](std::size_t thread_pos)
+                 {
+                   std::size_t begin = 0;
+                   std::size_t end = 0;
+
+                   while(scheduler.next(thread_pos, begin, end))
+                     f(thread_pos, begin, end);
+                 });
+      }
+
+      /*!
+        \brief Run f over the range [first, last) using nthreads new threads and work-stealing.
+
+        As for thread_pool, nthreads = 0 works as nthreads = 1: f runs on the calling thread.
+
+        \see parallel_for(thread_pool&, std::size_t, std::size_t, F&, std::size_t)
+       */
+      template<class F>
+      void
+      parallel_for(std::size_t first, std::size_t last, std::size_t nthreads, F& f, std::size_t grain = 0)
+      {
+        if(first >= last)
+          return;
+
+        thread_pool pool(nthreads);
+
+        parallel_for(pool, first, last, f, grain);
+      }
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_WORK_STEALING_SCHEDULER_HPP__
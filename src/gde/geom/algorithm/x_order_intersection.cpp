@@ -29,7 +29,7 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
-#include "line_segment_intersection.hpp"
+#include "intersection_core.hpp"
 #include "utils.hpp"
 
 // STL
@@ -56,45 +56,31 @@ gde::geom::algorithm::x_order_intersection(const std::vector<gde::geom::core::li
 // sort all the segments from left to right
   std::sort(ordered_segments.begin(), ordered_segments.end(), line_segment_xy_cmp());
   
-// retain intersection points between tests
-  gde::geom::core::point ip1, ip2;
-  
-  const std::size_t nbands = nsegments - 1;
-
-// first scan ordered_segments from the first segment
-  for(std::size_t i = 0; i < nbands; ++i)
-  {
-    const gde::geom::core::line_segment& current_seg = ordered_segments[i];
-
-// scan segments from i + 1
-    for(std::size_t j = i + 1; j < nsegments; ++j)
-    {
-      const gde::geom::core::line_segment& next_seg = ordered_segments[j];
-
-// if beginning x-coordinate of the next-segment is greater than
-// the end x-coordinate of the current-segment, they can not intersect
-// and all following sgments will be out-of current segment
-// interval => stop: no more segments can intersects.
-      if(current_seg.p2.x < next_seg.p1.x)
-        break;
-
-// if segments y-interval don't intersect they will not have intersection,
-// let's test the next segment!
-      if(!do_y_interval_intersects(current_seg, next_seg))
-        continue;
-      
-// check for intersection
-      segment_relation_type result = compute_intesection_v3(current_seg, next_seg, ip1, ip2);
-      
-      if(result == DISJOINT)
-        continue;
-      
-      ipts.push_back(ip1);
-      
-      if(result == OVERLAP)
-        ipts.push_back(ip2);
-    }
-  }
+// scan the bands from left to right
+  point_vector_sink sink = { &ipts };
+
+  x_order_intersection_core<default_kernel, y_interval_test>(ordered_segments, 0, nsegments - 1, sink);
 
   return ipts;
 }
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::x_order_intersection_count(const std::vector<gde::geom::core::line_segment>& segments)
+{
+  intersection_count_sink sink = {};
+
+  const std::size_t nsegments = segments.size();
+
+  if(nsegments <= 1)
+    return sink.count;
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(nsegments);
+
+  std::transform(segments.begin(), segments.end(), ordered_segments.begin(), sort_segment_xy());
+
+  std::sort(ordered_segments.begin(), ordered_segments.end(), line_segment_xy_cmp());
+
+  x_order_intersection_core<default_kernel, y_interval_test>(ordered_segments, 0, nsegments - 1, sink);
+
+  return sink.count;
+}
@@ -156,7 +156,7 @@ gde::geom::algorithm::x_order_intersection_rb2(const std::vector<gde::geom::core
         continue;
 
 // check for intersection
-      segment_relation_type result = compute_intesection_v3(current_seg.first, next_seg.first, ip1, ip2);
+      segment_relation_type result = compute_intesection(current_seg.first, next_seg.first, ip1, ip2);
       
       if(result == DISJOINT)
         continue;
@@ -29,177 +29,124 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
-#include "line_segment_intersection.hpp"
+#include "count_then_fill.hpp"
+#include "intersection_core.hpp"
+#include "parallel_sort.hpp"
 #include "utils.hpp"
+#include "work_stealing_scheduler.hpp"
+#include "x_order_window.hpp"
 
 // STL
 #include <algorithm>
-#include <thread>
 
-/*!
-  \struct red_blue_sort_segment_xy2
-       
-  Given a line segment it will build a new one ordered from left to right.
- */
-struct red_blue_sort_segment_xy2 : public std::unary_function<gde::geom::core::line_segment,
-                                                             std::pair<gde::geom::core::line_segment,
-                                                                       gde::geom::core::color_type> >
+struct x_order_rb_scan
 {
-  gde::geom::core::color_type color;
-  
-  red_blue_sort_segment_xy2(gde::geom::core::color_type c)
-    : color(c)
-  {
-  }
-  
-  std::pair<gde::geom::core::line_segment,
-            gde::geom::core::color_type> operator()(const gde::geom::core::line_segment& s)
+  const std::vector<std::pair<gde::geom::core::line_segment,
+                              gde::geom::core::color_type> >* ordered_segments;
+  const gde::geom::algorithm::x_order_window* window;
+
+  template<class Sink>
+  void operator()(std::size_t first, std::size_t last, Sink& sink) const
   {
-    if(s.p1.x < s.p2.x)
-      return std::make_pair(s, color);
-          
-    if(s.p1.x > s.p2.x)
-      return std::make_pair(gde::geom::core::line_segment(s.p2, s.p1), color);
-          
-    if(s.p1.y < s.p2.y)
-      return std::make_pair(s, color);
-          
-    if(s.p1.y > s.p2.y)
-      return std::make_pair(gde::geom::core::line_segment(s.p2, s.p1), color);
-          
-    return std::make_pair(s, color);
+    gde::geom::algorithm::x_order_window_intersection_core<gde::geom::algorithm::default_kernel>(*ordered_segments, *window, first, last, sink);
   }
 };
 
-struct red_blue_segment_xy_cmp2 : std::less<std::pair<gde::geom::core::line_segment,
-                                                     gde::geom::core::color_type> >
+void
+gde::geom::algorithm::x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                     std::size_t nthreads,
+                                                     std::vector<std::vector<gde::geom::core::point> >& intersection_pts)
 {
-  bool operator()(const std::pair<gde::geom::core::line_segment,
-                                  gde::geom::core::color_type>& lhs,
-                  const std::pair<gde::geom::core::line_segment,
-                                  gde::geom::core::color_type>& rhs) const
-  {
-    if(lhs.first.p1.x < rhs.first.p1.x)
-      return true;
-          
-    if(lhs.first.p1.x > rhs.first.p1.x)
-      return false;
-          
-    if(lhs.first.p1.y < rhs.first.p1.y)
-      return true;
-    
-    return false;
-  }
-};
+  thread_pool pool(nthreads);
+
+  x_order_intersection_rb_thread(red_segments, blue_segments, pool, intersection_pts);
+}
 
-struct intersection_computer4
+void
+gde::geom::algorithm::x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                     thread_pool& pool,
+                                                     std::vector<std::vector<gde::geom::core::point> >& intersection_pts)
 {
-  std::size_t thread_pos;
-  std::size_t num_threads;
-  std::size_t nbands;
-  std::size_t nsegments;
-  std::vector<gde::geom::core::point>* ipts;
+  intersection_pts.resize(pool.size());
+
+// check if we have at least two segments to test!
+  if(red_segments.empty() || blue_segments.empty())
+    return;
+
+// each segment with its color, from left to right, and the keys of the candidate filter
   std::vector<std::pair<gde::geom::core::line_segment,
-                        gde::geom::core::color_type> >* ordered_segments;
-  
-  void operator()()
-  {
-    gde::geom::core::point ip1;
-    gde::geom::core::point ip2;
-    
-// first scan ordered_segments from the first segment
-    for(std::size_t i = thread_pos; i < nbands; i += num_threads)
-    {
-      const auto& current_seg = (*ordered_segments)[i];
-
-// scan segments from i + 1
-      for(std::size_t j = i + 1; j < nsegments; ++j)
-      {
-        const auto& next_seg = (*ordered_segments)[j];
-
-// if beginning x-coordinate of the next-segment is greater than
-// the end x-coordinate of the current-segment, they can not intersect
-// and all following sgments will be out-of current segment
-// interval => stop: no more segments can intersects.
-        if(current_seg.first.p2.x < next_seg.first.p1.x)
-          break;
-      
-// if segments have the same color, we don't compare!
-        if(current_seg.second == next_seg.second)
-          continue;
-
-// if segments y-interval don't intersect they will not have intersection,
-// let's test the next segment!
-        if(!gde::geom::algorithm::do_y_interval_intersects(current_seg.first, next_seg.first))
-          continue;
-      
-// check for intersection
-        gde::geom::algorithm::segment_relation_type result = gde::geom::algorithm::compute_intesection_v3(current_seg.first, next_seg.first, ip1, ip2);
-      
-        if(result == gde::geom::algorithm::DISJOINT)
-          continue;
-      
-        ipts->push_back(ip1);
-      
-        if(result == gde::geom::algorithm::OVERLAP)
-          ipts->push_back(ip2);
-      }
-    }
-  }
-};
+                        gde::geom::core::color_type> > ordered_segments;
+  x_order_window window;
+
+  prepare_x_order_rb(red_segments, blue_segments, pool, ordered_segments, window);
+
+  x_order_rb_scan scan = { &ordered_segments, &window };
+
+  scan_per_thread(pool, ordered_segments.size() - 1, scan, intersection_pts);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::x_order_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                           const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                           std::size_t nthreads)
+{
+  thread_pool pool(nthreads);
+
+  return x_order_intersection_rb_count_thread(red_segments, blue_segments, pool);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::x_order_intersection_rb_count_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                           const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                           thread_pool& pool)
+{
+  if(red_segments.empty() || blue_segments.empty())
+    return intersection_count();
+
+// each segment with its color, from left to right, and the keys of the candidate filter
+  std::vector<std::pair<gde::geom::core::line_segment,
+                        gde::geom::core::color_type> > ordered_segments;
+  x_order_window window;
+
+  prepare_x_order_rb(red_segments, blue_segments, pool, ordered_segments, window);
+
+  x_order_rb_scan scan = { &ordered_segments, &window };
+
+  return count_per_thread(pool, ordered_segments.size() - 1, scan);
+}
 
 void
 gde::geom::algorithm::x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
                                                      const std::vector<gde::geom::core::line_segment>& blue_segments,
                                                      std::size_t nthreads,
-                                                     std::vector<std::vector<gde::geom::core::point> >& intersection_pts)
+                                                     std::vector<gde::geom::core::point>& intersection_pts)
 {
-  intersection_pts.resize(nthreads);
+  thread_pool pool(nthreads);
 
-  const std::size_t nred_segments = red_segments.size();
-  
-  const std::size_t nblue_segments = blue_segments.size();
+  x_order_intersection_rb_thread(red_segments, blue_segments, pool, intersection_pts);
+}
 
-// check if we have at least two segments to test!
-  if((nred_segments == 0) || (nblue_segments == 0))
+void
+gde::geom::algorithm::x_order_intersection_rb_thread(const std::vector<gde::geom::core::line_segment>& red_segments,
+                                                     const std::vector<gde::geom::core::line_segment>& blue_segments,
+                                                     thread_pool& pool,
+                                                     std::vector<gde::geom::core::point>& intersection_pts)
+{
+  intersection_pts.clear();
+
+  if(red_segments.empty() || blue_segments.empty())
     return;
-  
-  const std::size_t nsegments = nred_segments + nblue_segments;
-  
-  const std::size_t nbands = nsegments - 1;
-  
-// create new segment vectors with the same size as input ones
+
+// each segment with its color, from left to right, and the keys of the candidate filter
   std::vector<std::pair<gde::geom::core::line_segment,
-                        gde::geom::core::color_type> > ordered_segments(nsegments);
-  
-// copy the input segments but make sure segments will be left-right ordered
-  //red_blue_sort_segment_xy2 make_red(gde::geom::core::RED);
-  //for(std::size_t i = 0; i != nred_segments; ++i)
-  //{
-  //  ordered_segments[i] = make_red(red_segments[i]);
-  //}
-  
-  //red_blue_sort_segment_xy2 make_blue(gde::geom::core::BLUE);
-  //for(std::size_t i = 0; i != nblue_segments; ++i)
-  //{
-  //  ordered_segments[nred_segments + i] = make_blue(blue_segments[i]);
-  //}
-  
-  auto it = std::transform(red_segments.begin(), red_segments.end(), ordered_segments.begin(), red_blue_sort_segment_xy2(gde::geom::core::RED));
-  
-  std::transform(blue_segments.begin(), blue_segments.end(), it, red_blue_sort_segment_xy2(gde::geom::core::BLUE));
-
-// sort all the segments from left to right
-  std::sort(ordered_segments.begin(), ordered_segments.end(), red_blue_segment_xy_cmp2());
-
-  std::vector<std::thread> threads;
-  
-  for(std::size_t i = 0; i != nthreads; ++i)
-  {
-    intersection_computer4 ic = {i, nthreads, nbands, nsegments, &(intersection_pts[i]), &ordered_segments};
-    threads.push_back(std::thread(ic));
-  }
-  
-  for(std::size_t i = 0; i != nthreads; ++i)
-    threads[i].join();
+                        gde::geom::core::color_type> > ordered_segments;
+  x_order_window window;
+
+  prepare_x_order_rb(red_segments, blue_segments, pool, ordered_segments, window);
+
+  x_order_rb_scan scan = { &ordered_segments, &window };
+
+  count_then_fill(pool, ordered_segments.size() - 1, scan, intersection_pts);
 }
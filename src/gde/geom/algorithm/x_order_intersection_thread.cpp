@@ -29,72 +29,56 @@
 
 // GDE
 #include "line_segments_intersection.hpp"
-#include "line_segment_intersection.hpp"
+#include "count_then_fill.hpp"
+#include "intersection_core.hpp"
+#include "parallel_sort.hpp"
 #include "utils.hpp"
-
+#include "work_stealing_scheduler.hpp"
 
 // STL
 #include <algorithm>
-#include <thread>
 
-struct intersection_computer
+struct x_order_scan
 {
-  std::size_t thread_pos;
-  std::size_t num_threads;
-  std::size_t nbands;
-  std::size_t nsegments;
-  std::vector<gde::geom::core::point>* ipts;
-  std::vector<gde::geom::core::line_segment>* ordered_segments;
-  
-  void operator()()
+  const std::vector<gde::geom::core::line_segment>* ordered_segments;
+
+  template<class Sink>
+  void operator()(std::size_t first, std::size_t last, Sink& sink) const
   {
-    gde::geom::core::point ip1;
-    gde::geom::core::point ip2;
-    
-// first scan ordered_segments from the first segment
-    for(std::size_t i = thread_pos; i < nbands; i += num_threads)
-    {
-      const gde::geom::core::line_segment& current_seg = (*ordered_segments)[i];
-
-// scan segments from i + 1
-      for(std::size_t j = i + 1; j < nsegments; ++j)
-      {
-        const gde::geom::core::line_segment& next_seg = (*ordered_segments)[j];
-
-// if beginning x-coordinate of the next-segment is greater than
-// the end x-coordinate of the current-segment, they can not intersect
-// and all following sgments will be out-of current segment
-// interval => stop: no more segments can intersects.
-        if(current_seg.p2.x < next_seg.p1.x)
-          break;
-
-// if segments y-interval don't intersect they will not have intersection,
-// let's test the next segment!
-        if(!gde::geom::algorithm::do_y_interval_intersects(current_seg, next_seg))
-          continue;
-      
-// check for intersection
-        gde::geom::algorithm::segment_relation_type result = gde::geom::algorithm::compute_intesection_v3(current_seg, next_seg, ip1, ip2);
-      
-        if(result == gde::geom::algorithm::DISJOINT)
-          continue;
-      
-        ipts->push_back(ip1);
-      
-        if(result == gde::geom::algorithm::OVERLAP)
-          ipts->push_back(ip2);
-      }
-    }
+    gde::geom::algorithm::x_order_intersection_core<gde::geom::algorithm::default_kernel,
+                                                    gde::geom::algorithm::y_interval_test>(*ordered_segments, first, last, sink);
   }
 };
 
+// copy the input segments, order each one of them from left to right and sort them all from left to right
+void
+order_segments_xy(const std::vector<gde::geom::core::line_segment>& segments,
+                  gde::geom::algorithm::thread_pool& pool,
+                  std::vector<gde::geom::core::line_segment>& ordered_segments)
+{
+  ordered_segments.resize(segments.size());
+
+  gde::geom::algorithm::parallel_transform(pool, segments.begin(), segments.end(), ordered_segments.begin(), gde::geom::algorithm::sort_segment_xy());
+
+  gde::geom::algorithm::parallel_sort(pool, ordered_segments.begin(), ordered_segments.end(), gde::geom::algorithm::line_segment_xy_cmp());
+}
 
 void
 gde::geom::algorithm::x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
                                                   std::size_t nthreads,
                                                   std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
 {
-  intersetion_pts.resize(nthreads);
+  thread_pool pool(nthreads);
+  
+  x_order_intersection_thread(segments, pool, intersetion_pts);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  thread_pool& pool,
+                                                  std::vector<std::vector<gde::geom::core::point> >& intersetion_pts)
+{
+  intersetion_pts.resize(pool.size());
   
   const std::size_t nsegments = segments.size();
 
@@ -103,24 +87,70 @@ gde::geom::algorithm::x_order_intersection_thread(const std::vector<gde::geom::c
     return;
   
   const std::size_t nbands = nsegments - 1;
-  
-// create a new segment vector with the same size as input segments
-  std::vector<gde::geom::core::line_segment> ordered_segments(nsegments);
 
-// copy the input segments and order each one them from left-right
-  std::transform(segments.begin(), segments.end(), ordered_segments.begin(), sort_segment_xy());
+  std::vector<gde::geom::core::line_segment> ordered_segments;
 
-// sort all the segments from left to right
-  std::sort(ordered_segments.begin(), ordered_segments.end(), line_segment_xy_cmp());
+  order_segments_xy(segments, pool, ordered_segments);
 
-  std::vector<std::thread> threads;
-  
-  for(std::size_t i = 0; i != nthreads; ++i)
-  {
-    intersection_computer ic = {i, nthreads, nbands, nsegments, &(intersetion_pts[i]), &ordered_segments};
-    threads.push_back(std::thread(ic));
-  }
-  
-  for(std::size_t i = 0; i != nthreads; ++i)
-    threads[i].join();
+  x_order_scan scan = { &ordered_segments };
+
+  scan_per_thread(pool, nbands, scan, intersetion_pts);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::x_order_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                        std::size_t nthreads)
+{
+  thread_pool pool(nthreads);
+
+  return x_order_intersection_count_thread(segments, pool);
+}
+
+gde::geom::algorithm::intersection_count
+gde::geom::algorithm::x_order_intersection_count_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                        thread_pool& pool)
+{
+  const std::size_t nsegments = segments.size();
+
+  if(nsegments <= 1)
+    return intersection_count();
+
+  std::vector<gde::geom::core::line_segment> ordered_segments;
+
+  order_segments_xy(segments, pool, ordered_segments);
+
+  x_order_scan scan = { &ordered_segments };
+
+  return count_per_thread(pool, nsegments - 1, scan);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  std::size_t nthreads,
+                                                  std::vector<gde::geom::core::point>& intersection_pts)
+{
+  thread_pool pool(nthreads);
+
+  x_order_intersection_thread(segments, pool, intersection_pts);
+}
+
+void
+gde::geom::algorithm::x_order_intersection_thread(const std::vector<gde::geom::core::line_segment>& segments,
+                                                  thread_pool& pool,
+                                                  std::vector<gde::geom::core::point>& intersection_pts)
+{
+  intersection_pts.clear();
+
+  const std::size_t nsegments = segments.size();
+
+  if(nsegments <= 1)
+    return;
+
+  std::vector<gde::geom::core::line_segment> ordered_segments;
+
+  order_segments_xy(segments, pool, ordered_segments);
+
+  x_order_scan scan = { &ordered_segments };
+
+  count_then_fill(pool, nsegments - 1, scan, intersection_pts);
 }
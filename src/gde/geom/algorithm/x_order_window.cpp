@@ -0,0 +1,181 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/x_order_window.cpp
+
+  \brief A candidate filter for the x-order scan over red and blue segments.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+// GDE
+#include "utils.hpp"
+#include "x_order_window.hpp"
+
+// STL
+#include <algorithm>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GDE_GEOM_ALGORITHM_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+void
+resize_x_order_window(std::size_t nsegments, gde::geom::algorithm::x_order_window& window)
+{
+  gde::geom::algorithm::check_indexed_segments(nsegments, "x_order_window");
+
+  const double inf = std::numeric_limits<double>::infinity();
+
+// padding segments start at +infinity: they end every window
+  window.nsegments = nsegments;
+  window.xmin.assign(nsegments + 4, inf);
+  window.xmax.assign(nsegments + 4, inf);
+  window.ymin.assign(nsegments + 4, inf);
+  window.ymax.assign(nsegments + 4, inf);
+  window.color.assign(nsegments + 4, 0.0);
+}
+
+void
+fill_x_order_window(const std::vector<std::pair<gde::geom::core::line_segment,
+                                                gde::geom::core::color_type> >& ordered_segments,
+                    std::size_t first, std::size_t last,
+                    gde::geom::algorithm::x_order_window& window)
+{
+  for(std::size_t i = first; i != last; ++i)
+  {
+    const gde::geom::core::line_segment& s = ordered_segments[i].first;
+
+    window.xmin[i] = s.p1.x;
+    window.xmax[i] = s.p2.x;
+    window.ymin[i] = std::min(s.p1.y, s.p2.y);
+    window.ymax[i] = std::max(s.p1.y, s.p2.y);
+    window.color[i] = (ordered_segments[i].second == gde::geom::core::RED) ? 0.0 : 1.0;
+  }
+}
+
+void
+x_order_candidates_scalar(const gde::geom::algorithm::x_order_window& window, std::size_t i,
+                          std::vector<std::uint32_t>& candidates)
+{
+  const double xmax = window.xmax[i];
+  const double ymin = window.ymin[i];
+  const double ymax = window.ymax[i];
+  const double color = window.color[i];
+
+  for(std::size_t j = i + 1; window.xmin[j] <= xmax; ++j)
+  {
+    if((window.color[j] != color) && (window.ymin[j] <= ymax) && (window.ymax[j] >= ymin))
+      candidates.push_back(static_cast<std::uint32_t>(j));
+  }
+}
+
+#ifdef GDE_GEOM_ALGORITHM_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+void
+x_order_candidates_avx2(const gde::geom::algorithm::x_order_window& window, std::size_t i,
+                        std::vector<std::uint32_t>& candidates)
+{
+  const __m256d xmax = _mm256_set1_pd(window.xmax[i]);
+  const __m256d ymin = _mm256_set1_pd(window.ymin[i]);
+  const __m256d ymax = _mm256_set1_pd(window.ymax[i]);
+  const __m256d color = _mm256_set1_pd(window.color[i]);
+
+  for(std::size_t j = i + 1; ; j += 4)
+  {
+// segments are sorted on xmin: the lanes inside the window are a prefix
+    const __m256d in_window = _mm256_cmp_pd(_mm256_loadu_pd(&window.xmin[j]), xmax, _CMP_LE_OQ);
+
+    const __m256d y_overlap = _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(&window.ymin[j]), ymax, _CMP_LE_OQ),
+                                            _mm256_cmp_pd(_mm256_loadu_pd(&window.ymax[j]), ymin, _CMP_GE_OQ));
+
+    const __m256d other_color = _mm256_cmp_pd(_mm256_loadu_pd(&window.color[j]), color, _CMP_NEQ_OQ);
+
+    unsigned int keep = static_cast<unsigned int>(_mm256_movemask_pd(_mm256_and_pd(in_window, _mm256_and_pd(y_overlap, other_color))));
+
+    while(keep != 0)
+    {
+      candidates.push_back(static_cast<std::uint32_t>(j + __builtin_ctz(keep)));
+      keep &= keep - 1;
+    }
+
+    if(_mm256_movemask_pd(in_window) != 0xF)
+      break;
+  }
+}
+
+bool
+x_order_window_has_avx2()
+{
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+
+  return avx2;
+}
+
+#endif // GDE_GEOM_ALGORITHM_AVX2_KERNEL
+
+void
+gde::geom::algorithm::build_x_order_window(const std::vector<std::pair<gde::geom::core::line_segment,
+                                                                       gde::geom::core::color_type> >& ordered_segments,
+                                           x_order_window& window)
+{
+  resize_x_order_window(ordered_segments.size(), window);
+
+  fill_x_order_window(ordered_segments, 0, ordered_segments.size(), window);
+}
+
+void
+gde::geom::algorithm::build_x_order_window(const std::vector<std::pair<gde::geom::core::line_segment,
+                                                                       gde::geom::core::color_type> >& ordered_segments,
+                                           thread_pool& pool,
+                                           x_order_window& window)
+{
+  const std::size_t n = ordered_segments.size();
+
+  resize_x_order_window(n, window);
+
+  const std::size_t nworkers = pool.size();
+
+  pool.run([&ordered_segments, &window, n, nworkers](std::size_t thread_pos)
+           {
+             fill_x_order_window(ordered_segments, (n * thread_pos) / nworkers, (n * (thread_pos + 1)) / nworkers, window);
+           });
+}
+
+void
+gde::geom::algorithm::x_order_candidates(const x_order_window& window, std::size_t i,
+                                         std::vector<std::uint32_t>& candidates)
+{
+  candidates.clear();
+
+#ifdef GDE_GEOM_ALGORITHM_AVX2_KERNEL
+  if(x_order_window_has_avx2())
+  {
+    x_order_candidates_avx2(window, i, candidates);
+    return;
+  }
+#endif
+
+  x_order_candidates_scalar(window, i, candidates);
+}
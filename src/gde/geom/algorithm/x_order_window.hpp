@@ -0,0 +1,104 @@
+/*
+  Copyright (C) 2015 National Institute For Space Research (INPE) - Brazil.
+
+  This file is part of Geospatial Database Explorer (GDE) - a free and open source GIS.
+
+  GDE is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GDE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GDE. See LICENSE. If not, write to
+  GDE Team at <gde-team@dpi.inpe.br>.
+*/
+
+/*!
+  \file gde/geom/algorithm/x_order_window.hpp
+
+  \brief A candidate filter for the x-order scan over red and blue segments.
+
+  \author Joao Vitor Chagas
+  \author Gilberto Ribeiro de Queiroz
+ */
+
+#ifndef __GDE_GEOM_ALGORITHM_X_ORDER_WINDOW_HPP__
+#define __GDE_GEOM_ALGORITHM_X_ORDER_WINDOW_HPP__
+
+// GDE
+#include "../core/geometric_primitives.hpp"
+#include "thread_pool.hpp"
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gde
+{
+  namespace geom
+  {
+    namespace algorithm
+    {
+      /*!
+        \struct x_order_window
+
+        \brief The keys tested by the x-order scan for each left-right sorted segment,
+               stored as separate arrays.
+
+        The y-interval of each segment is computed once, and colors are stored as 0.0 (red)
+        and 1.0 (blue) so that all the tests of the scan run on the same kind of vector lanes.
+        The arrays are padded with 4 segments that start at +infinity, so a window always ends
+        before the padding.
+       */
+      struct x_order_window
+      {
+        std::vector<double> xmin;  //!< p1.x
+        std::vector<double> xmax;  //!< p2.x
+        std::vector<double> ymin;
+        std::vector<double> ymax;
+        std::vector<double> color;
+        std::size_t nsegments;
+      };
+
+      /*!
+        \brief Build the window keys from segments sorted from left to right.
+
+        \exception std::length_error If there are more than max_indexed_segments segments: the candidates are 32-bit indexes.
+       */
+      void
+      build_x_order_window(const std::vector<std::pair<gde::geom::core::line_segment,
+                                                       gde::geom::core::color_type> >& ordered_segments,
+                           x_order_window& window);
+
+      /*! \brief The same as above but using the threads of a pool. */
+      void
+      build_x_order_window(const std::vector<std::pair<gde::geom::core::line_segment,
+                                                       gde::geom::core::color_type> >& ordered_segments,
+                           thread_pool& pool,
+                           x_order_window& window);
+
+      /*!
+        \brief Find the segments after i that may intersect it.
+
+        Scans the segments after i until one starts to the right of the end of i,
+        keeping the ones with a different color and an overlapping y-interval.
+        Where AVX2 is available, 4 segments are tested at a time.
+
+        \param candidates Cleared and filled with the indexes of the candidates, in increasing order.
+       */
+      void
+      x_order_candidates(const x_order_window& window, std::size_t i,
+                         std::vector<std::uint32_t>& candidates);
+
+    } // end namespace algorithm
+  }   // end namespace geom
+}     // end namespace gde
+
+#endif // __GDE_GEOM_ALGORITHM_X_ORDER_WINDOW_HPP__
@@ -31,6 +31,7 @@
 #define __GDE_GEOM_CORE_GEOMETRIC_PRMITIVES_HPP__
 
 // STL
+#include <cstdint>
 #include <limits>
 
 namespace gde
@@ -78,6 +79,41 @@ namespace gde
         return (lhs.x == rhs.x) && (lhs.y == rhs.y);
       }
       
+      /*!
+        \struct int_point
+
+        \brief Defines a point in 2D space with integer coordinates.
+
+        It is meant for data with a fixed precision, such as coordinates in a 1e-7 degree grid.
+       */
+      struct int_point
+      {
+        std::int32_t x;
+        std::int32_t y;
+      };
+
+      /*!
+        \struct int_line_segment
+
+        \brief Representation for line segments with integer coordinates.
+       */
+      struct int_line_segment
+      {
+        int_point p1;
+        int_point p2;
+
+        int_line_segment() { }
+
+        int_line_segment(const int_point& pt1, const int_point& pt2)
+          : p1(pt1), p2(pt2)
+        { }
+      };
+
+      inline bool operator==(const int_point& lhs, const int_point& rhs)
+      {
+        return (lhs.x == rhs.x) && (lhs.y == rhs.y);
+      }
+
       /*!
        \struct rectangle
        
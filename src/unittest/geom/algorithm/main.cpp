@@ -29,13 +29,38 @@
 
 // GDE
 #include <gde/geom/core/geometric_primitives.hpp>
+#include <gde/geom/algorithm/count_then_fill.hpp>
+#include <gde/geom/algorithm/integer_intersection.hpp>
+#include <gde/geom/algorithm/intersection_core.hpp>
+#include <gde/geom/algorithm/intersection_selector.hpp>
+#include <gde/geom/algorithm/intersection_visitor.hpp>
 #include <gde/geom/algorithm/line_segment_intersection.hpp>
+#include <gde/geom/algorithm/line_segment_batch.hpp>
 #include <gde/geom/algorithm/line_segments_intersection.hpp>
+#include <gde/geom/algorithm/packed_rtree.hpp>
+#include <gde/geom/algorithm/parallel_sort.hpp>
+#include <gde/geom/algorithm/quadtree_index.hpp>
+#include <gde/geom/algorithm/resolution_planner.hpp>
+#include <gde/geom/algorithm/robust_predicates.hpp>
+#include <gde/geom/algorithm/grid_index.hpp>
+#include <gde/geom/algorithm/thread_pool.hpp>
 #include <gde/geom/algorithm/utils.hpp>
+#include <gde/geom/algorithm/work_stealing_scheduler.hpp>
+#include <gde/geom/algorithm/x_order_window.hpp>
 
 // STL
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 void print(const std::vector<gde::geom::core::line_segment>& segments)
 {
@@ -119,9 +144,2355 @@ void do_intersects_basic_test()
   return;
 }
 
+std::vector<gde::geom::core::line_segment>
+gen_segments(std::size_t num_segments, unsigned int seed, double max_coord, double max_length, bool integer_coords)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> coord(0.0, max_coord);
+  std::uniform_real_distribution<double> delta(-max_length, max_length);
+
+  std::vector<gde::geom::core::line_segment> segments;
+
+  while(segments.size() != num_segments)
+  {
+    gde::geom::core::point p1 = {coord(gen), coord(gen)};
+    gde::geom::core::point p2 = {p1.x + delta(gen), p1.y + delta(gen)};
+
+    if(integer_coords)
+    {
+      p1.x = std::floor(p1.x);
+      p1.y = std::floor(p1.y);
+      p2.x = std::floor(p2.x);
+      p2.y = std::floor(p2.y);
+    }
+
+// skip degenerate segments
+    if(p1 == p2)
+      continue;
+
+    segments.push_back(gde::geom::core::line_segment(p1, p2));
+  }
+
+  return segments;
+}
+
+// coordinates on a grid of the given step: end-points computed as p1 + delta are often a round-off away from the grid
+std::vector<gde::geom::core::line_segment>
+gen_grid_segments(std::size_t num_segments, unsigned int seed, double max_coord, double max_length, double step)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> coord(0.0, max_coord / step);
+  std::uniform_real_distribution<double> delta(-max_length / step, max_length / step);
+
+  std::vector<gde::geom::core::line_segment> segments;
+
+  while(segments.size() != num_segments)
+  {
+    gde::geom::core::point p1 = {std::floor(coord(gen)) * step, std::floor(coord(gen)) * step};
+    gde::geom::core::point p2 = {p1.x + std::floor(delta(gen)) * step, p1.y + std::floor(delta(gen)) * step};
+
+// skip degenerate segments
+    if(p1 == p2)
+      continue;
+
+    segments.push_back(gde::geom::core::line_segment(p1, p2));
+  }
+
+  return segments;
+}
+
+bool same_points(std::vector<gde::geom::core::point> lhs, std::vector<gde::geom::core::point> rhs)
+{
+  if(lhs.size() != rhs.size())
+  {
+    std::cout << "different number of points: " << lhs.size() << " x " << rhs.size() << std::endl;
+    return false;
+  }
+
+// match each point with one equal up to round-off: points with close x-coordinates may be sorted in any order
+  auto x_cmp = [](const gde::geom::core::point& a, const gde::geom::core::point& b) { return a.x < b.x; };
+
+  std::sort(lhs.begin(), lhs.end(), x_cmp);
+  std::sort(rhs.begin(), rhs.end(), x_cmp);
+
+  std::vector<bool> matched(rhs.size(), false);
+
+  for(const gde::geom::core::point& p : lhs)
+  {
+    gde::geom::core::point low = { p.x - 1.0e-9, p.y };
+
+    std::size_t j = std::lower_bound(rhs.begin(), rhs.end(), low, x_cmp) - rhs.begin();
+
+    while((j != rhs.size()) && (rhs[j].x <= p.x + 1.0e-9) && (matched[j] || (std::abs(rhs[j].y - p.y) > 1.0e-9)))
+      ++j;
+
+    if((j == rhs.size()) || (rhs[j].x > p.x + 1.0e-9))
+    {
+      std::cout << "different points: (" << p.x << ", " << p.y << ") not found" << std::endl;
+      return false;
+    }
+
+    matched[j] = true;
+  }
+
+  return true;
+}
+
+// the points found by each thread, one thread after the other
+std::vector<gde::geom::core::point>
+flatten(const std::vector<std::vector<gde::geom::core::point> >& ipts)
+{
+  std::vector<gde::geom::core::point> pts;
+
+  for(const std::vector<gde::geom::core::point>& thread_ipts : ipts)
+    pts.insert(pts.end(), thread_ipts.begin(), thread_ipts.end());
+
+  return pts;
+}
+
+bool bentley_ottmann_test()
+{
+  bool result = true;
+
+// general position
+  std::vector<gde::geom::core::line_segment> segments = gen_segments(2000, 1, 1000.0, 50.0, false);
+
+  result &= same_points(gde::geom::algorithm::x_order_intersection(segments),
+                        gde::geom::algorithm::bentley_ottmann_intersection(segments));
+
+// lots of degenerate cases: shared end-points, vertical and horizontal segments, overlaps
+  segments = gen_segments(2000, 2, 100.0, 6.0, true);
+
+  result &= same_points(gde::geom::algorithm::x_order_intersection(segments),
+                        gde::geom::algorithm::bentley_ottmann_intersection(segments));
+
+// the count mode finds the same relations
+  gde::geom::algorithm::intersection_count expected = gde::geom::algorithm::x_order_intersection_count(segments);
+  gde::geom::algorithm::intersection_count count = gde::geom::algorithm::bentley_ottmann_intersection_count(segments);
+
+  result &= std::equal(expected.relations, expected.relations + 4, count.relations);
+
+// many segments through the same point
+  segments.clear();
+
+  for(int i = 0; i != 16; ++i)
+  {
+    double a = 0.39269908169872414 * i;
+
+    segments.push_back(gde::geom::core::line_segment({10.0 * std::cos(a), 10.0 * std::sin(a)},
+                                                     {-10.0 * std::cos(a), -10.0 * std::sin(a)}));
+  }
+
+  result &= same_points(gde::geom::algorithm::x_order_intersection(segments),
+                        gde::geom::algorithm::bentley_ottmann_intersection(segments));
+
+  if(!result)
+    std::cout << "bentley_ottmann_test: FAILED" << std::endl;
+
+  return result;
+}
+
+std::vector<gde::geom::core::line_segment>
+gen_planar_grid(std::size_t nrows, std::size_t ncols, unsigned int seed, double spacing, double jitter)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> delta(-jitter, jitter);
+
+  std::vector<gde::geom::core::point> pts;
+
+  for(std::size_t i = 0; i != nrows; ++i)
+    for(std::size_t j = 0; j != ncols; ++j)
+      pts.push_back({j * spacing + delta(gen), i * spacing + delta(gen)});
+
+// the edges of a slightly perturbed grid don't cross each other
+  std::vector<gde::geom::core::line_segment> segments;
+
+  for(std::size_t i = 0; i != nrows; ++i)
+  {
+    for(std::size_t j = 0; j != ncols; ++j)
+    {
+      if((j + 1) != ncols)
+        segments.push_back(gde::geom::core::line_segment(pts[i * ncols + j], pts[i * ncols + j + 1]));
+
+      if((i + 1) != nrows)
+        segments.push_back(gde::geom::core::line_segment(pts[i * ncols + j], pts[(i + 1) * ncols + j]));
+    }
+  }
+
+  return segments;
+}
+
+bool trapezoid_sweep_test()
+{
+  bool result = true;
+
+// two perturbed grids
+  std::vector<gde::geom::core::line_segment> red_segments = gen_planar_grid(60, 60, 3, 10.0, 2.0);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_planar_grid(80, 80, 4, 7.0, 1.5);
+
+  result &= same_points(gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments),
+                        gde::geom::algorithm::trapezoid_sweep_intersection_rb(red_segments, blue_segments));
+
+// lots of degenerate cases: red is a grid with a diagonal in each cell,
+// blue has the other diagonal of each cell and segments overlapping the red ones
+  red_segments.clear();
+  blue_segments.clear();
+
+  for(int i = 0; i != 30; ++i)
+  {
+    for(int j = 0; j != 30; ++j)
+    {
+      red_segments.push_back(gde::geom::core::line_segment({double(i), double(j)}, {double(i + 1), double(j)}));
+      red_segments.push_back(gde::geom::core::line_segment({double(i), double(j)}, {double(i), double(j + 1)}));
+      red_segments.push_back(gde::geom::core::line_segment({double(i), double(j + 1)}, {double(i + 1), double(j)}));
+
+      blue_segments.push_back(gde::geom::core::line_segment({double(i), double(j)}, {double(i + 1), double(j + 1)}));
+
+      if((i % 2) == 0)
+        blue_segments.push_back(gde::geom::core::line_segment({double(i), double(j)}, {double(i + 2), double(j)}));
+    }
+  }
+
+  result &= same_points(gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments),
+                        gde::geom::algorithm::trapezoid_sweep_intersection_rb(red_segments, blue_segments));
+
+// the count mode finds the same relations
+  gde::geom::algorithm::intersection_count expected = gde::geom::algorithm::x_order_intersection_rb_count(red_segments, blue_segments);
+  gde::geom::algorithm::intersection_count count = gde::geom::algorithm::trapezoid_sweep_intersection_rb_count(red_segments, blue_segments);
+
+  result &= std::equal(expected.relations, expected.relations + 4, count.relations);
+  result &= (count.relations[gde::geom::algorithm::OVERLAP] != 0);
+
+  if(!result)
+    std::cout << "trapezoid_sweep_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool fixed_grid_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(3000, 5, 1000.0, 40.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, 6, 1000.0, 40.0, false);
+
+  std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+  all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+  std::vector<gde::geom::core::point> expected = gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments);
+
+  result &= same_points(expected,
+                        gde::geom::algorithm::fixed_grid_intersection_rb(red_segments, blue_segments,
+                                                                         25.0, 25.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+
+  std::vector<std::vector<gde::geom::core::point> > intersection_pts;
+
+  gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, 3,
+                                                          25.0, 25.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y,
+                                                          intersection_pts);
+
+  std::vector<gde::geom::core::point> ipts;
+
+  for(const auto& vecipts : intersection_pts)
+    ipts.insert(ipts.end(), vecipts.begin(), vecipts.end());
+
+  result &= same_points(expected, ipts);
+
+// the parallel build must give the same grid as the serial one
+  gde::geom::algorithm::grid_index serial_grid;
+  gde::geom::algorithm::grid_index thread_grid;
+
+  gde::geom::algorithm::build_grid_index(blue_segments, 25.0, 25.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, serial_grid);
+  gde::geom::algorithm::build_grid_index_thread(blue_segments, 3, 25.0, 25.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, thread_grid);
+
+  result &= (serial_grid.offsets == thread_grid.offsets) && (serial_grid.ids == thread_grid.ids);
+
+// red segments may stick out of the blue extent on every side
+  std::vector<gde::geom::core::line_segment> small_red(1, gde::geom::core::line_segment({-50.0, 5.0}, {50.0, 5.0}));
+  std::vector<gde::geom::core::line_segment> small_blue;
+
+  small_blue.push_back(gde::geom::core::line_segment({10.0, 0.0}, {10.0, 100.0}));
+  small_blue.push_back(gde::geom::core::line_segment({90.0, 0.0}, {100.0, 100.0}));
+
+  result &= same_points(gde::geom::algorithm::lazy_intersection_rb(small_red, small_blue),
+                        gde::geom::algorithm::fixed_grid_intersection_rb(small_red, small_blue,
+                                                                         10.0, 10.0, 0.0, 100.0, 0.0, 100.0));
+
+  gde::geom::core::rectangle br = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
+
+  std::vector<gde::geom::core::line_segment> outer_red(red_segments);
+
+  for(std::size_t i = 0; i != 20; ++i)
+  {
+    const double x = br.ll.x + (br.ur.x - br.ll.x) * (i + 0.5) / 20.0;
+    const double y = br.ll.y + (br.ur.y - br.ll.y) * (i + 0.5) / 20.0;
+
+    outer_red.push_back(gde::geom::core::line_segment({br.ll.x - 100.0, y}, {br.ur.x + 100.0, y}));
+    outer_red.push_back(gde::geom::core::line_segment({x, br.ll.y - 100.0}, {x, br.ur.y + 100.0}));
+    outer_red.push_back(gde::geom::core::line_segment({br.ll.x - 50.0, y}, {x, br.ll.y - 50.0}));
+    outer_red.push_back(gde::geom::core::line_segment({x, br.ur.y + 50.0}, {br.ur.x + 50.0, y}));
+  }
+
+// and some of them are entirely outside it
+  outer_red.push_back(gde::geom::core::line_segment({br.ll.x - 100.0, br.ll.y - 100.0}, {br.ll.x - 10.0, br.ur.y + 100.0}));
+  outer_red.push_back(gde::geom::core::line_segment({br.ur.x + 10.0, br.ur.y + 10.0}, {br.ur.x + 100.0, br.ur.y + 100.0}));
+
+  expected = gde::geom::algorithm::x_order_intersection_rb(outer_red, blue_segments);
+
+  result &= same_points(expected,
+                        gde::geom::algorithm::fixed_grid_intersection_rb(outer_red, blue_segments,
+                                                                         25.0, 25.0, br.ll.x, br.ur.x, br.ll.y, br.ur.y));
+
+  std::vector<gde::geom::core::point> outer_pts;
+
+  gde::geom::algorithm::fixed_grid_intersection_rb_thread(outer_red, blue_segments, 3,
+                                                          25.0, 25.0, br.ll.x, br.ur.x, br.ll.y, br.ur.y,
+                                                          outer_pts);
+
+  result &= same_points(expected, outer_pts);
+
+  if(!result)
+    std::cout << "fixed_grid_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool tiling_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(3000, 7, 1000.0, 40.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, 8, 1000.0, 40.0, false);
+
+  std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+  all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+  std::vector<gde::geom::core::point> expected = gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments);
+
+  result &= same_points(expected,
+                        gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments, 30.0, r.ll.y, r.ur.y));
+
+  std::vector<std::vector<gde::geom::core::point> > intersection_pts;
+
+  gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, 3, 30.0, r.ll.y, r.ur.y, intersection_pts);
+
+  std::vector<gde::geom::core::point> ipts;
+
+  for(const auto& vecipts : intersection_pts)
+    ipts.insert(ipts.end(), vecipts.begin(), vecipts.end());
+
+  result &= same_points(expected, ipts);
+
+// two-dimensional tiles
+  result &= same_points(expected,
+                        gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments,
+                                                                     30.0, 30.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+
+  intersection_pts.clear();
+
+  gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, 3,
+                                                      30.0, 30.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y,
+                                                      intersection_pts);
+
+  ipts.clear();
+
+  for(const auto& vecipts : intersection_pts)
+    ipts.insert(ipts.end(), vecipts.begin(), vecipts.end());
+
+  result &= same_points(expected, ipts);
+
+  if(!result)
+    std::cout << "tiling_test: FAILED" << std::endl;
+
+  return result;
+}
+
+// counts how many times each index was visited, with uneven work per index
+struct visit_counter
+{
+  std::vector<std::atomic<int> >* visits;
+
+  void operator()(std::size_t /*thread_pos*/, std::size_t first, std::size_t last)
+  {
+    for(std::size_t i = first; i != last; ++i)
+    {
+      if(i % 1000 == 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+      ++(*visits)[i];
+    }
+  }
+};
+
+bool work_stealing_test()
+{
+  bool result = true;
+
+  const std::size_t nthreads[] = { 0, 1, 2, 3, 8 };
+  const std::size_t grains[] = { 0, 1, 7 };
+
+  for(std::size_t nt : nthreads)
+  {
+    for(std::size_t grain : grains)
+    {
+      std::vector<std::atomic<int> > visits(20011);
+
+      for(auto& v : visits)
+        v = 0;
+
+      visit_counter vc = { &visits };
+
+      gde::geom::algorithm::parallel_for(5, visits.size(), nt, vc, grain);
+
+      for(std::size_t i = 0; i != visits.size(); ++i)
+        result &= (visits[i] == (i < 5 ? 0 : 1));
+    }
+  }
+
+// skewed work: the threaded algorithms must still report every point once
+  std::vector<gde::geom::core::line_segment> segments = gen_segments(1500, 11, 1000.0, 300.0, false);
+
+  std::vector<std::vector<gde::geom::core::point> > intersection_pts;
+
+  gde::geom::algorithm::lazy_intersection_thread(segments, 4, intersection_pts);
+
+  std::vector<gde::geom::core::point> ipts;
+
+  for(const auto& vecipts : intersection_pts)
+    ipts.insert(ipts.end(), vecipts.begin(), vecipts.end());
+
+  result &= same_points(gde::geom::algorithm::x_order_intersection(segments), ipts);
+
+  if(!result)
+    std::cout << "work_stealing_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool thread_pool_test()
+{
+  bool result = true;
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+  result &= (pool.size() == 3);
+
+// many small calls on the same threads
+  for(unsigned int seed = 0; seed != 20; ++seed)
+  {
+    std::vector<gde::geom::core::line_segment> red_segments = gen_segments(200, 2 * seed + 100, 100.0, 20.0, false);
+    std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(200, 2 * seed + 101, 100.0, 20.0, false);
+
+    std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+    all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+    gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+    std::vector<gde::geom::core::point> expected = gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments);
+
+    std::vector<std::vector<gde::geom::core::point> > intersection_pts;
+
+    gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool, intersection_pts);
+
+    gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool,
+                                                        10.0, 10.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y,
+                                                        intersection_pts);
+
+    result &= (intersection_pts.size() == pool.size());
+
+    std::vector<gde::geom::core::point> ipts;
+
+    for(const auto& vecipts : intersection_pts)
+      ipts.insert(ipts.end(), vecipts.begin(), vecipts.end());
+
+// both calls appended to the same output
+    std::vector<gde::geom::core::point> expected_twice(expected);
+    expected_twice.insert(expected_twice.end(), expected.begin(), expected.end());
+
+    result &= same_points(expected_twice, ipts);
+  }
+
+// an exception in a task reaches the caller and the pool can still be used
+  bool thrown = false;
+
+  try
+  {
+    pool.run([](std::size_t thread_pos) { if(thread_pos == 2) throw std::runtime_error("task failed"); });
+  }
+  catch(const std::runtime_error&)
+  {
+    thrown = true;
+  }
+
+  result &= thrown;
+
+  std::atomic<int> nruns(0);
+
+  pool.run([&nruns](std::size_t) { ++nruns; });
+
+  result &= (nruns == 3);
+
+// no thread: the calling thread is the only worker
+  gde::geom::algorithm::thread_pool pool0(0);
+
+  result &= (pool0.size() == 1);
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(200, 98, 100.0, 20.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(200, 99, 100.0, 20.0, false);
+
+  std::vector<std::vector<gde::geom::core::point> > intersection_pts;
+
+  gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, 0, intersection_pts);
+
+  result &= (intersection_pts.size() == 1) &&
+            same_points(intersection_pts[0], gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments));
+
+  if(!result)
+    std::cout << "thread_pool_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool parallel_sort_test()
+{
+  bool result = true;
+
+  std::mt19937 gen(21);
+  std::uniform_int_distribution<int> key(0, 1000);
+
+  const std::size_t npools[] = { 2, 3, 5 };
+
+  for(std::size_t np : npools)
+  {
+    gde::geom::algorithm::thread_pool pool(np);
+
+// many repeated keys and a size that does not split evenly
+    std::vector<int> values(50001);
+
+    for(auto& v : values)
+      v = key(gen);
+
+    std::vector<int> expected(values);
+    std::sort(expected.begin(), expected.end());
+
+    gde::geom::algorithm::parallel_sort(pool, values.begin(), values.end(), std::less<int>());
+
+    result &= (values == expected);
+
+// segments sorted from left to right: the threaded x-order must find the same points
+    std::vector<gde::geom::core::line_segment> red_segments = gen_segments(15000, 31, 1000.0, 10.0, false);
+    std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(15000, 32, 1000.0, 10.0, false);
+
+    std::vector<std::vector<gde::geom::core::point> > intersection_pts;
+
+    gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool, intersection_pts);
+
+    std::vector<gde::geom::core::point> ipts;
+
+    for(const auto& vecipts : intersection_pts)
+      ipts.insert(ipts.end(), vecipts.begin(), vecipts.end());
+
+    result &= same_points(gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments), ipts);
+  }
+
+  if(!result)
+    std::cout << "parallel_sort_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool batch_kernel_test()
+{
+  bool result = true;
+
+// integer coordinates give many touching, parallel and collinear pairs
+  const bool integer_coords[] = { false, true };
+
+  for(bool ic : integer_coords)
+  {
+    std::vector<gde::geom::core::line_segment> red_segments = gen_segments(300, 41, 50.0, 10.0, ic);
+    std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(301, 42, 50.0, 10.0, ic);
+
+    gde::geom::algorithm::line_segment_soa blue_soa;
+
+    gde::geom::algorithm::build_line_segment_soa(blue_segments, blue_soa);
+
+    result &= (blue_soa.size() == blue_segments.size()) && (blue_soa.x1.size() % 4 == 0);
+
+    gde::geom::core::point ip1;
+    gde::geom::core::point ip2;
+    gde::geom::core::point ips[4];
+    gde::geom::core::point ips2[4];
+
+    for(const auto& red : red_segments)
+    {
+      for(std::size_t j = 0; j < blue_segments.size(); j += 4)
+      {
+        unsigned int parallel = 0;
+
+        unsigned int hits = gde::geom::algorithm::compute_intersection_x4(red, &blue_soa.x1[j], &blue_soa.y1[j],
+                                                                          &blue_soa.x2[j], &blue_soa.y2[j],
+                                                                          ips, parallel);
+
+// the pairs kernel with the same red segment in every lane must agree
+        const double rx1[4] = { red.p1.x, red.p1.x, red.p1.x, red.p1.x };
+        const double ry1[4] = { red.p1.y, red.p1.y, red.p1.y, red.p1.y };
+        const double rx2[4] = { red.p2.x, red.p2.x, red.p2.x, red.p2.x };
+        const double ry2[4] = { red.p2.y, red.p2.y, red.p2.y, red.p2.y };
+
+        unsigned int pairs_parallel = 0;
+
+        result &= (hits == gde::geom::algorithm::compute_intersection_pairs_x4(rx1, ry1, rx2, ry2,
+                                                                               &blue_soa.x1[j], &blue_soa.y1[j],
+                                                                               &blue_soa.x2[j], &blue_soa.y2[j],
+                                                                               ips2, pairs_parallel));
+        result &= (parallel == pairs_parallel);
+
+        for(std::size_t k = 0; k != 4; ++k)
+        {
+// padding segments never intersect
+          if(j + k >= blue_segments.size())
+          {
+            result &= ((hits | parallel) & (1u << k)) == 0;
+            continue;
+          }
+
+          gde::geom::algorithm::segment_relation_type rel = gde::geom::algorithm::compute_intesection_v3(red, blue_segments[j + k], ip1, ip2);
+
+          if(parallel & (1u << k))
+            continue;
+
+          const bool hit = (hits & (1u << k)) != 0;
+
+          result &= (hit == (rel != gde::geom::algorithm::DISJOINT));
+
+          if(hit)
+            result &= (ips[k].x == ip1.x) && (ips[k].y == ip1.y);
+        }
+      }
+    }
+
+// the batched brute force must find the same points as the scalar kernel on the pairs whose boxes intersect, overlaps included
+    std::vector<gde::geom::core::point> expected;
+
+    for(const auto& red : red_segments)
+    {
+      for(const auto& blue : blue_segments)
+      {
+        if(!gde::geom::algorithm::do_bounding_box_intersects(red, blue))
+          continue;
+
+        gde::geom::algorithm::segment_relation_type rel = gde::geom::algorithm::compute_intesection(red, blue, ip1, ip2);
+
+        if(rel != gde::geom::algorithm::DISJOINT)
+          expected.push_back(ip1);
+
+        if(rel == gde::geom::algorithm::OVERLAP)
+          expected.push_back(ip2);
+      }
+    }
+
+    result &= same_points(expected, gde::geom::algorithm::lazy_intersection_rb(red_segments, blue_segments));
+    result &= same_points(expected, gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments));
+  }
+
+  if(!result)
+    std::cout << "batch_kernel_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool lazy_rb_test()
+{
+  bool result = true;
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+  for(unsigned int seed = 1; seed != 4; ++seed)
+  {
+// segments that only touch by round-off: a pair must reach the kernel only if their boxes intersect
+    std::vector<gde::geom::core::line_segment> red_segments = gen_grid_segments(1000, seed, 10.0, 3.0, 0.1);
+    std::vector<gde::geom::core::line_segment> blue_segments = gen_grid_segments(1000, seed + 100, 10.0, 3.0, 0.1);
+
+    std::vector<gde::geom::core::point> ipts = gde::geom::algorithm::lazy_intersection_rb(red_segments, blue_segments);
+
+    result &= (ipts.size() == gde::geom::algorithm::lazy_intersection_rb_count(red_segments, blue_segments).total());
+
+    std::vector<std::vector<gde::geom::core::point> > thread_ipts;
+
+    gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool, thread_ipts);
+
+    std::vector<gde::geom::core::point> contiguous_ipts;
+
+    gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool, contiguous_ipts);
+
+    result &= same_points(ipts, flatten(thread_ipts));
+    result &= same_points(ipts, contiguous_ipts);
+    result &= (ipts.size() == gde::geom::algorithm::lazy_intersection_rb_count_thread(red_segments, blue_segments, pool).total());
+
+// the x-order algorithm orders each segment from left to right and passes the pairs in the order it finds them:
+// a touch found by round-off may depend on the order of the end-points and of the segments,
+// so it must find as many points as the brute force on the same ordered segments
+    std::transform(red_segments.begin(), red_segments.end(), red_segments.begin(), gde::geom::algorithm::sort_segment_xy());
+    std::transform(blue_segments.begin(), blue_segments.end(), blue_segments.begin(), gde::geom::algorithm::sort_segment_xy());
+
+    const std::size_t npts = gde::geom::algorithm::lazy_intersection_rb(red_segments, blue_segments).size();
+
+    result &= (npts == gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments).size());
+    result &= (npts == gde::geom::algorithm::x_order_intersection_rb_count(red_segments, blue_segments).total());
+  }
+
+  if(!result)
+    std::cout << "lazy_rb_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool x_order_window_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(2000, 51, 300.0, 20.0, true);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(2000, 52, 300.0, 20.0, true);
+
+  std::vector<std::pair<gde::geom::core::line_segment, gde::geom::core::color_type> > ordered_segments;
+
+  for(const auto& s : red_segments)
+    ordered_segments.push_back(std::make_pair(gde::geom::algorithm::sort_segment_xy()(s), gde::geom::core::RED));
+
+  for(const auto& s : blue_segments)
+    ordered_segments.push_back(std::make_pair(gde::geom::algorithm::sort_segment_xy()(s), gde::geom::core::BLUE));
+
+  std::sort(ordered_segments.begin(), ordered_segments.end(),
+            [](const std::pair<gde::geom::core::line_segment, gde::geom::core::color_type>& a,
+               const std::pair<gde::geom::core::line_segment, gde::geom::core::color_type>& b)
+            { return gde::geom::algorithm::line_segment_xy_cmp()(a.first, b.first); });
+
+  gde::geom::algorithm::x_order_window window;
+
+  gde::geom::algorithm::build_x_order_window(ordered_segments, window);
+
+  std::vector<std::uint32_t> candidates;
+
+// the filter must keep the same segments as the scalar tests of the x-order scan
+  for(std::size_t i = 0; i != ordered_segments.size(); ++i)
+  {
+    std::vector<std::uint32_t> expected;
+
+    for(std::size_t j = i + 1; j != ordered_segments.size(); ++j)
+    {
+      if(ordered_segments[i].first.p2.x < ordered_segments[j].first.p1.x)
+        break;
+
+      if((ordered_segments[i].second != ordered_segments[j].second) &&
+         gde::geom::algorithm::do_y_interval_intersects(ordered_segments[i].first, ordered_segments[j].first))
+        expected.push_back(static_cast<std::uint32_t>(j));
+    }
+
+    gde::geom::algorithm::x_order_candidates(window, i, candidates);
+
+    result &= (candidates == expected);
+  }
+
+  if(!result)
+    std::cout << "x_order_window_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool branchless_kernel_test()
+{
+  bool result = true;
+
+  const bool integer_coords[] = { false, true };
+
+  for(bool ic : integer_coords)
+  {
+    std::vector<gde::geom::core::line_segment> segments = gen_segments(600, 61, 50.0, 10.0, ic);
+
+    gde::geom::core::point ip1, ip2;
+    gde::geom::core::point bp1, bp2;
+
+    for(const auto& s1 : segments)
+    {
+      for(const auto& s2 : segments)
+      {
+        gde::geom::algorithm::segment_relation_type rel = gde::geom::algorithm::compute_intesection_v3(s1, s2, ip1, ip2);
+        gde::geom::algorithm::segment_relation_type brel = gde::geom::algorithm::compute_intesection_branchless(s1, s2, bp1, bp2);
+
+        result &= (rel == brel);
+
+        if(rel != gde::geom::algorithm::DISJOINT)
+          result &= (ip1.x == bp1.x) && (ip1.y == bp1.y);
+
+        if(rel == gde::geom::algorithm::OVERLAP)
+          result &= (ip2.x == bp2.x) && (ip2.y == bp2.y);
+      }
+    }
+  }
+
+  if(!result)
+    std::cout << "branchless_kernel_test: FAILED" << std::endl;
+
+  return result;
+}
+
+// the paths that test pairs in batches must give the points of the kernel selected at compile time,
+// pair by pair and in the same order, whichever kernel it is
+bool selected_kernel_test()
+{
+  bool result = true;
+
+  gde::geom::algorithm::thread_pool pool(1);
+
+  const bool grid_coords[] = { true, false };
+
+  for(bool gc : grid_coords)
+  {
+    std::vector<gde::geom::core::line_segment> red_segments = gc ? gen_grid_segments(600, 71, 10.0, 3.0, 0.1) : gen_segments(600, 71, 50.0, 10.0, false);
+    std::vector<gde::geom::core::line_segment> blue_segments = gc ? gen_grid_segments(600, 72, 10.0, 3.0, 0.1) : gen_segments(600, 72, 50.0, 10.0, false);
+
+// the brute force
+    std::vector<gde::geom::core::point> expected;
+
+    gde::geom::algorithm::point_vector_sink sink = { &expected };
+
+    gde::geom::algorithm::lazy_rb_intersection_core<gde::geom::algorithm::default_kernel,
+                                                    gde::geom::algorithm::bbox_test>(red_segments, 0, red_segments.size(), blue_segments, sink);
+
+    result &= (gde::geom::algorithm::lazy_intersection_rb(red_segments, blue_segments) == expected);
+
+    std::vector<std::vector<gde::geom::core::point> > thread_ipts;
+
+    gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool, thread_ipts);
+
+    result &= (flatten(thread_ipts) == expected);
+
+// the x-order scan
+    std::vector<gde::geom::core::line_segment> segments;
+    std::vector<std::uint32_t> order;
+
+    gde::geom::algorithm::prepare_ordered_segments(red_segments, blue_segments, segments, order);
+
+    std::vector<gde::geom::core::line_segment> ordered_segments(segments.size());
+
+    std::transform(order.begin(), order.end(), ordered_segments.begin(), gde::geom::algorithm::gather_ordered_segment{&segments});
+
+    expected.clear();
+
+    gde::geom::algorithm::x_order_rb_intersection_core<gde::geom::algorithm::default_kernel,
+                                                       gde::geom::algorithm::y_interval_test>(ordered_segments, order, red_segments.size(),
+                                                                                              0, ordered_segments.size(), sink);
+
+    result &= (gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments) == expected);
+
+    std::vector<gde::geom::core::point> ipts;
+
+    gde::geom::algorithm::x_order_intersection_rb(segments, red_segments.size(), order.data(), order.data() + order.size(), ipts);
+
+    result &= (ipts == expected);
+
+    thread_ipts.clear();
+
+    gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool, thread_ipts);
+
+    result &= (flatten(thread_ipts) == expected);
+  }
+
+  if(!result)
+    std::cout << "selected_kernel_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool policy_core_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> segments = gen_segments(800, 67, 100.0, 10.0, false);
+
+  std::vector<gde::geom::core::point> expected = gde::geom::algorithm::lazy_intersection(segments);
+
+  gde::geom::algorithm::point_count_sink counter = { 0 };
+
+  gde::geom::algorithm::lazy_intersection_core<gde::geom::algorithm::kernel_v3,
+                                               gde::geom::algorithm::bbox_test>(segments, 0, segments.size(), counter);
+
+  result &= (counter.count == expected.size());
+
+  std::vector<gde::geom::core::point> ipts;
+  gde::geom::algorithm::point_vector_sink sink = { &ipts };
+
+  gde::geom::algorithm::lazy_intersection_core<gde::geom::algorithm::kernel_branchless,
+                                               gde::geom::algorithm::no_bbox_test>(segments, 0, segments.size(), sink);
+
+  result &= same_points(ipts, expected);
+
+  std::vector<gde::geom::core::line_segment> ordered_segments(segments.size());
+
+  std::transform(segments.begin(), segments.end(), ordered_segments.begin(), gde::geom::algorithm::sort_segment_xy());
+  std::sort(ordered_segments.begin(), ordered_segments.end(), gde::geom::algorithm::line_segment_xy_cmp());
+
+  ipts.clear();
+
+  gde::geom::algorithm::x_order_intersection_core<gde::geom::algorithm::kernel_v2,
+                                                  gde::geom::algorithm::y_interval_test>(ordered_segments, 0, ordered_segments.size(), sink);
+
+  result &= same_points(ipts, expected);
+
+  if(!result)
+    std::cout << "policy_core_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool robust_predicates_test()
+{
+  bool result = true;
+
+// a = (0.5 + i * ulp, 0.5 + j * ulp) is to the left of the line from b to c if j > i
+  const double ulp = std::ldexp(1.0, -53);
+
+  gde::geom::core::point b = { 12.0, 12.0 };
+  gde::geom::core::point c = { 24.0, 24.0 };
+
+  for(int i = 0; i != 32; ++i)
+  {
+    for(int j = 0; j != 32; ++j)
+    {
+      gde::geom::core::point a = { 0.5 + i * ulp, 0.5 + j * ulp };
+
+      double o = gde::geom::algorithm::orient2d(b, c, a);
+
+      int expected = (j > i) ? 1 : ((j < i) ? -1 : 0);
+      int sign = (o > 0.0) ? 1 : ((o < 0.0) ? -1 : 0);
+
+      result &= (sign == expected);
+    }
+  }
+
+// a segment going up from p = (12 + i * ulp, 12 + j * ulp) only touches the diagonal if i == j
+  const double ulp12 = std::ldexp(1.0, -49);
+
+  gde::geom::core::point d1 = { 0.5, 0.5 };
+  gde::geom::core::point d2 = { 24.0, 24.0 };
+  gde::geom::core::point top = { 12.0, 30.0 };
+
+  gde::geom::core::line_segment diagonal(d1, d2);
+
+  for(int i = 0; i != 16; ++i)
+  {
+    for(int j = 0; j != 16; ++j)
+    {
+      gde::geom::core::point p = { 12.0 + i * ulp12, 12.0 + j * ulp12 };
+
+      gde::geom::core::line_segment s(p, top);
+
+      gde::geom::core::point ip1, ip2;
+
+      gde::geom::algorithm::segment_relation_type rel = gde::geom::algorithm::compute_intesection_robust(diagonal, s, ip1, ip2);
+
+      if(j > i)
+        result &= (rel == gde::geom::algorithm::DISJOINT);
+      else if(j == i)
+        result &= (rel == gde::geom::algorithm::TOUCH) && (ip1.x == p.x) && (ip1.y == p.y);
+      else
+        result &= (rel == gde::geom::algorithm::CROSS);
+
+      result &= (gde::geom::algorithm::do_intersects_robust(diagonal, s) == (j <= i));
+    }
+  }
+
+// on general data it finds the same intersections as compute_intesection_v3
+  std::vector<gde::geom::core::line_segment> segments = gen_segments(600, 71, 50.0, 10.0, false);
+
+  for(const auto& s1 : segments)
+  {
+    for(const auto& s2 : segments)
+    {
+      gde::geom::core::point ip1, ip2;
+      gde::geom::core::point rp1, rp2;
+
+      gde::geom::algorithm::segment_relation_type rel = gde::geom::algorithm::compute_intesection_v3(s1, s2, ip1, ip2);
+      gde::geom::algorithm::segment_relation_type rrel = gde::geom::algorithm::compute_intesection_robust(s1, s2, rp1, rp2);
+
+      result &= ((rel == gde::geom::algorithm::DISJOINT) == (rrel == gde::geom::algorithm::DISJOINT));
+
+      if(rel != gde::geom::algorithm::DISJOINT)
+        result &= (std::fabs(ip1.x - rp1.x) < 1.0e-9) && (std::fabs(ip1.y - rp1.y) < 1.0e-9);
+    }
+  }
+
+  if(!result)
+    std::cout << "robust_predicates_test: FAILED" << std::endl;
+
+  return result;
+}
+
+// check the records against the segments and give them as sorted (first, second, relation) keys
+bool
+check_intersection_pairs(const std::vector<gde::geom::algorithm::intersection_pair>& pairs,
+                         const std::vector<gde::geom::core::line_segment>& red_segments,
+                         const std::vector<gde::geom::core::line_segment>& blue_segments,
+                         std::vector<std::uint64_t>& keys)
+{
+  bool result = true;
+
+  keys.clear();
+
+  for(const gde::geom::algorithm::intersection_pair& ip : pairs)
+  {
+    const gde::geom::core::line_segment& red = red_segments[ip.red_index];
+    const gde::geom::core::line_segment& blue = blue_segments[ip.blue_index];
+
+    gde::geom::core::point p1, p2;
+
+    result &= (gde::geom::algorithm::compute_intesection(red, blue, p1, p2) == ip.relation);
+
+// the parameters must give the same point on both segments
+    const double rx = red.p1.x + ip.t_red * (red.p2.x - red.p1.x);
+    const double ry = red.p1.y + ip.t_red * (red.p2.y - red.p1.y);
+    const double bx = blue.p1.x + ip.t_blue * (blue.p2.x - blue.p1.x);
+    const double by = blue.p1.y + ip.t_blue * (blue.p2.y - blue.p1.y);
+
+    result &= (std::fabs(rx - bx) < 1.0e-7) && (std::fabs(ry - by) < 1.0e-7);
+    result &= (ip.t_red > -1.0e-9) && (ip.t_red < 1.0 + 1.0e-9) && (ip.t_blue > -1.0e-9) && (ip.t_blue < 1.0 + 1.0e-9);
+
+    keys.push_back((static_cast<std::uint64_t>(ip.red_index) << 34) | (static_cast<std::uint64_t>(ip.blue_index) << 2) | ip.relation);
+  }
+
+  std::sort(keys.begin(), keys.end());
+
+  return result;
+}
+
+bool intersection_pairs_test()
+{
+  bool result = true;
+
+// integer coordinates give many touches and overlaps
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(1500, 93, 200.0, 12.0, true);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(1500, 94, 200.0, 12.0, true);
+
+  std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+  all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+  const std::size_t npts = gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments).size();
+
+  std::vector<gde::geom::algorithm::intersection_pair> lazy_pairs = gde::geom::algorithm::lazy_intersection_rb_pairs(red_segments, blue_segments);
+  std::vector<gde::geom::algorithm::intersection_pair> x_order_pairs = gde::geom::algorithm::x_order_intersection_rb_pairs(red_segments, blue_segments);
+  std::vector<gde::geom::algorithm::intersection_pair> grid_pairs =
+    gde::geom::algorithm::fixed_grid_intersection_rb_pairs(red_segments, blue_segments,
+                                                           10.0, 10.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+
+  result &= (lazy_pairs.size() == npts) && (x_order_pairs.size() == npts) && (grid_pairs.size() == npts);
+
+  std::vector<std::uint64_t> expected;
+  std::vector<std::uint64_t> keys;
+
+  result &= check_intersection_pairs(lazy_pairs, red_segments, blue_segments, expected);
+  result &= check_intersection_pairs(x_order_pairs, red_segments, blue_segments, keys) && (keys == expected);
+  result &= check_intersection_pairs(grid_pairs, red_segments, blue_segments, keys) && (keys == expected);
+
+// a single set: indexes must survive the left-right ordering of the x-order algorithm
+  lazy_pairs = gde::geom::algorithm::lazy_intersection_pairs(all_segments);
+  x_order_pairs = gde::geom::algorithm::x_order_intersection_pairs(all_segments);
+
+  result &= (x_order_pairs.size() == gde::geom::algorithm::x_order_intersection(all_segments).size());
+
+  for(const gde::geom::algorithm::intersection_pair& ip : x_order_pairs)
+    result &= (ip.red_index < ip.blue_index);
+
+  result &= check_intersection_pairs(lazy_pairs, all_segments, all_segments, expected);
+  result &= check_intersection_pairs(x_order_pairs, all_segments, all_segments, keys) && (keys == expected);
+
+  if(!result)
+    std::cout << "intersection_pairs_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool intersection_count_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(1500, 95, 200.0, 12.0, true);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(1500, 96, 200.0, 12.0, true);
+
+  std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+  all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+// a single set
+  gde::geom::algorithm::intersection_count expected = gde::geom::algorithm::lazy_intersection_count(all_segments);
+
+  result &= (expected.total() == gde::geom::algorithm::lazy_intersection(all_segments).size());
+  result &= (expected.relations[gde::geom::algorithm::DISJOINT] == 0);
+  result &= (expected.relations[gde::geom::algorithm::TOUCH] != 0) && (expected.relations[gde::geom::algorithm::OVERLAP] != 0);
+
+  auto same_count = [](const gde::geom::algorithm::intersection_count& lhs,
+                       const gde::geom::algorithm::intersection_count& rhs)
+                    {
+                      return std::equal(lhs.relations, lhs.relations + 4, rhs.relations);
+                    };
+
+  result &= same_count(expected, gde::geom::algorithm::lazy_intersection_count_thread(all_segments, pool));
+  result &= same_count(expected, gde::geom::algorithm::x_order_intersection_count(all_segments));
+  result &= same_count(expected, gde::geom::algorithm::x_order_intersection_count_thread(all_segments, pool));
+
+// red and blue sets: the same relations as the pairs of segments
+  expected = gde::geom::algorithm::intersection_count();
+
+  for(const gde::geom::algorithm::intersection_pair& ip : gde::geom::algorithm::lazy_intersection_rb_pairs(red_segments, blue_segments))
+    ++expected.relations[ip.relation];
+
+  result &= (expected.total() == gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments).size());
+
+  result &= same_count(expected, gde::geom::algorithm::lazy_intersection_rb_count(red_segments, blue_segments));
+  result &= same_count(expected, gde::geom::algorithm::lazy_intersection_rb_count_thread(red_segments, blue_segments, pool));
+  result &= same_count(expected, gde::geom::algorithm::x_order_intersection_rb_count(red_segments, blue_segments));
+  result &= same_count(expected, gde::geom::algorithm::x_order_intersection_rb_count_thread(red_segments, blue_segments, pool));
+  result &= same_count(expected, gde::geom::algorithm::fixed_grid_intersection_rb_count(red_segments, blue_segments,
+                                                                                        10.0, 10.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+  result &= same_count(expected, gde::geom::algorithm::fixed_grid_intersection_rb_count_thread(red_segments, blue_segments, pool,
+                                                                                               10.0, 10.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+  result &= same_count(expected, gde::geom::algorithm::tiling_intersection_rb_count(red_segments, blue_segments,
+                                                                                    25.0, 25.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+  result &= same_count(expected, gde::geom::algorithm::tiling_intersection_rb_count_thread(red_segments, blue_segments, pool,
+                                                                                           25.0, 25.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+  result &= same_count(expected, gde::geom::algorithm::tiling_intersection_rb_count(red_segments, blue_segments,
+                                                                                    25.0, r.ll.y, r.ur.y));
+  result &= same_count(expected, gde::geom::algorithm::tiling_intersection_rb_count_thread(red_segments, blue_segments, pool,
+                                                                                           25.0, r.ll.y, r.ur.y));
+
+  if(!result)
+    std::cout << "intersection_count_test: FAILED" << std::endl;
+
+  return result;
+}
+
+// the points of every algorithm must agree with its count, whatever kernel the build selects:
+// a path that tests its pairs with another kernel gives a different number of touches
+bool points_count_test()
+{
+  bool result = true;
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+  auto agree = [&result](const char* name, std::size_t npoints, const gde::geom::algorithm::intersection_count& count)
+               {
+                 if(npoints == count.total())
+                   return;
+
+                 std::cout << name << ": " << npoints << " points x " << count.total() << " counted" << std::endl;
+
+                 result = false;
+               };
+
+// many touches found by round-off, and integer coordinates with shared end-points and overlaps
+  const bool grid_coords[] = { true, false };
+
+  for(bool gc : grid_coords)
+  {
+    std::vector<gde::geom::core::line_segment> red_segments = gc ? gen_grid_segments(800, 21, 10.0, 3.0, 0.1) : gen_segments(800, 21, 64.0, 6.0, true);
+    std::vector<gde::geom::core::line_segment> blue_segments = gc ? gen_grid_segments(800, 22, 10.0, 3.0, 0.1) : gen_segments(800, 22, 64.0, 6.0, true);
+
+    std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+    all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+    gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+    const double dx = (r.ur.x - r.ll.x) / 8.0;
+    const double dy = (r.ur.y - r.ll.y) / 8.0;
+
+// the per-thread versions append to the output
+    std::vector<std::vector<gde::geom::core::point> > thread_ipts;
+    std::vector<gde::geom::core::point> ipts;
+
+// a single set
+    gde::geom::algorithm::intersection_count count = gde::geom::algorithm::lazy_intersection_count(all_segments);
+
+    agree("lazy_intersection", gde::geom::algorithm::lazy_intersection(all_segments).size(), count);
+    agree("lazy_intersection_count_thread", gde::geom::algorithm::lazy_intersection(all_segments).size(),
+          gde::geom::algorithm::lazy_intersection_count_thread(all_segments, pool));
+
+    thread_ipts.clear();
+    gde::geom::algorithm::lazy_intersection_thread(all_segments, pool, thread_ipts);
+    agree("lazy_intersection_thread", flatten(thread_ipts).size(), count);
+
+    gde::geom::algorithm::lazy_intersection_thread(all_segments, pool, ipts);
+    agree("lazy_intersection_thread (contiguous)", ipts.size(), count);
+
+    count = gde::geom::algorithm::x_order_intersection_count(all_segments);
+
+    agree("x_order_intersection", gde::geom::algorithm::x_order_intersection(all_segments).size(), count);
+    agree("x_order_intersection_count_thread", gde::geom::algorithm::x_order_intersection(all_segments).size(),
+          gde::geom::algorithm::x_order_intersection_count_thread(all_segments, pool));
+
+    thread_ipts.clear();
+    gde::geom::algorithm::x_order_intersection_thread(all_segments, pool, thread_ipts);
+    agree("x_order_intersection_thread", flatten(thread_ipts).size(), count);
+
+    gde::geom::algorithm::x_order_intersection_thread(all_segments, pool, ipts);
+    agree("x_order_intersection_thread (contiguous)", ipts.size(), count);
+
+// red and blue sets
+    count = gde::geom::algorithm::lazy_intersection_rb_count(red_segments, blue_segments);
+
+    agree("lazy_intersection_rb", gde::geom::algorithm::lazy_intersection_rb(red_segments, blue_segments).size(), count);
+    agree("lazy_intersection_rb_count_thread", gde::geom::algorithm::lazy_intersection_rb(red_segments, blue_segments).size(),
+          gde::geom::algorithm::lazy_intersection_rb_count_thread(red_segments, blue_segments, pool));
+
+    thread_ipts.clear();
+    gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool, thread_ipts);
+    agree("lazy_intersection_rb_thread", flatten(thread_ipts).size(), count);
+
+    gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool, ipts);
+    agree("lazy_intersection_rb_thread (contiguous)", ipts.size(), count);
+
+    count = gde::geom::algorithm::x_order_intersection_rb_count(red_segments, blue_segments);
+
+    agree("x_order_intersection_rb", gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments).size(), count);
+    agree("x_order_intersection_rb_count_thread", gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments).size(),
+          gde::geom::algorithm::x_order_intersection_rb_count_thread(red_segments, blue_segments, pool));
+
+    thread_ipts.clear();
+    gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool, thread_ipts);
+    agree("x_order_intersection_rb_thread", flatten(thread_ipts).size(), count);
+
+    gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool, ipts);
+    agree("x_order_intersection_rb_thread (contiguous)", ipts.size(), count);
+
+    count = gde::geom::algorithm::fixed_grid_intersection_rb_count(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+
+    agree("fixed_grid_intersection_rb",
+          gde::geom::algorithm::fixed_grid_intersection_rb(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y).size(), count);
+    agree("fixed_grid_intersection_rb_count_thread",
+          gde::geom::algorithm::fixed_grid_intersection_rb(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y).size(),
+          gde::geom::algorithm::fixed_grid_intersection_rb_count_thread(red_segments, blue_segments, pool, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+
+    thread_ipts.clear();
+    gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y, thread_ipts);
+    agree("fixed_grid_intersection_rb_thread", flatten(thread_ipts).size(), count);
+
+    gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
+    agree("fixed_grid_intersection_rb_thread (contiguous)", ipts.size(), count);
+
+    count = gde::geom::algorithm::tiling_intersection_rb_count(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+
+    agree("tiling_intersection_rb",
+          gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y).size(), count);
+    agree("tiling_intersection_rb_count_thread",
+          gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y).size(),
+          gde::geom::algorithm::tiling_intersection_rb_count_thread(red_segments, blue_segments, pool, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y));
+
+    thread_ipts.clear();
+    gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y, thread_ipts);
+    agree("tiling_intersection_rb_thread", flatten(thread_ipts).size(), count);
+
+    gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
+    agree("tiling_intersection_rb_thread (contiguous)", ipts.size(), count);
+
+    count = gde::geom::algorithm::tiling_intersection_rb_count(red_segments, blue_segments, dy, r.ll.y, r.ur.y);
+
+    agree("tiling_intersection_rb (1D)",
+          gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments, dy, r.ll.y, r.ur.y).size(), count);
+    agree("tiling_intersection_rb_count_thread (1D)",
+          gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments, dy, r.ll.y, r.ur.y).size(),
+          gde::geom::algorithm::tiling_intersection_rb_count_thread(red_segments, blue_segments, pool, dy, r.ll.y, r.ur.y));
+
+    thread_ipts.clear();
+    gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool, dy, r.ll.y, r.ur.y, thread_ipts);
+    agree("tiling_intersection_rb_thread (1D)", flatten(thread_ipts).size(), count);
+
+    gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool, dy, r.ll.y, r.ur.y, ipts);
+    agree("tiling_intersection_rb_thread (1D, contiguous)", ipts.size(), count);
+
+    count = gde::geom::algorithm::rtree_intersection_rb_count(red_segments, blue_segments);
+
+    agree("rtree_intersection_rb", gde::geom::algorithm::rtree_intersection_rb(red_segments, blue_segments).size(), count);
+
+    gde::geom::algorithm::rtree_intersection_rb_thread(red_segments, blue_segments, pool, gde::geom::algorithm::rtree_node_capacity, ipts);
+    agree("rtree_intersection_rb_thread", ipts.size(), count);
+
+    count = gde::geom::algorithm::quadtree_intersection_rb_count(red_segments, blue_segments);
+
+    agree("quadtree_intersection_rb", gde::geom::algorithm::quadtree_intersection_rb(red_segments, blue_segments).size(), count);
+
+    gde::geom::algorithm::quadtree_intersection_rb_thread(red_segments, blue_segments, pool, gde::geom::algorithm::quadtree_leaf_capacity, ipts);
+    agree("quadtree_intersection_rb_thread", ipts.size(), count);
+
+    count = gde::geom::algorithm::multilevel_grid_intersection_rb_count(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+
+    agree("multilevel_grid_intersection_rb",
+          gde::geom::algorithm::multilevel_grid_intersection_rb(red_segments, blue_segments, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y).size(), count);
+
+    gde::geom::algorithm::multilevel_grid_intersection_rb_thread(red_segments, blue_segments, pool, dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
+    agree("multilevel_grid_intersection_rb_thread", ipts.size(), count);
+
+    count = gde::geom::algorithm::trapezoid_sweep_intersection_rb_count(red_segments, blue_segments);
+
+    agree("trapezoid_sweep_intersection_rb", gde::geom::algorithm::trapezoid_sweep_intersection_rb(red_segments, blue_segments).size(), count);
+  }
+
+  if(!result)
+    std::cout << "points_count_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool intersection_visitor_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(2000, 97, 300.0, 15.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(2000, 98, 300.0, 15.0, false);
+
+  std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+  all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+// a callback receives the points and the pairs of segments
+  std::vector<gde::geom::core::point> ipts;
+  std::vector<gde::geom::algorithm::intersection_pair> pairs;
+
+  gde::geom::algorithm::callback_visitor callback([&ipts, &pairs, &all_segments](gde::geom::algorithm::segment_relation_type relation,
+                                                                                  const gde::geom::core::point& p,
+                                                                                  std::size_t i, std::size_t j)
+                                                  {
+                                                    gde::geom::algorithm::intersection_pair ip = { static_cast<std::uint32_t>(i),
+                                                                                                   static_cast<std::uint32_t>(j),
+                                                                                                   relation,
+                                                                                                   gde::geom::algorithm::segment_parameter(all_segments[i], p),
+                                                                                                   gde::geom::algorithm::segment_parameter(all_segments[j], p) };
+                                                    ipts.push_back(p);
+                                                    pairs.push_back(ip);
+                                                  });
+
+  gde::geom::algorithm::x_order_intersection(all_segments, callback);
+
+  result &= same_points(ipts, gde::geom::algorithm::x_order_intersection(all_segments));
+  std::vector<std::uint64_t> expected_keys;
+  std::vector<std::uint64_t> keys;
+
+  result &= check_intersection_pairs(gde::geom::algorithm::x_order_intersection_pairs(all_segments), all_segments, all_segments, expected_keys);
+  result &= check_intersection_pairs(pairs, all_segments, all_segments, keys) && (keys == expected_keys);
+
+  std::vector<gde::geom::core::point> expected = gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments);
+
+// a small ring buffer between the workers of the pool and a consumer thread
+  gde::geom::algorithm::point_ring_buffer ring(16);
+
+  ipts.clear();
+
+  std::thread consumer([&ring, &ipts]
+                       {
+                         gde::geom::core::point p;
+
+                         while(ring.pop(p))
+                           ipts.push_back(p);
+                       });
+
+  gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool, ring);
+
+  ring.close();
+
+  consumer.join();
+
+  result &= same_points(ipts, expected);
+
+// a consumer that stops early: the workers blocked on the full buffer must not wait forever
+  gde::geom::algorithm::point_ring_buffer small_ring(1);
+
+  std::size_t npopped = 0;
+
+  std::thread early_consumer([&small_ring, &npopped]
+                             {
+                               gde::geom::core::point p;
+
+                               while((npopped != 3) && small_ring.pop(p))
+                                 ++npopped;
+
+                               small_ring.close();
+                             });
+
+  gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool, small_ring);
+
+  early_consumer.join();
+
+  result &= (expected.size() > 3) && (npopped == 3);
+
+// a file shared by the workers
+  const std::string file_name = "gde_unittest_intersection_visitor.bin";
+
+  {
+    gde::geom::algorithm::point_file_writer writer(file_name);
+
+    gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool,
+                                                            20.0, 20.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, writer);
+
+    writer.flush();
+
+    result &= (writer.size() == expected.size());
+  }
+
+  ipts.clear();
+
+  std::FILE* file = std::fopen(file_name.c_str(), "rb");
+
+  double xy[2];
+
+  while((file != nullptr) && (std::fread(xy, sizeof(double), 2, file) == 2))
+  {
+    gde::geom::core::point p = { xy[0], xy[1] };
+
+    ipts.push_back(p);
+  }
+
+  if(file != nullptr)
+    std::fclose(file);
+
+  std::remove(file_name.c_str());
+
+  result &= same_points(ipts, expected);
+
+  if(!result)
+    std::cout << "intersection_visitor_test: FAILED" << std::endl;
+
+  return result;
+}
+
+// a scan for count_then_fill that gives each item a number of points in the first ncount_calls calls and another number after them
+struct two_pass_scan
+{
+  std::atomic<std::size_t>* calls;
+  std::size_t ncount_calls;
+  std::size_t counted;
+  std::size_t written;
+
+  template<class Sink>
+  void operator()(std::size_t first, std::size_t last, Sink& sink) const
+  {
+    const std::size_t npoints = (calls->fetch_add(1) < ncount_calls) ? counted : written;
+
+    const gde::geom::core::point p = { 0.0, 0.0 };
+
+    for(std::size_t i = first; i != last; ++i)
+      for(std::size_t k = 0; k != npoints; ++k)
+        sink(gde::geom::algorithm::CROSS, p, i, i);
+  }
+};
+
+bool count_then_fill_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(2000, 99, 300.0, 15.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(2000, 100, 300.0, 15.0, false);
+
+  std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+  all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+  gde::geom::algorithm::thread_pool pool1(1);
+  gde::geom::algorithm::thread_pool pool3(3);
+
+// the same points as the per-thread output and, for any number of threads, in the same order
+  auto check = [&result](const std::vector<std::vector<gde::geom::core::point> >& expected,
+                                   const std::vector<gde::geom::core::point>& ipts1,
+                                   const std::vector<gde::geom::core::point>& ipts3)
+               {
+                 result &= same_points(ipts3, flatten(expected));
+
+                 result &= (ipts1.size() == ipts3.size());
+
+                 for(std::size_t i = 0; (i != ipts1.size()) && (i != ipts3.size()); ++i)
+                   result &= (ipts1[i].x == ipts3[i].x) && (ipts1[i].y == ipts3[i].y);
+               };
+
+  std::vector<std::vector<gde::geom::core::point> > expected;
+  std::vector<gde::geom::core::point> ipts1;
+  std::vector<gde::geom::core::point> ipts3;
+
+  gde::geom::algorithm::lazy_intersection_thread(all_segments, pool3, expected);
+  gde::geom::algorithm::lazy_intersection_thread(all_segments, pool1, ipts1);
+  gde::geom::algorithm::lazy_intersection_thread(all_segments, pool3, ipts3);
+  check(expected, ipts1, ipts3);
+
+  expected.clear();
+  gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool3, expected);
+  gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool1, ipts1);
+  gde::geom::algorithm::lazy_intersection_rb_thread(red_segments, blue_segments, pool3, ipts3);
+  check(expected, ipts1, ipts3);
+
+  expected.clear();
+  gde::geom::algorithm::x_order_intersection_thread(all_segments, pool3, expected);
+  gde::geom::algorithm::x_order_intersection_thread(all_segments, pool1, ipts1);
+  gde::geom::algorithm::x_order_intersection_thread(all_segments, pool3, ipts3);
+  check(expected, ipts1, ipts3);
+
+  expected.clear();
+  gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool3, expected);
+  gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool1, ipts1);
+  gde::geom::algorithm::x_order_intersection_rb_thread(red_segments, blue_segments, pool3, ipts3);
+  check(expected, ipts1, ipts3);
+
+  expected.clear();
+  gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool3,
+                                                          20.0, 20.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, expected);
+  gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool1,
+                                                          20.0, 20.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts1);
+  gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool3,
+                                                          20.0, 20.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts3);
+  check(expected, ipts1, ipts3);
+
+  expected.clear();
+  gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool3,
+                                                      50.0, 50.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, expected);
+  gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool1,
+                                                      50.0, 50.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts1);
+  gde::geom::algorithm::tiling_intersection_rb_thread(red_segments, blue_segments, pool3,
+                                                      50.0, 50.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts3);
+  check(expected, ipts1, ipts3);
+
+// a scan that doesn't write what it counted: 10 items in 2 units, counted in the first 2 calls
+  const std::size_t written_points[] = { 1, 2, 0 };
+
+  for(std::size_t written : written_points)
+  {
+    std::atomic<std::size_t> calls(0);
+
+    two_pass_scan scan = { &calls, 2, 1, written };
+
+    bool thrown = false;
+
+    try
+    {
+      gde::geom::algorithm::count_then_fill(pool3, 10, scan, ipts3, 5);
+    }
+    catch(const std::logic_error&)
+    {
+      thrown = true;
+    }
+
+    result &= (thrown == (written != 1));
+    result &= thrown || (ipts3.size() == 10);
+  }
+
+  if(!result)
+    std::cout << "count_then_fill_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool resolution_planner_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(3000, 101, 500.0, 10.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, 102, 500.0, 10.0, false);
+
+  std::vector<gde::geom::core::line_segment> all_segments(red_segments);
+  all_segments.insert(all_segments.end(), blue_segments.begin(), blue_segments.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(all_segments.begin(), all_segments.end());
+
+// the plans stay inside the budget of cells and describe the grid the algorithms build
+  gde::geom::algorithm::resolution_plan plan = gde::geom::algorithm::plan_fixed_grid_resolution(red_segments, blue_segments,
+                                                                                                r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+
+  result &= (plan.dx > 0.0) && (plan.dy > 0.0) && (plan.cost > 0.0);
+  result &= (plan.ncols * plan.nrows <= 4 * all_segments.size());
+
+  gde::geom::algorithm::grid_index grid;
+
+  gde::geom::algorithm::build_grid_index(blue_segments, plan.dx, plan.dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y, grid);
+
+  result &= (grid.ncols == plan.ncols) && (grid.nrows == plan.nrows);
+
+// short segments: neither a single cell nor the finest grid
+  result &= (plan.ncols * plan.nrows > 1) && (plan.ncols * plan.nrows < 4 * all_segments.size());
+
+  plan = gde::geom::algorithm::plan_tile_height(red_segments, blue_segments, r.ll.y, r.ur.y);
+
+  result &= (plan.ncols == 1) && (plan.nrows > 1) && (plan.dy > 0.0);
+
+// long horizontal segments get wider cells than taller ones
+  std::vector<gde::geom::core::line_segment> horizontal_segments;
+
+  for(const gde::geom::core::line_segment& s : all_segments)
+  {
+    gde::geom::core::point p2 = { s.p1.x + 20.0 * (s.p2.x - s.p1.x), s.p1.y };
+
+    if(!(p2 == s.p1))
+      horizontal_segments.push_back(gde::geom::core::line_segment(s.p1, p2));
+  }
+
+  gde::geom::core::rectangle hr = gde::geom::algorithm::compute_rectangle(horizontal_segments.begin(), horizontal_segments.end());
+
+  plan = gde::geom::algorithm::plan_fixed_grid_resolution(horizontal_segments, horizontal_segments, hr.ll.x, hr.ur.x, hr.ll.y, hr.ur.y);
+
+  result &= (plan.dx > plan.dy);
+
+// the algorithms give the same points with an automatic resolution
+  std::vector<gde::geom::core::point> expected = gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments);
+
+  result &= same_points(gde::geom::algorithm::fixed_grid_intersection_rb(red_segments, blue_segments,
+                                                                         gde::geom::algorithm::auto_resolution, gde::geom::algorithm::auto_resolution,
+                                                                         r.ll.x, r.ur.x, r.ll.y, r.ur.y), expected);
+
+  result &= same_points(gde::geom::algorithm::fixed_grid_intersection_rb(red_segments, blue_segments,
+                                                                         10.0, gde::geom::algorithm::auto_resolution,
+                                                                         r.ll.x, r.ur.x, r.ll.y, r.ur.y), expected);
+
+  result &= same_points(gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments,
+                                                                     gde::geom::algorithm::auto_resolution, gde::geom::algorithm::auto_resolution,
+                                                                     r.ll.x, r.ur.x, r.ll.y, r.ur.y), expected);
+
+  result &= same_points(gde::geom::algorithm::tiling_intersection_rb(red_segments, blue_segments,
+                                                                     gde::geom::algorithm::auto_resolution, r.ll.y, r.ur.y), expected);
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+  std::vector<gde::geom::core::point> ipts;
+
+  gde::geom::algorithm::fixed_grid_intersection_rb_thread(red_segments, blue_segments, pool,
+                                                          gde::geom::algorithm::auto_resolution, gde::geom::algorithm::auto_resolution,
+                                                          r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
+
+  result &= same_points(ipts, expected);
+
+  if(!result)
+    std::cout << "resolution_planner_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool intersection_selector_test()
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(3000, 111, 500.0, 10.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, 112, 500.0, 10.0, false);
+
+  std::vector<gde::geom::core::point> expected = gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments);
+
+// the chosen algorithm and each of the algorithms, serial and threaded, give the same points
+  gde::geom::algorithm::intersection_options options;
+  gde::geom::algorithm::intersection_selection selection;
+
+  result &= same_points(gde::geom::algorithm::intersection_rb(red_segments, blue_segments, options, selection), expected);
+  result &= (selection.algorithm != gde::geom::algorithm::AUTO_ALGORITHM) && (selection.nthreads == 1);
+  result &= (selection.cost > 0.0) && (selection.cost == selection.costs[selection.algorithm]);
+
+  for(int a = gde::geom::algorithm::LAZY_ALGORITHM; a <= gde::geom::algorithm::TILING_ALGORITHM; ++a)
+  {
+    for(std::size_t nthreads = 1; nthreads <= 3; nthreads += 2)
+    {
+      options.algorithm = static_cast<gde::geom::algorithm::intersection_algorithm_type>(a);
+      options.nthreads = nthreads;
+
+      result &= same_points(gde::geom::algorithm::intersection_rb(red_segments, blue_segments, options, selection), expected);
+      result &= (selection.algorithm == options.algorithm) && (selection.nthreads == nthreads);
+    }
+  }
+
+// a few segments are tested in nested loops
+  std::vector<gde::geom::core::line_segment> few_red(red_segments.begin(), red_segments.begin() + 10);
+  std::vector<gde::geom::core::line_segment> few_blue(blue_segments.begin(), blue_segments.begin() + 10);
+
+  options = gde::geom::algorithm::intersection_options();
+
+  result &= same_points(gde::geom::algorithm::intersection_rb(few_red, few_blue, options, selection),
+                        gde::geom::algorithm::x_order_intersection_rb(few_red, few_blue));
+  result &= (selection.algorithm == gde::geom::algorithm::LAZY_ALGORITHM);
+
+// an input small enough for the nested loops still runs a given algorithm: each one gives the same points
+  std::vector<gde::geom::core::line_segment> small_red = gen_segments(12, 113, 20.0, 15.0, false);
+  std::vector<gde::geom::core::line_segment> small_blue = gen_segments(12, 114, 20.0, 15.0, false);
+
+  std::vector<gde::geom::core::point> small_expected = gde::geom::algorithm::intersection_rb(small_red, small_blue, options, selection);
+
+  result &= (selection.algorithm == gde::geom::algorithm::LAZY_ALGORITHM) && !small_expected.empty();
+
+  for(int a = gde::geom::algorithm::LAZY_ALGORITHM; a <= gde::geom::algorithm::TILING_ALGORITHM; ++a)
+  {
+    for(std::size_t nthreads = 1; nthreads <= 3; nthreads += 2)
+    {
+      options.algorithm = static_cast<gde::geom::algorithm::intersection_algorithm_type>(a);
+      options.nthreads = nthreads;
+
+      result &= same_points(gde::geom::algorithm::intersection_rb(small_red, small_blue, options, selection), small_expected);
+      result &= (selection.algorithm == options.algorithm) && (selection.nthreads == nthreads) && (selection.cost > 0.0);
+    }
+  }
+
+  options = gde::geom::algorithm::intersection_options();
+
+// sets whose rectangles are apart have no intersection to compute
+  std::vector<gde::geom::core::line_segment> far_segments;
+
+  for(const gde::geom::core::line_segment& s : blue_segments)
+  {
+    gde::geom::core::point p1 = { s.p1.x + 1000.0, s.p1.y };
+    gde::geom::core::point p2 = { s.p2.x + 1000.0, s.p2.y };
+
+    far_segments.push_back(gde::geom::core::line_segment(p1, p2));
+  }
+
+  result &= gde::geom::algorithm::intersection_rb(red_segments, far_segments, options, selection).empty();
+  result &= (selection.algorithm == gde::geom::algorithm::AUTO_ALGORITHM);
+
+  result &= gde::geom::algorithm::intersection_rb(red_segments, std::vector<gde::geom::core::line_segment>(), options, selection).empty();
+  result &= (selection.algorithm == gde::geom::algorithm::AUTO_ALGORITHM);
+
+  if(!result)
+    std::cout << "intersection_selector_test: FAILED" << std::endl;
+
+  return result;
+}
+
+// translate a set of segments
+std::vector<gde::geom::core::line_segment>
+move_segments(std::vector<gde::geom::core::line_segment> segments, double dx, double dy)
+{
+  for(gde::geom::core::line_segment& s : segments)
+  {
+    s.p1.x += dx;
+    s.p1.y += dy;
+    s.p2.x += dx;
+    s.p2.y += dy;
+  }
+
+  return segments;
+}
+
+// run a red-blue algorithm on red and blue: the serial points must be the ones of the x-order algorithm,
+// the counts must match them and the threaded version must give the serial points in the same order
+template<class Algorithm>
+bool
+check_rb_algorithm(const Algorithm& algorithm,
+                   const std::vector<gde::geom::core::line_segment>& red_segments,
+                   const std::vector<gde::geom::core::line_segment>& blue_segments,
+                   gde::geom::algorithm::thread_pool& pool)
+{
+  bool result = true;
+
+  std::vector<gde::geom::core::point> ipts = algorithm(red_segments, blue_segments);
+
+  result &= same_points(ipts, gde::geom::algorithm::x_order_intersection_rb(red_segments, blue_segments));
+
+  gde::geom::algorithm::intersection_count expected = gde::geom::algorithm::x_order_intersection_rb_count(red_segments, blue_segments);
+  gde::geom::algorithm::intersection_count count = algorithm.count(red_segments, blue_segments);
+  gde::geom::algorithm::intersection_count count3 = algorithm.count(red_segments, blue_segments, pool);
+
+  for(std::size_t r = 0; r != 4; ++r)
+    result &= (count.relations[r] == expected.relations[r]) && (count3.relations[r] == expected.relations[r]);
+
+  std::vector<gde::geom::core::point> ipts3;
+
+  algorithm(red_segments, blue_segments, pool, ipts3);
+
+  result &= (ipts3 == ipts);
+
+  return result;
+}
+
+// the checks above on the data sets every red-blue algorithm must handle, generated from seed to seed + 9
+template<class Algorithm>
+bool
+check_rb_algorithm(const Algorithm& algorithm, unsigned int seed)
+{
+  bool result = true;
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+// short segments, a dense cluster and a few very long segments
+  std::vector<gde::geom::core::line_segment> red_segments = gen_segments(3000, seed, 1000.0, 2.0, false);
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, seed + 1, 1000.0, 2.0, false);
+
+  std::vector<gde::geom::core::line_segment> red_cluster = gen_segments(1000, seed + 2, 50.0, 1.0, false);
+  std::vector<gde::geom::core::line_segment> blue_cluster = gen_segments(1000, seed + 3, 50.0, 1.0, false);
+
+  std::vector<gde::geom::core::line_segment> long_red = gen_segments(30, seed + 4, 1000.0, 800.0, false);
+  std::vector<gde::geom::core::line_segment> long_blue = gen_segments(30, seed + 5, 1000.0, 800.0, false);
+
+  red_segments.insert(red_segments.end(), red_cluster.begin(), red_cluster.end());
+  red_segments.insert(red_segments.end(), long_red.begin(), long_red.end());
+  blue_segments.insert(blue_segments.end(), blue_cluster.begin(), blue_cluster.end());
+  blue_segments.insert(blue_segments.end(), long_blue.begin(), long_blue.end());
+
+  result &= check_rb_algorithm(algorithm, red_segments, blue_segments, pool);
+
+// degenerate data: shared end-points and overlaps, many of them on the borders of the cells of the indexes
+  result &= check_rb_algorithm(algorithm, gen_segments(1500, seed + 6, 64.0, 6.0, true),
+                               gen_segments(1500, seed + 7, 64.0, 6.0, true), pool);
+
+// red segments going beyond the extent of the blue ones on every side, and some of them entirely outside
+  result &= check_rb_algorithm(algorithm, gen_segments(2000, seed + 8, 1000.0, 100.0, false),
+                               move_segments(gen_segments(2000, seed + 9, 500.0, 5.0, false), 250.0, 250.0), pool);
+
+// a single segment and empty sets
+  std::vector<gde::geom::core::line_segment> one_red(long_red.end() - 1, long_red.end());
+
+  result &= check_rb_algorithm(algorithm, one_red, blue_segments, pool);
+  result &= check_rb_algorithm(algorithm, red_segments, std::vector<gde::geom::core::line_segment>(), pool);
+  result &= check_rb_algorithm(algorithm, std::vector<gde::geom::core::line_segment>(), blue_segments, pool);
+
+  return result;
+}
+
+// rtree_intersection_rb and its variants for check_rb_algorithm
+struct rtree_rb_algorithm
+{
+  std::size_t node_capacity;
+
+  std::vector<gde::geom::core::point>
+  operator()(const std::vector<gde::geom::core::line_segment>& red_segments,
+             const std::vector<gde::geom::core::line_segment>& blue_segments) const
+  {
+    return gde::geom::algorithm::rtree_intersection_rb(red_segments, blue_segments, node_capacity);
+  }
+
+  void
+  operator()(const std::vector<gde::geom::core::line_segment>& red_segments,
+             const std::vector<gde::geom::core::line_segment>& blue_segments,
+             gde::geom::algorithm::thread_pool& pool,
+             std::vector<gde::geom::core::point>& ipts) const
+  {
+    gde::geom::algorithm::rtree_intersection_rb_thread(red_segments, blue_segments, pool, node_capacity, ipts);
+  }
+
+  gde::geom::algorithm::intersection_count
+  count(const std::vector<gde::geom::core::line_segment>& red_segments,
+        const std::vector<gde::geom::core::line_segment>& blue_segments) const
+  {
+    return gde::geom::algorithm::rtree_intersection_rb_count(red_segments, blue_segments, node_capacity);
+  }
+
+  gde::geom::algorithm::intersection_count
+  count(const std::vector<gde::geom::core::line_segment>& red_segments,
+        const std::vector<gde::geom::core::line_segment>& blue_segments,
+        gde::geom::algorithm::thread_pool& pool) const
+  {
+    return gde::geom::algorithm::rtree_intersection_rb_count_thread(red_segments, blue_segments, pool, node_capacity);
+  }
+};
+
+// quadtree_intersection_rb and its variants for check_rb_algorithm
+struct quadtree_rb_algorithm
+{
+  std::size_t leaf_capacity;
+
+  std::vector<gde::geom::core::point>
+  operator()(const std::vector<gde::geom::core::line_segment>& red_segments,
+             const std::vector<gde::geom::core::line_segment>& blue_segments) const
+  {
+    return gde::geom::algorithm::quadtree_intersection_rb(red_segments, blue_segments, leaf_capacity);
+  }
+
+  void
+  operator()(const std::vector<gde::geom::core::line_segment>& red_segments,
+             const std::vector<gde::geom::core::line_segment>& blue_segments,
+             gde::geom::algorithm::thread_pool& pool,
+             std::vector<gde::geom::core::point>& ipts) const
+  {
+    gde::geom::algorithm::quadtree_intersection_rb_thread(red_segments, blue_segments, pool, leaf_capacity, ipts);
+  }
+
+  gde::geom::algorithm::intersection_count
+  count(const std::vector<gde::geom::core::line_segment>& red_segments,
+        const std::vector<gde::geom::core::line_segment>& blue_segments) const
+  {
+    return gde::geom::algorithm::quadtree_intersection_rb_count(red_segments, blue_segments, leaf_capacity);
+  }
+
+  gde::geom::algorithm::intersection_count
+  count(const std::vector<gde::geom::core::line_segment>& red_segments,
+        const std::vector<gde::geom::core::line_segment>& blue_segments,
+        gde::geom::algorithm::thread_pool& pool) const
+  {
+    return gde::geom::algorithm::quadtree_intersection_rb_count_thread(red_segments, blue_segments, pool, leaf_capacity);
+  }
+};
+
+// multilevel_grid_intersection_rb and its variants for check_rb_algorithm, on the extent of both sets
+struct multilevel_grid_rb_algorithm
+{
+  double dx;
+  double dy;
+
+  gde::geom::core::rectangle
+  extent(const std::vector<gde::geom::core::line_segment>& red_segments,
+         const std::vector<gde::geom::core::line_segment>& blue_segments) const
+  {
+    gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(red_segments.begin(), red_segments.end());
+    gde::geom::core::rectangle rb = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
+
+    return gde::geom::core::rectangle(std::min(r.ll.x, rb.ll.x), std::min(r.ll.y, rb.ll.y),
+                                      std::max(r.ur.x, rb.ur.x), std::max(r.ur.y, rb.ur.y));
+  }
+
+  std::vector<gde::geom::core::point>
+  operator()(const std::vector<gde::geom::core::line_segment>& red_segments,
+             const std::vector<gde::geom::core::line_segment>& blue_segments) const
+  {
+    gde::geom::core::rectangle r = extent(red_segments, blue_segments);
+
+    return gde::geom::algorithm::multilevel_grid_intersection_rb(red_segments, blue_segments,
+                                                                 dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+  }
+
+  void
+  operator()(const std::vector<gde::geom::core::line_segment>& red_segments,
+             const std::vector<gde::geom::core::line_segment>& blue_segments,
+             gde::geom::algorithm::thread_pool& pool,
+             std::vector<gde::geom::core::point>& ipts) const
+  {
+    gde::geom::core::rectangle r = extent(red_segments, blue_segments);
+
+    gde::geom::algorithm::multilevel_grid_intersection_rb_thread(red_segments, blue_segments, pool,
+                                                                 dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y, ipts);
+  }
+
+  gde::geom::algorithm::intersection_count
+  count(const std::vector<gde::geom::core::line_segment>& red_segments,
+        const std::vector<gde::geom::core::line_segment>& blue_segments) const
+  {
+    gde::geom::core::rectangle r = extent(red_segments, blue_segments);
+
+    return gde::geom::algorithm::multilevel_grid_intersection_rb_count(red_segments, blue_segments,
+                                                                       dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+  }
+
+  gde::geom::algorithm::intersection_count
+  count(const std::vector<gde::geom::core::line_segment>& red_segments,
+        const std::vector<gde::geom::core::line_segment>& blue_segments,
+        gde::geom::algorithm::thread_pool& pool) const
+  {
+    gde::geom::core::rectangle r = extent(red_segments, blue_segments);
+
+    return gde::geom::algorithm::multilevel_grid_intersection_rb_count_thread(red_segments, blue_segments, pool,
+                                                                             dx, dy, r.ll.x, r.ur.x, r.ll.y, r.ur.y);
+  }
+};
+
+bool packed_rtree_test()
+{
+  bool result = true;
+
+// short segments mixed with a few very long ones
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, 121, 1000.0, 2.0, false);
+  std::vector<gde::geom::core::line_segment> long_blue = gen_segments(30, 122, 1000.0, 800.0, false);
+
+  blue_segments.insert(blue_segments.end(), long_blue.begin(), long_blue.end());
+
+// each segment has a single entry and each node bounds at most node_capacity children
+  gde::geom::algorithm::packed_rtree tree;
+
+  gde::geom::algorithm::build_packed_rtree(blue_segments, 8, tree);
+
+  result &= (tree.ids.size() == blue_segments.size()) && (tree.level_size(0) == blue_segments.size());
+  result &= (tree.nlevels() >= 2) && (tree.level_size(tree.nlevels() - 1) == 1);
+
+  std::vector<std::uint32_t> ids(tree.ids);
+
+  std::sort(ids.begin(), ids.end());
+
+  for(std::size_t i = 0; i != ids.size(); ++i)
+    result &= (ids[i] == i);
+
+  for(std::size_t level = 1; level != tree.nlevels(); ++level)
+  {
+    result &= (tree.level_size(level) == (tree.level_size(level - 1) + 7) / 8);
+
+    for(std::size_t k = tree.levels[level]; k != tree.levels[level + 1]; ++k)
+    {
+      std::pair<std::size_t, std::size_t> children = tree.children(level, k);
+
+      result &= (children.second > children.first) && (children.second - children.first <= 8);
+
+      for(std::size_t c = children.first; c != children.second; ++c)
+        result &= (tree.boxes[k].ll.x <= tree.boxes[c].ll.x) && (tree.boxes[k].ll.y <= tree.boxes[c].ll.y) &&
+                  (tree.boxes[k].ur.x >= tree.boxes[c].ur.x) && (tree.boxes[k].ur.y >= tree.boxes[c].ur.y);
+    }
+  }
+
+  gde::geom::algorithm::packed_rtree tree3;
+
+  gde::geom::algorithm::build_packed_rtree_thread(blue_segments, 3, 8, tree3);
+
+  result &= (tree3.ids == tree.ids) && (tree3.levels == tree.levels);
+
+// Hilbert order: the points of a 64 by 64 grid are visited one step at a time,
+// so the nodes of 4 children are the 2 by 2 blocks of the grid
+  std::vector<gde::geom::core::line_segment> grid_points;
+
+  for(std::size_t i = 0; i != 64; ++i)
+  {
+    for(std::size_t j = 0; j != 64; ++j)
+    {
+      gde::geom::core::point p = { static_cast<double>(i), static_cast<double>(j) };
+
+      grid_points.push_back(gde::geom::core::line_segment(p, p));
+    }
+  }
+
+  gde::geom::algorithm::packed_rtree hilbert_tree;
+
+  gde::geom::algorithm::build_packed_rtree(grid_points, 4, hilbert_tree);
+
+  for(std::size_t k = 1; k != hilbert_tree.level_size(0); ++k)
+    result &= (std::abs(hilbert_tree.boxes[k].ll.x - hilbert_tree.boxes[k - 1].ll.x) +
+               std::abs(hilbert_tree.boxes[k].ll.y - hilbert_tree.boxes[k - 1].ll.y) == 1.0);
+
+  for(std::size_t k = hilbert_tree.levels[1]; k != hilbert_tree.levels[2]; ++k)
+    result &= (hilbert_tree.boxes[k].ur.x - hilbert_tree.boxes[k].ll.x == 1.0) &&
+              (hilbert_tree.boxes[k].ur.y - hilbert_tree.boxes[k].ll.y == 1.0) &&
+              (std::fmod(hilbert_tree.boxes[k].ll.x, 2.0) == 0.0) && (std::fmod(hilbert_tree.boxes[k].ll.y, 2.0) == 0.0);
+
+// the same points as the x-order algorithm, for any node capacity
+  rtree_rb_algorithm default_rtree = { gde::geom::algorithm::rtree_node_capacity };
+  rtree_rb_algorithm small_rtree = { 2 };
+  rtree_rb_algorithm large_rtree = { 64 };
+
+  result &= check_rb_algorithm(default_rtree, 121);
+  result &= check_rb_algorithm(small_rtree, 121);
+  result &= check_rb_algorithm(large_rtree, 121);
+
+  if(!result)
+    std::cout << "packed_rtree_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool quadtree_index_test()
+{
+  bool result = true;
+
+// a dense cluster over a sparse background
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, 131, 1000.0, 5.0, false);
+  std::vector<gde::geom::core::line_segment> blue_cluster = gen_segments(3000, 132, 50.0, 1.0, false);
+
+  blue_segments.insert(blue_segments.end(), blue_cluster.begin(), blue_cluster.end());
+
+// the leaves cover the root once and keep the given order
+  std::vector<gde::geom::core::line_segment> segments(blue_segments.size());
+
+  std::transform(blue_segments.begin(), blue_segments.end(), segments.begin(), gde::geom::algorithm::sort_segment_xy());
+
+  std::vector<std::uint32_t> order(segments.size());
+
+  for(std::size_t i = 0; i != order.size(); ++i)
+    order[i] = static_cast<std::uint32_t>(i);
+
+  std::sort(order.begin(), order.end(), gde::geom::algorithm::line_segment_id_xy_cmp{&segments});
+
+  std::vector<std::size_t> rank(order.size());
+
+  for(std::size_t i = 0; i != order.size(); ++i)
+    rank[order[i]] = i;
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(segments.begin(), segments.end());
+
+  gde::geom::algorithm::quadtree_index tree;
+
+  gde::geom::algorithm::build_quadtree_index(segments, order, 32, r.ll.x, r.ur.x, r.ll.y, r.ur.y, tree);
+
+  result &= (tree.cells.size() > 1) && (tree.offsets.size() == tree.cells.size() + 1) && (tree.offsets.back() == tree.ids.size());
+
+  double area = 0.0;
+
+  std::vector<bool> indexed(segments.size(), false);
+
+  for(std::size_t k = 0; k != tree.cells.size(); ++k)
+  {
+    area += std::ldexp(1.0, -2 * static_cast<int>(tree.cells[k].level));
+
+    for(std::size_t e = tree.offsets[k]; e != tree.offsets[k + 1]; ++e)
+    {
+      indexed[tree.ids[e]] = true;
+
+      if(e != tree.offsets[k])
+        result &= (rank[tree.ids[e - 1]] < rank[tree.ids[e]]);
+    }
+  }
+
+  result &= (area == 1.0) && (std::find(indexed.begin(), indexed.end(), false) == indexed.end());
+
+// short segments are split until the leaves hold at most leaf capacity segments,
+// so the clustered region gets deeper leaves than the background
+  std::size_t max_level = 0;
+
+  for(std::size_t k = 0; k != tree.cells.size(); ++k)
+  {
+    max_level = std::max<std::size_t>(max_level, tree.cells[k].level);
+
+    result &= (tree.offsets[k + 1] - tree.offsets[k] <= 32);
+  }
+
+  result &= (max_level >= 4);
+
+// the threaded build splits the top levels up to a frontier of nodes: the tree must not depend on its depth,
+// whether the tree stops above it (a single leaf or a few ones) or goes far below it
+  const std::size_t capacities[] = { 32, 1000, 5000, 10000 };
+
+  for(std::size_t capacity : capacities)
+  {
+    gde::geom::algorithm::quadtree_index serial_tree;
+    gde::geom::algorithm::quadtree_index tree3;
+
+    gde::geom::algorithm::build_quadtree_index(segments, order, capacity, r.ll.x, r.ur.x, r.ll.y, r.ur.y, serial_tree);
+    gde::geom::algorithm::build_quadtree_index_thread(segments, order, 3, capacity, r.ll.x, r.ur.x, r.ll.y, r.ur.y, tree3);
+
+    result &= (tree3.ids == serial_tree.ids) && (tree3.offsets == serial_tree.offsets) && (tree3.cells.size() == serial_tree.cells.size());
+
+    for(std::size_t k = 0; k != tree3.cells.size(); ++k)
+      result &= (tree3.cells[k].level == serial_tree.cells[k].level) &&
+                (tree3.cells[k].col == serial_tree.cells[k].col) && (tree3.cells[k].row == serial_tree.cells[k].row);
+  }
+
+// the same points as the x-order algorithm, for any leaf capacity
+  quadtree_rb_algorithm default_quadtree = { gde::geom::algorithm::quadtree_leaf_capacity };
+  quadtree_rb_algorithm small_quadtree = { 4 };
+  quadtree_rb_algorithm large_quadtree = { 1000 };
+
+  result &= check_rb_algorithm(default_quadtree, 131);
+  result &= check_rb_algorithm(small_quadtree, 131);
+  result &= check_rb_algorithm(large_quadtree, 131);
+
+// all the segments on a vertical line: the root has no width
+  std::vector<gde::geom::core::line_segment> red_vertical;
+  std::vector<gde::geom::core::line_segment> blue_vertical;
+
+  for(std::size_t i = 0; i != 200; ++i)
+  {
+    gde::geom::core::point p1 = { 10.0, static_cast<double>(i) };
+    gde::geom::core::point p2 = { 10.0, static_cast<double>(i) + 0.5 };
+    gde::geom::core::point p3 = { 10.0, static_cast<double>(i) + 0.25 };
+    gde::geom::core::point p4 = { 10.0, static_cast<double>(i) + 0.75 };
+
+    red_vertical.push_back(gde::geom::core::line_segment(p1, p2));
+    blue_vertical.push_back(gde::geom::core::line_segment(p3, p4));
+  }
+
+  gde::geom::algorithm::thread_pool pool(3);
+
+  result &= check_rb_algorithm(small_quadtree, red_vertical, blue_vertical, pool);
+
+  if(!result)
+    std::cout << "quadtree_index_test: FAILED" << std::endl;
+
+  return result;
+}
+
+bool multilevel_grid_test()
+{
+  bool result = true;
+
+// short segments mixed with a few very long ones
+  std::vector<gde::geom::core::line_segment> blue_segments = gen_segments(3000, 141, 1000.0, 2.0, false);
+  std::vector<gde::geom::core::line_segment> long_blue = gen_segments(30, 142, 1000.0, 800.0, false);
+
+  blue_segments.insert(blue_segments.end(), long_blue.begin(), long_blue.end());
+
+  gde::geom::core::rectangle r = gde::geom::algorithm::compute_rectangle(blue_segments.begin(), blue_segments.end());
+
+// each segment has at most 4 entries, far fewer than in a single grid with the same cells
+  gde::geom::algorithm::multilevel_grid_index grid;
+
+  gde::geom::algorithm::build_multilevel_grid_index(blue_segments, 4.0, 4.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, grid);
+
+  gde::geom::algorithm::grid_index fixed_grid;
+
+  gde::geom::algorithm::build_grid_index(blue_segments, 4.0, 4.0, r.ll.x, r.ur.x, r.ll.y, r.ur.y, fixed_grid);
+
+  result &= (grid.levels.size() > 1) && (grid.levels.back().ncols == 1) && (grid.levels.back().nrows == 1);
+  result &= (grid.size() >= blue_segments.size()) && (grid.size() <= 4 * blue_segments.size());
+  result &= (2 * grid.size() < fixed_grid.ids.size());
+
+  for(std::size_t l = 1; l != grid.levels.size(); ++l)
+    result &= (grid.levels[l].dx == 2.0 * grid.levels[l - 1].dx) && (grid.levels[l].dy == 2.0 * grid.levels[l - 1].dy);
+
+// each segment is in the finest level whose cells are as large as its bounding box, in at most 2 by 2 of its cells
+  result &= (grid.segment_levels.size() == blue_segments.size());
+
+  std::vector<std::size_t> entries(blue_segments.size(), 0);
+
+  for(std::size_t l = 0; l != grid.levels.size(); ++l)
+  {
+    for(std::uint32_t id : grid.levels[l].ids)
+    {
+      result &= (grid.segment_levels[id] == l);
+
+      ++entries[id];
+    }
+  }
+
+  for(std::size_t i = 0; i != blue_segments.size(); ++i)
+  {
+    const gde::geom::core::line_segment& s = blue_segments[i];
+    const std::size_t l = grid.segment_levels[i];
+    const gde::geom::algorithm::grid_index& level = grid.levels[l];
+
+    const double w = std::abs(s.p2.x - s.p1.x);
+    const double h = std::abs(s.p2.y - s.p1.y);
+
+    result &= ((w <= level.dx) && (h <= level.dy)) || (l + 1 == grid.levels.size());
+
+    if(l != 0)
+    {
+      const gde::geom::algorithm::grid_index& below = grid.levels[l - 1];
+
+      result &= (w > below.dx) || (h > below.dy);
+    }
+
+    std::pair<std::size_t, std::size_t> cols = level.col_range(s);
+    std::pair<std::size_t, std::size_t> rows = level.row_range(s);
+
+    result &= (cols.second - cols.first <= 1) && (rows.second - rows.first <= 1);
+    result &= (entries[i] == (cols.second - cols.first + 1) * (rows.second - rows.first + 1));
+  }
+
+// the same points as the x-order algorithm, for the given cells and the planned ones
+  multilevel_grid_rb_algorithm given_grid = { 4.0, 4.0 };
+  multilevel_grid_rb_algorithm planned_grid = { gde::geom::algorithm::auto_resolution, gde::geom::algorithm::auto_resolution };
+
+  result &= check_rb_algorithm(given_grid, 141);
+  result &= check_rb_algorithm(planned_grid, 141);
+
+  if(!result)
+    std::cout << "multilevel_grid_test: FAILED" << std::endl;
+
+  return result;
+}
+
+#ifdef GDE_GEOM_ALGORITHM_INTEGER_ENGINE
+bool integer_engine_test()
+{
+  bool result = true;
+
+// orientation is exact over the whole range of 32-bit coordinates
+  gde::geom::core::int_point a = { -2147483647 - 1, -2147483647 - 1 };
+  gde::geom::core::int_point b = { 0, 0 };
+  gde::geom::core::int_point c = { 2147483647, 2147483647 };
+  gde::geom::core::int_point d = { 2147483647, 2147483646 };
+
+  result &= (gde::geom::algorithm::orientation(a, b, c) == 0);
+  result &= (gde::geom::algorithm::orientation(a, b, d) < 0);
+  result &= (gde::geom::algorithm::orientation(a, d, b) > 0);
+
+// a crossing at (1.5, 0.5)
+  gde::geom::core::int_point p1 = { 0, 0 };
+  gde::geom::core::int_point p2 = { 3, 1 };
+  gde::geom::core::int_point p3 = { 0, 1 };
+  gde::geom::core::int_point p4 = { 3, 0 };
+
+  gde::geom::algorithm::rational_point ip1, ip2;
+
+  gde::geom::algorithm::segment_relation_type rel =
+    gde::geom::algorithm::compute_intesection_exact(gde::geom::core::int_line_segment(p1, p2),
+                                                    gde::geom::core::int_line_segment(p3, p4), ip1, ip2);
+
+  gde::geom::core::point ip = gde::geom::algorithm::to_point(ip1);
+  gde::geom::core::int_point sp = gde::geom::algorithm::snap(ip1);
+
+  result &= (rel == gde::geom::algorithm::CROSS);
+  result &= (ip.x == 1.5) && (ip.y == 0.5);
+  result &= (sp.x == 2) && (sp.y == 1);
+
+// degenerate data: the same intersections as the floating-point algorithms
+  std::vector<gde::geom::core::line_segment> segments = gen_segments(2000, 81, 100.0, 6.0, true);
+
+  std::vector<gde::geom::core::int_line_segment> int_segments;
+
+  for(const auto& s : segments)
+  {
+    gde::geom::core::int_point q1 = { static_cast<std::int32_t>(s.p1.x), static_cast<std::int32_t>(s.p1.y) };
+    gde::geom::core::int_point q2 = { static_cast<std::int32_t>(s.p2.x), static_cast<std::int32_t>(s.p2.y) };
+
+    int_segments.push_back(gde::geom::core::int_line_segment(q1, q2));
+  }
+
+  std::vector<gde::geom::algorithm::rational_point> rpts = gde::geom::algorithm::x_order_intersection(int_segments);
+  std::vector<gde::geom::algorithm::rational_point> lazy_rpts = gde::geom::algorithm::lazy_intersection(int_segments);
+
+  std::vector<gde::geom::core::point> xpts, lazy_xpts;
+
+  for(const auto& p : rpts)
+    xpts.push_back(gde::geom::algorithm::to_point(p));
+
+  for(const auto& p : lazy_rpts)
+    lazy_xpts.push_back(gde::geom::algorithm::to_point(p));
+
+  result &= same_points(xpts, gde::geom::algorithm::x_order_intersection(segments));
+  result &= same_points(lazy_xpts, xpts);
+
+  std::vector<gde::geom::core::int_point> snapped = gde::geom::algorithm::x_order_intersection_snapped(int_segments);
+
+  result &= (snapped.size() == rpts.size());
+
+  for(std::size_t i = 0; (i != snapped.size()) && result; ++i)
+  {
+    gde::geom::core::int_point q = gde::geom::algorithm::snap(rpts[i]);
+
+    result &= (q == snapped[i]);
+    result &= (std::fabs(q.x - xpts[i].x) <= 0.5) && (std::fabs(q.y - xpts[i].y) <= 0.5);
+  }
+
+  if(!result)
+    std::cout << "integer_engine_test: FAILED" << std::endl;
+
+  return result;
+}
+#endif
+
 int main(int argc, char* argv[])
 {
   do_intersects_basic_test();
 
-  return EXIT_SUCCESS;
+  bool result = true;
+
+  result &= bentley_ottmann_test();
+  result &= trapezoid_sweep_test();
+  result &= fixed_grid_test();
+  result &= tiling_test();
+  result &= work_stealing_test();
+  result &= thread_pool_test();
+  result &= parallel_sort_test();
+  result &= batch_kernel_test();
+  result &= lazy_rb_test();
+  result &= x_order_window_test();
+  result &= branchless_kernel_test();
+  result &= selected_kernel_test();
+  result &= policy_core_test();
+  result &= robust_predicates_test();
+#ifdef GDE_GEOM_ALGORITHM_INTEGER_ENGINE
+  result &= integer_engine_test();
+#endif
+  result &= intersection_pairs_test();
+  result &= intersection_count_test();
+  result &= points_count_test();
+  result &= intersection_visitor_test();
+  result &= count_then_fill_test();
+  result &= resolution_planner_test();
+  result &= intersection_selector_test();
+  result &= packed_rtree_test();
+  result &= quadtree_index_test();
+  result &= multilevel_grid_test();
+
+  return result ? EXIT_SUCCESS : EXIT_FAILURE;
 }